@@ -0,0 +1,183 @@
+// distance_table_bench.cpp
+//
+// Сравнение DistanceTable с прежним хранилищем расстояний
+// std::unordered_map<std::pair<Stop*, Stop*>, size_t, HasherPairPtr>.
+//
+// Сборка из корня репозитория:
+//   g++ -std=c++20 -O2 -Isrc -o distance_table_bench
+//       bench/distance_table_bench.cpp src/distance_table.cpp
+// Запуск: distance_table_bench [stops] [distances] [lookups] [seed]
+
+#include "distance_table.h"
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using namespace std::literals;
+
+// Остановка и хэшер пары указателей в том виде, в каком они были до
+// DistanceTable
+struct Stop {
+    std::string name;
+    double latitude = 0;
+    double longitude = 0;
+};
+
+class HasherPairPtr {
+public:
+    size_t operator()(const std::pair<Stop*, Stop*>& pair_ptr) const
+    {
+        return (std::hash<Stop*>()(pair_ptr.first) * 11) +
+               (std::hash<Stop*>()(pair_ptr.second) * 11 * 11);
+    }
+};
+
+using StopPair = std::pair<uint32_t, uint32_t>;
+
+struct Input {
+    std::deque<Stop> stops;
+    // Заданные расстояния, как road_distances остановок
+    std::vector<StopPair> distances;
+    // Запросы в обоих направлениях, как при подсчете длины маршрутов
+    std::vector<StopPair> lookups;
+};
+
+// Остановки соединяются с близкими по номеру, как соседние остановки
+// маршрутов города
+Input Generate(size_t stops_count, size_t distances_count,
+               size_t lookups_count, uint32_t seed)
+{
+    Input input;
+    for (size_t i = 0; i < stops_count; ++i) {
+        input.stops.push_back({"Stop "s + std::to_string(i), 0, 0});
+    }
+
+    std::mt19937 random(seed);
+    input.distances.reserve(distances_count);
+    for (size_t i = 0; i < distances_count; ++i) {
+        const uint32_t from = random() % stops_count;
+        const uint32_t to = (from + 1 + random() % 50) % stops_count;
+        input.distances.emplace_back(from, to);
+    }
+
+    input.lookups.reserve(lookups_count);
+    for (size_t i = 0; i < lookups_count; ++i) {
+        StopPair pair = input.distances[random() % distances_count];
+        if (random() % 2 == 0) {
+            std::swap(pair.first, pair.second);
+        }
+        input.lookups.push_back(pair);
+    }
+    return input;
+}
+
+size_t LengthOf(const StopPair& pair)
+{
+    return pair.first + pair.second + 1;
+}
+
+struct Result {
+    double insert_ms = 0;
+    double lookup_ms = 0;
+    size_t checksum = 0;
+};
+
+template <typename Function>
+double MeasureMs(Function function)
+{
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    const auto finish = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(finish - start).count();
+}
+
+// Поиск как в прежнем TransportCatalogue::GetLengthFromTo
+Result RunUnorderedMap(Input& input)
+{
+    std::unordered_map<std::pair<Stop*, Stop*>, size_t, HasherPairPtr>
+        lengths;
+    Result result;
+    result.insert_ms = MeasureMs([&] {
+        for (const StopPair& pair : input.distances) {
+            lengths[{&input.stops[pair.first], &input.stops[pair.second]}] =
+                LengthOf(pair);
+        }
+    });
+    result.lookup_ms = MeasureMs([&] {
+        for (const auto& [from_id, to_id] : input.lookups) {
+            Stop* from = &input.stops[from_id];
+            Stop* to = &input.stops[to_id];
+            if (lengths.count({from, to})) {
+                result.checksum += lengths.at({from, to});
+            } else if (lengths.count({to, from})) {
+                result.checksum += lengths.at({to, from});
+            }
+        }
+    });
+    return result;
+}
+
+Result RunDistanceTable(const Input& input)
+{
+    transport_catalogue::DistanceTable lengths;
+    Result result;
+    result.insert_ms = MeasureMs([&] {
+        for (const StopPair& pair : input.distances) {
+            lengths.Set(pair.first, pair.second, LengthOf(pair));
+        }
+    });
+    result.lookup_ms = MeasureMs([&] {
+        for (const auto& [from, to] : input.lookups) {
+            result.checksum += lengths.Get(from, to);
+        }
+    });
+    return result;
+}
+
+void PrintResult(std::string_view name, const Result& result)
+{
+    std::cout << name << ": insert "sv << result.insert_ms << " ms, lookup "sv
+              << result.lookup_ms << " ms"sv << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    // Большой город: десятки тысяч остановок, по несколько соседей у каждой
+    const size_t stops_count = argc > 1 ? std::stoul(argv[1]) : 50000;
+    const size_t distances_count = argc > 2 ? std::stoul(argv[2]) : 200000;
+    const size_t lookups_count = argc > 3 ? std::stoul(argv[3]) : 4000000;
+    const uint32_t seed = argc > 4 ? std::stoul(argv[4]) : 1;
+    if (stops_count < 2 || distances_count == 0) {
+        std::cerr << "Need at least 2 stops and 1 distance"sv << std::endl;
+        return 1;
+    }
+
+    Input input = Generate(stops_count, distances_count, lookups_count, seed);
+    std::cout << stops_count << " stops, "sv << distances_count
+              << " distances, "sv << lookups_count << " lookups"sv
+              << std::endl;
+
+    const Result map_result = RunUnorderedMap(input);
+    const Result table_result = RunDistanceTable(input);
+    PrintResult("unordered_map + HasherPairPtr"sv, map_result);
+    PrintResult("DistanceTable"sv, table_result);
+
+    if (map_result.checksum != table_result.checksum) {
+        std::cerr << "Checksums differ: "sv << map_result.checksum << " vs "sv
+                  << table_result.checksum << std::endl;
+        return 1;
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+// arena.cpp
+
+#include "arena.h"
+
+#include <cstdint>
+
+namespace transport_catalogue {
+
+void Arena::Adopt(std::shared_ptr<const void> memory)
+{
+    adopted_.push_back(std::move(memory));
+}
+
+void* Arena::Allocate(size_t size, size_t alignment)
+{
+    if (size > BLOCK_SIZE / 4) {
+        // Блоки выделяются operator new[] и выровнены не хуже max_align_t
+        blocks_.push_back(std::make_unique<std::byte[]>(size));
+        return blocks_.back().get();
+    }
+    const size_t padding =
+        (alignment - reinterpret_cast<uintptr_t>(cursor_) % alignment) %
+        alignment;
+    if (cursor_ == nullptr || padding + size > remaining_) {
+        blocks_.push_back(std::make_unique<std::byte[]>(BLOCK_SIZE));
+        cursor_ = blocks_.back().get();
+        remaining_ = BLOCK_SIZE;
+        return Allocate(size, alignment);
+    }
+    std::byte* data = cursor_ + padding;
+    cursor_ = data + size;
+    remaining_ -= padding + size;
+    return data;
+}
+
+} // namespace transport_catalogue
\ No newline at end of file
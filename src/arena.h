@@ -0,0 +1,52 @@
+// arena.h
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace transport_catalogue {
+
+// Хранилище неизменяемых данных, которое только пополняется. Данные
+// размещаются в блоках и не перемещаются, поэтому выданные span остаются
+// действительными до уничтожения арены. Арена также может удерживать
+// внешнюю память (например, отображенный в память файл), на которую
+// ссылаются записи каталога.
+class Arena {
+public:
+    Arena() = default;
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    Arena(Arena&&) = default;
+    Arena& operator=(Arena&&) = default;
+
+    template <typename T>
+    std::span<const T> Copy(std::span<const T> data)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (data.empty()) {
+            return {};
+        }
+        void* memory = Allocate(data.size_bytes(), alignof(T));
+        std::memcpy(memory, data.data(), data.size_bytes());
+        return {static_cast<const T*>(memory), data.size()};
+    }
+
+    void Adopt(std::shared_ptr<const void> memory);
+
+private:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    std::vector<std::unique_ptr<std::byte[]>> blocks_;
+    std::byte* cursor_ = nullptr;
+    size_t remaining_ = 0;
+    std::vector<std::shared_ptr<const void>> adopted_;
+
+    void* Allocate(size_t size, size_t alignment);
+};
+
+} // namespace transport_catalogue
\ No newline at end of file
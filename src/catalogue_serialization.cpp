@@ -0,0 +1,340 @@
+// catalogue_serialization.cpp
+
+#include "catalogue_serialization.h"
+
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace catalogue_serialization {
+
+using namespace transport_catalogue;
+
+namespace {
+
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t checksum;
+    uint64_t stop_count;
+    uint64_t route_count;
+    uint64_t distance_slot_count;
+    uint64_t route_stop_count;
+    uint64_t names_size;
+};
+
+struct StopRecord {
+    uint64_t name_offset;
+    uint64_t name_size;
+    double lat;
+    double lng;
+};
+
+struct RouteRecord {
+    uint64_t name_offset;
+    uint64_t name_size;
+    uint64_t stops_offset;
+    uint32_t stops_count;
+    uint32_t is_roundtrip;
+};
+
+struct DistanceRecord {
+    uint64_t key;
+    uint32_t length;
+    uint32_t is_explicit;
+};
+
+// Размеры частей файла, вычисленные по заголовку
+struct Layout {
+    size_t stops;
+    size_t routes;
+    size_t distances;
+    size_t route_stops;
+    size_t names;
+    size_t total;
+};
+
+size_t AlignUp(size_t size)
+{
+    return (size + 7) & ~size_t{7};
+}
+
+Layout ComputeLayout(const Header& header)
+{
+    Layout layout;
+    layout.stops = sizeof(Header);
+    layout.routes = layout.stops + header.stop_count * sizeof(StopRecord);
+    layout.distances =
+        layout.routes + header.route_count * sizeof(RouteRecord);
+    layout.route_stops = layout.distances + header.distance_slot_count *
+                                                sizeof(DistanceRecord);
+    layout.names = layout.route_stops +
+                   AlignUp(header.route_stop_count * sizeof(StopId));
+    layout.total = layout.names + AlignUp(header.names_size);
+    return layout;
+}
+
+std::span<const std::byte> ChecksummedPart(std::span<const std::byte> file)
+{
+    constexpr size_t offset =
+        offsetof(Header, checksum) + sizeof(Header::checksum);
+    return file.subspan(offset);
+}
+
+template <typename T>
+void WriteAt(std::vector<std::byte>& buffer, size_t offset, const T& value)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    std::memcpy(buffer.data() + offset, &value, sizeof(T));
+}
+
+template <typename T>
+const T* ArrayAt(std::span<const std::byte> file, size_t offset)
+{
+    return reinterpret_cast<const T*>(file.data() + offset);
+}
+
+void WriteFile(const std::filesystem::path& path,
+               std::span<const std::byte> data)
+{
+    std::filesystem::path temp_path = path;
+    temp_path += ".tmp";
+    std::FILE* file = std::fopen(temp_path.string().c_str(), "wb");
+    if (file == nullptr) {
+        throw std::runtime_error("Cannot write " + temp_path.string());
+    }
+    bool is_written =
+        std::fwrite(data.data(), 1, data.size(), file) == data.size() &&
+        std::fflush(file) == 0;
+#ifndef _WIN32
+    is_written = is_written && ::fsync(::fileno(file)) == 0;
+#endif
+    std::fclose(file);
+    if (!is_written) {
+        std::filesystem::remove(temp_path);
+        throw std::runtime_error("Cannot write " + temp_path.string());
+    }
+    std::filesystem::rename(temp_path, path);
+    // Без этого после сбоя питания переименование может пропасть, а
+    // удаление замененных снимком файлов - сохраниться
+    SyncDirectory(path.parent_path());
+}
+
+void CheckRange(uint64_t offset, uint64_t size, uint64_t limit)
+{
+    if (offset > limit || size > limit - offset) {
+        throw std::runtime_error("Catalogue snapshot is corrupted");
+    }
+}
+
+} // namespace
+
+void SaveCatalogue(const TransportCatalogue& catalogue,
+                   const std::filesystem::path& path)
+{
+    const std::vector<Stop>& stops = catalogue.GetStops();
+    const std::vector<Route>& routes = catalogue.GetRoutes();
+    const std::span<const DistanceTable::Slot> slots =
+        catalogue.GetDistanceTable().GetSlots();
+
+    // Названия остановок и маршрутов могут совпадать: храним один раз
+    std::string names;
+    std::unordered_map<std::string_view, uint64_t> name_offsets;
+    const auto add_name = [&](std::string_view name) {
+        const auto [it, inserted] = name_offsets.emplace(name, names.size());
+        if (inserted) {
+            names.append(name);
+        }
+        return it->second;
+    };
+
+    Header header{};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    header.stop_count = stops.size();
+    header.route_count = routes.size();
+    header.distance_slot_count = slots.size();
+
+    std::vector<StopRecord> stop_records;
+    stop_records.reserve(stops.size());
+    for (const Stop& stop : stops) {
+        stop_records.push_back({add_name(stop.name), stop.name.size(),
+                                stop.coordinates.lat, stop.coordinates.lng});
+    }
+    std::vector<RouteRecord> route_records;
+    route_records.reserve(routes.size());
+    for (const Route& route : routes) {
+        route_records.push_back(
+            {add_name(route.name), route.name.size(),
+             header.route_stop_count,
+             static_cast<uint32_t>(route.stops.size()),
+             route.is_roundtrip});
+        header.route_stop_count += route.stops.size();
+    }
+    header.names_size = names.size();
+
+    const Layout layout = ComputeLayout(header);
+    std::vector<std::byte> buffer(layout.total);
+    for (size_t i = 0; i < stop_records.size(); ++i) {
+        WriteAt(buffer, layout.stops + i * sizeof(StopRecord),
+                stop_records[i]);
+    }
+    for (size_t i = 0; i < route_records.size(); ++i) {
+        WriteAt(buffer, layout.routes + i * sizeof(RouteRecord),
+                route_records[i]);
+    }
+    for (size_t i = 0; i < slots.size(); ++i) {
+        const DistanceRecord record{slots[i].key, slots[i].length,
+                                    slots[i].is_explicit};
+        WriteAt(buffer, layout.distances + i * sizeof(DistanceRecord),
+                record);
+    }
+    size_t route_stops_offset = layout.route_stops;
+    for (const Route& route : routes) {
+        std::memcpy(buffer.data() + route_stops_offset, route.stops.data(),
+                    route.stops.size_bytes());
+        route_stops_offset += route.stops.size_bytes();
+    }
+    std::memcpy(buffer.data() + layout.names, names.data(), names.size());
+
+    WriteAt(buffer, 0, header);
+    header.checksum = ComputeChecksum(ChecksummedPart(buffer));
+    WriteAt(buffer, 0, header);
+
+    WriteFile(path, buffer);
+}
+
+TransportCatalogue LoadCatalogue(const std::filesystem::path& path)
+{
+    auto mapping = std::make_shared<const mapped_file::MappedFile>(path);
+    const std::span<const std::byte> file = mapping->GetData();
+
+    Header header;
+    if (file.size() < sizeof(header)) {
+        throw std::runtime_error("Catalogue snapshot is truncated");
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) !=
+        0) {
+        throw std::runtime_error("Not a catalogue snapshot");
+    }
+    if (header.version != SNAPSHOT_VERSION ||
+        header.byte_order != BYTE_ORDER_MARK) {
+        throw std::runtime_error("Unsupported catalogue snapshot version");
+    }
+    // Счетчики проверяются до вычисления размеров, чтобы исключить
+    // переполнение
+    for (uint64_t count :
+         {header.stop_count, header.route_count, header.distance_slot_count,
+          header.route_stop_count, header.names_size}) {
+        CheckRange(0, count, file.size());
+    }
+    if (ComputeLayout(header).total != file.size()) {
+        throw std::runtime_error("Catalogue snapshot is truncated");
+    }
+    if (ComputeChecksum(ChecksummedPart(file)) != header.checksum) {
+        throw std::runtime_error("Catalogue snapshot checksum mismatch");
+    }
+
+    const Layout layout = ComputeLayout(header);
+    const char* names = ArrayAt<char>(file, layout.names);
+    const auto get_name = [&](uint64_t offset, uint64_t size) {
+        CheckRange(offset, size, header.names_size);
+        return std::string_view(names + offset, size);
+    };
+
+    std::vector<Stop> stops;
+    stops.reserve(header.stop_count);
+    const StopRecord* stop_records = ArrayAt<StopRecord>(file, layout.stops);
+    for (size_t i = 0; i < header.stop_count; ++i) {
+        const StopRecord& record = stop_records[i];
+        stops.push_back({get_name(record.name_offset, record.name_size),
+                         {record.lat, record.lng},
+                         static_cast<StopId>(i)});
+    }
+
+    std::vector<Route> routes;
+    routes.reserve(header.route_count);
+    const RouteRecord* route_records =
+        ArrayAt<RouteRecord>(file, layout.routes);
+    const StopId* route_stops = ArrayAt<StopId>(file, layout.route_stops);
+    for (size_t i = 0; i < header.route_count; ++i) {
+        const RouteRecord& record = route_records[i];
+        CheckRange(record.stops_offset, record.stops_count,
+                   header.route_stop_count);
+        routes.push_back(
+            {get_name(record.name_offset, record.name_size),
+             std::span<const StopId>(route_stops + record.stops_offset,
+                                     record.stops_count),
+             record.is_roundtrip != 0, static_cast<RouteId>(i)});
+    }
+
+    std::vector<DistanceTable::Slot> slots;
+    slots.reserve(header.distance_slot_count);
+    const DistanceRecord* distance_records =
+        ArrayAt<DistanceRecord>(file, layout.distances);
+    for (size_t i = 0; i < header.distance_slot_count; ++i) {
+        const DistanceRecord& record = distance_records[i];
+        slots.push_back(
+            {record.key, record.length, record.is_explicit != 0});
+    }
+
+    try {
+        return TransportCatalogue::FromRecords(
+            std::move(stops), std::move(routes),
+            DistanceTable::FromSlots(std::move(slots)), std::move(mapping));
+    } catch (const std::invalid_argument&) {
+        throw std::runtime_error("Catalogue snapshot is corrupted");
+    }
+}
+
+void SyncDirectory(const std::filesystem::path& directory)
+{
+#ifndef _WIN32
+    const std::filesystem::path path =
+        directory.empty() ? std::filesystem::path(".") : directory;
+    const int fd = ::open(path.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + path.string());
+    }
+    const bool is_synced = ::fsync(fd) == 0;
+    ::close(fd);
+    if (!is_synced) {
+        throw std::runtime_error("Cannot sync " + path.string());
+    }
+#endif
+}
+
+uint64_t ComputeChecksum(std::span<const std::byte> data)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < data.size(); i += 8) {
+        uint64_t word = 0;
+        std::memcpy(&word, data.data() + i,
+                    std::min<size_t>(sizeof(word), data.size() - i));
+        hash = (hash ^ word) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+} // namespace catalogue_serialization
\ No newline at end of file
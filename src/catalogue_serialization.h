@@ -0,0 +1,44 @@
+// catalogue_serialization.h
+
+#pragma once
+
+#include "transport_catalogue.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+namespace catalogue_serialization {
+
+// Бинарный снимок каталога. Файл состоит из заголовка и плоских массивов:
+// записей остановок, записей маршрутов, ячеек таблицы расстояний, списков
+// остановок маршрутов и общего блока названий. Все массивы выровнены по
+// 8 байт, числа хранятся в порядке байт машины, записавшей файл.
+// Контрольная сумма покрывает все данные после поля checksum.
+inline constexpr char SNAPSHOT_MAGIC[8] = {'T', 'C', 'A', 'T', 'A', 'L',
+                                           'O', 'G'};
+inline constexpr uint32_t SNAPSHOT_VERSION = 1;
+
+// Запись выполняется во временный файл, который сбрасывается на диск и
+// затем переименовывается, поэтому по пути path всегда лежит целый снимок.
+// После переименования на диск сбрасывается и каталог файла: удалять
+// файлы, которые снимок заменяет, можно сразу после возврата.
+void SaveCatalogue(const transport_catalogue::TransportCatalogue& catalogue,
+                   const std::filesystem::path& path);
+
+// Отображает файл в память и собирает по нему замороженный каталог.
+// Названия и списки остановок маршрутов не копируются, а ссылаются на
+// отображенный файл, который удерживается каталогом и его копиями.
+// Бросает std::runtime_error, если файл поврежден или другой версии.
+transport_catalogue::TransportCatalogue LoadCatalogue(
+    const std::filesystem::path& path);
+
+// Сбрасывает на диск записи каталога directory: созданные,
+// переименованные и удаленные в нем файлы. Бросает std::runtime_error.
+void SyncDirectory(const std::filesystem::path& directory);
+
+// FNV-1a по 64-битным словам; неполное последнее слово дополняется нулями
+uint64_t ComputeChecksum(std::span<const std::byte> data);
+
+} // namespace catalogue_serialization
\ No newline at end of file
@@ -0,0 +1,66 @@
+// catalogue_snapshot.cpp
+
+#include "catalogue_snapshot.h"
+
+namespace catalogue_snapshot {
+
+namespace {
+
+transport_catalogue::TransportCatalogue Frozen(
+    transport_catalogue::TransportCatalogue catalogue)
+{
+    catalogue.Freeze();
+    return catalogue;
+}
+
+} // namespace
+
+Snapshot::Snapshot(transport_catalogue::TransportCatalogue catalogue_in,
+                   domain::RouterSettings router_settings,
+                   uint64_t version_in, bool build_routes)
+    : version(version_in)
+    , catalogue(Frozen(std::move(catalogue_in)))
+    , router(build_routes
+                 ? router::TransportRouter(catalogue, router_settings,
+                                           catalogue.GetAllStopsCount())
+                 : router::TransportRouter(router_settings))
+{
+}
+
+SnapshotHolder::SnapshotHolder(
+    transport_catalogue::TransportCatalogue catalogue,
+    domain::RouterSettings router_settings, uint64_t version)
+    : router_settings_(router_settings)
+    , current_(std::make_shared<const Snapshot>(std::move(catalogue),
+                                                router_settings_, version))
+{
+}
+
+std::shared_ptr<const Snapshot> SnapshotHolder::Acquire() const
+{
+    return current_.load(std::memory_order_acquire);
+}
+
+uint64_t SnapshotHolder::Update(
+    const std::function<void(transport_catalogue::TransportCatalogue&)>&
+        apply,
+    const std::function<void(const Snapshot&)>& before_publish)
+{
+    std::lock_guard guard(writer_mutex_);
+
+    const std::shared_ptr<const Snapshot> current = Acquire();
+    transport_catalogue::TransportCatalogue catalogue = current->catalogue;
+    catalogue.Unfreeze();
+    apply(catalogue);
+
+    auto next = std::make_shared<const Snapshot>(
+        std::move(catalogue), router_settings_, current->version + 1);
+    if (before_publish) {
+        before_publish(*next);
+    }
+    const uint64_t version = next->version;
+    current_.store(std::move(next), std::memory_order_release);
+    return version;
+}
+
+} // namespace catalogue_snapshot
\ No newline at end of file
@@ -0,0 +1,61 @@
+// catalogue_snapshot.h
+
+#pragma once
+
+#include "domain.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace catalogue_snapshot {
+
+// Неизменяемая версия каталога вместе с построенным по ней маршрутизатором.
+// Без build_routes маршрутизатор не строит граф и таблицу кратчайших путей:
+// маршруты тогда ищет внешний RouteFinder обработчика запросов.
+struct Snapshot {
+    Snapshot(transport_catalogue::TransportCatalogue catalogue_in,
+             domain::RouterSettings router_settings, uint64_t version_in,
+             bool build_routes = true);
+
+    const uint64_t version;
+    const transport_catalogue::TransportCatalogue catalogue;
+    const router::TransportRouter router;
+};
+
+// Хранит текущую версию каталога. Читатели закрепляют версию через
+// Acquire() и дальше работают с ней без блокировок; версия освобождается,
+// когда её отпускает последний читатель. Писатель готовит следующую версию
+// на копии текущей и атомарно публикует её. Сам Acquire() не обязательно
+// свободен от блокировок: std::atomic<std::shared_ptr> в libstdc++
+// защищен внутренней блокировкой, которая удерживается только на время
+// копирования указателя, а не на время подготовки версии.
+class SnapshotHolder {
+public:
+    SnapshotHolder(transport_catalogue::TransportCatalogue catalogue,
+                   domain::RouterSettings router_settings,
+                   uint64_t version = 1);
+
+    std::shared_ptr<const Snapshot> Acquire() const;
+
+    // Применяет изменения к копии текущей версии, строит по ней новую
+    // версию и публикует её. before_publish вызывается с уже построенной
+    // версией перед публикацией: если он или построение бросают
+    // исключение, текущая версия не меняется. Возвращает номер
+    // опубликованной версии.
+    uint64_t Update(
+        const std::function<void(transport_catalogue::TransportCatalogue&)>&
+            apply,
+        const std::function<void(const Snapshot&)>& before_publish = {});
+
+private:
+    const domain::RouterSettings router_settings_;
+    std::mutex writer_mutex_;
+    std::atomic<std::shared_ptr<const Snapshot>> current_;
+};
+
+} // namespace catalogue_snapshot
\ No newline at end of file
@@ -0,0 +1,219 @@
+// catalogue_store.cpp
+
+#include "catalogue_store.h"
+
+#include "catalogue_serialization.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace catalogue_store {
+
+using namespace transport_catalogue;
+
+namespace {
+
+constexpr std::string_view FILE_PREFIX = "snapshot-";
+constexpr std::string_view FILE_SUFFIX = ".bin";
+
+std::filesystem::path SnapshotPath(const std::filesystem::path& directory,
+                                   uint64_t version)
+{
+    std::string number = std::to_string(version);
+    number.insert(0, 20 - number.size(), '0');
+    return directory /
+           (std::string(FILE_PREFIX) + number + std::string(FILE_SUFFIX));
+}
+
+// Снимки с их версиями, упорядоченные по версиям
+std::vector<std::pair<uint64_t, std::filesystem::path>> ListSnapshots(
+    const std::filesystem::path& directory)
+{
+    std::vector<std::pair<uint64_t, std::filesystem::path>> files;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        const std::string name = entry.path().filename().string();
+        if (name.size() <= FILE_PREFIX.size() + FILE_SUFFIX.size() ||
+            !name.starts_with(FILE_PREFIX) || !name.ends_with(FILE_SUFFIX)) {
+            continue;
+        }
+        const std::string number =
+            name.substr(FILE_PREFIX.size(), name.size() - FILE_PREFIX.size() -
+                                                FILE_SUFFIX.size());
+        if (!std::all_of(number.begin(), number.end(), [](unsigned char c) {
+                return std::isdigit(c);
+            })) {
+            continue;
+        }
+        files.emplace_back(std::stoull(number), entry.path());
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+} // namespace
+
+CatalogueStore::CatalogueStore(std::filesystem::path directory,
+                               domain::RouterSettings router_settings,
+                               size_t compaction_threshold)
+    : CatalogueStore(directory, router_settings, compaction_threshold,
+                     Recover(directory))
+{
+}
+
+CatalogueStore::CatalogueStore(std::filesystem::path directory,
+                               domain::RouterSettings router_settings,
+                               size_t compaction_threshold,
+                               Recovered recovered)
+    : directory_(std::move(directory))
+    , compaction_threshold_(compaction_threshold)
+    , log_(directory_)
+    , holder_(std::move(recovered.catalogue), router_settings,
+              recovered.version)
+{
+    log_.Rotate(recovered.version);
+}
+
+CatalogueStore::~CatalogueStore()
+{
+    if (compaction_.valid()) {
+        compaction_.wait();
+    }
+}
+
+std::shared_ptr<const catalogue_snapshot::Snapshot> CatalogueStore::Acquire()
+    const
+{
+    return holder_.Acquire();
+}
+
+uint64_t CatalogueStore::Apply(const DeltaBatch& batch)
+{
+    std::lock_guard guard(writer_mutex_);
+
+    // Пакет попадает в журнал только после того, как новая версия
+    // построена: иначе при ошибке построения журнал содержал бы версию,
+    // которая не была опубликована
+    const uint64_t version = holder_.Update(
+        [&](TransportCatalogue& catalogue) {
+            if (is_repack_pending_) {
+                catalogue.Repack();
+            }
+            catalogue.ApplyDelta(batch);
+        },
+        [&](const catalogue_snapshot::Snapshot& next) {
+            log_.Append(next.version, batch);
+        });
+    is_repack_pending_ = false;
+
+    if (log_.GetTailSize() >= compaction_threshold_) {
+        // Пакет уже опубликован, поэтому ошибка прошлой компакции не
+        // бросается отсюда, а сохраняется для WaitForCompaction
+        if (compaction_.valid() &&
+            compaction_.wait_for(std::chrono::seconds(0)) ==
+                std::future_status::ready) {
+            try {
+                compaction_.get();
+            } catch (...) {
+                if (!compaction_error_) {
+                    compaction_error_ = std::current_exception();
+                }
+            }
+        }
+        if (!compaction_.valid()) {
+            compaction_ = std::async(std::launch::async, [this] {
+                Compact();
+            });
+        }
+    }
+    return version;
+}
+
+void CatalogueStore::Compact()
+{
+    std::lock_guard compaction_guard(compaction_mutex_);
+
+    std::shared_ptr<const catalogue_snapshot::Snapshot> snapshot;
+    {
+        std::lock_guard guard(writer_mutex_);
+        snapshot = holder_.Acquire();
+        log_.Rotate(snapshot->version);
+    }
+
+    // Снимок пишется без блокировки писателей: версия неизменяема
+    catalogue_serialization::SaveCatalogue(
+        snapshot->catalogue, SnapshotPath(directory_, snapshot->version));
+
+    std::lock_guard guard(writer_mutex_);
+    is_repack_pending_ = true;
+    log_.Discard(snapshot->version);
+    for (const auto& [version, path] : ListSnapshots(directory_)) {
+        if (version < snapshot->version) {
+            std::filesystem::remove(path);
+        }
+    }
+}
+
+void CatalogueStore::WaitForCompaction()
+{
+    std::future<void> compaction;
+    std::exception_ptr error;
+    {
+        std::lock_guard guard(writer_mutex_);
+        compaction = std::move(compaction_);
+        error = std::exchange(compaction_error_, nullptr);
+    }
+    if (compaction.valid()) {
+        try {
+            compaction.get();
+        } catch (...) {
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+CatalogueStore::Recovered CatalogueStore::Recover(
+    const std::filesystem::path& directory)
+{
+    std::filesystem::create_directories(directory);
+
+    // Снимок, запись которого прервалась, остается во временном файле
+    std::vector<std::filesystem::path> unfinished;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        const std::string name = entry.path().filename().string();
+        if (name.starts_with(FILE_PREFIX) && name.ends_with(".tmp")) {
+            unfinished.push_back(entry.path());
+        }
+    }
+    for (const auto& path : unfinished) {
+        std::filesystem::remove(path);
+    }
+
+    Recovered recovered;
+    const auto snapshots = ListSnapshots(directory);
+    if (!snapshots.empty()) {
+        recovered.catalogue =
+            catalogue_serialization::LoadCatalogue(snapshots.back().second);
+        recovered.version = snapshots.back().first;
+        recovered.catalogue.Unfreeze();
+    }
+
+    change_log::ChangeLog(directory).Replay(
+        recovered.version,
+        [&recovered](uint64_t version, const DeltaBatch& batch) {
+            recovered.catalogue.ApplyDelta(batch);
+            recovered.version = version;
+        });
+    return recovered;
+}
+
+} // namespace catalogue_store
\ No newline at end of file
@@ -0,0 +1,81 @@
+// catalogue_store.h
+
+#pragma once
+
+#include "catalogue_snapshot.h"
+#include "change_log.h"
+#include "domain.h"
+#include "transport_catalogue.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <mutex>
+
+namespace catalogue_store {
+
+// Каталог, который хранится на диске как бинарный снимок
+// snapshot-<N>.bin и журнал пакетов изменений после версии N.
+// При запуске загружается последний снимок и воспроизводится только
+// хвост журнала. Компакция сохраняет текущую версию в новый снимок и
+// удаляет поглощенные им файлы журнала; она выполняется в фоне, когда
+// в текущем файле журнала накопилось compaction_threshold записей.
+// Названия и списки остановок удаленных и замененных записей остаются в
+// памяти до первого пакета после компакции, который переносит каталог в
+// новое хранилище (TransportCatalogue::Repack), поэтому память долго
+// работающего хранилища не растет без перезапуска.
+class CatalogueStore {
+public:
+    CatalogueStore(std::filesystem::path directory,
+                   domain::RouterSettings router_settings,
+                   size_t compaction_threshold = 1024);
+
+    // Дожидается фоновой компакции
+    ~CatalogueStore();
+
+    std::shared_ptr<const catalogue_snapshot::Snapshot> Acquire() const;
+
+    // Применяет пакет к копии текущей версии, строит по ней новую версию,
+    // записывает пакет в журнал и публикует версию. Если пакет не
+    // применяется или версия не строится, ни журнал, ни опубликованная
+    // версия не меняются. Возвращает номер новой версии.
+    uint64_t Apply(const transport_catalogue::DeltaBatch& batch);
+
+    // Сворачивает журнал в снимок текущей версии в вызывающем потоке
+    void Compact();
+
+    // Дожидается фоновой компакции и передает первую ошибку фоновых
+    // компакций с прошлого вызова. Apply таких ошибок не бросает.
+    void WaitForCompaction();
+
+private:
+    struct Recovered {
+        transport_catalogue::TransportCatalogue catalogue;
+        uint64_t version = 0;
+    };
+
+    std::filesystem::path directory_;
+    const size_t compaction_threshold_;
+    change_log::ChangeLog log_;
+    catalogue_snapshot::SnapshotHolder holder_;
+    std::mutex writer_mutex_;
+    std::mutex compaction_mutex_;
+    std::future<void> compaction_;
+    // Ошибка завершившейся компакции, которую еще не передал
+    // WaitForCompaction
+    std::exception_ptr compaction_error_;
+    // После компакции следующая версия переносится в новые пул названий и
+    // арену списков остановок: удаленные записи не копятся в памяти
+    bool is_repack_pending_ = false;
+
+    CatalogueStore(std::filesystem::path directory,
+                   domain::RouterSettings router_settings,
+                   size_t compaction_threshold, Recovered recovered);
+
+    static Recovered Recover(const std::filesystem::path& directory);
+};
+
+} // namespace catalogue_store
\ No newline at end of file
@@ -0,0 +1,381 @@
+// change_log.cpp
+
+#include "change_log.h"
+
+#include "catalogue_serialization.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace change_log {
+
+using namespace transport_catalogue;
+
+namespace {
+
+constexpr std::string_view FILE_PREFIX = "changes-";
+constexpr std::string_view FILE_SUFFIX = ".log";
+
+struct RecordHeader {
+    uint32_t size;
+    uint32_t reserved;
+    uint64_t version;
+    uint64_t checksum;
+};
+
+std::span<const std::byte> AsBytes(std::string_view data)
+{
+    return std::as_bytes(std::span<const char>(data.data(), data.size()));
+}
+
+// Номер версии в имени дополняется нулями, чтобы порядок имен совпадал
+// с порядком версий
+std::filesystem::path LogPath(const std::filesystem::path& directory,
+                              uint64_t version)
+{
+    std::string number = std::to_string(version);
+    number.insert(0, 20 - number.size(), '0');
+    return directory /
+           (std::string(FILE_PREFIX) + number + std::string(FILE_SUFFIX));
+}
+
+// Файлы журнала с версиями начала, упорядоченные по версиям
+std::vector<std::pair<uint64_t, std::filesystem::path>> ListLogFiles(
+    const std::filesystem::path& directory)
+{
+    std::vector<std::pair<uint64_t, std::filesystem::path>> files;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        const std::string name = entry.path().filename().string();
+        if (name.size() <= FILE_PREFIX.size() + FILE_SUFFIX.size() ||
+            !name.starts_with(FILE_PREFIX) || !name.ends_with(FILE_SUFFIX)) {
+            continue;
+        }
+        const std::string number =
+            name.substr(FILE_PREFIX.size(), name.size() - FILE_PREFIX.size() -
+                                                FILE_SUFFIX.size());
+        if (!std::all_of(number.begin(), number.end(), [](unsigned char c) {
+                return std::isdigit(c);
+            })) {
+            continue;
+        }
+        files.emplace_back(std::stoull(number), entry.path());
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+class Encoder {
+public:
+    template <typename T>
+    void Write(T value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        data_.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void WriteString(std::string_view value)
+    {
+        Write(static_cast<uint32_t>(value.size()));
+        data_.append(value);
+    }
+
+    const std::string& GetData() const
+    {
+        return data_;
+    }
+
+private:
+    std::string data_;
+};
+
+class Decoder {
+public:
+    explicit Decoder(std::string_view data)
+        : data_(data)
+    {
+    }
+
+    template <typename T>
+    T Read()
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value;
+        std::memcpy(&value, Take(sizeof(value)).data(), sizeof(value));
+        return value;
+    }
+
+    std::string_view ReadString()
+    {
+        return Take(Read<uint32_t>());
+    }
+
+    size_t ReadCount()
+    {
+        // Каждый элемент занимает хотя бы байт: это ограничивает резерв
+        const size_t count = Read<uint32_t>();
+        if (count > data_.size()) {
+            throw std::runtime_error("Change log record is corrupted");
+        }
+        return count;
+    }
+
+    bool IsEmpty() const
+    {
+        return data_.empty();
+    }
+
+private:
+    std::string_view data_;
+
+    std::string_view Take(size_t size)
+    {
+        if (size > data_.size()) {
+            throw std::runtime_error("Change log record is corrupted");
+        }
+        const std::string_view result = data_.substr(0, size);
+        data_.remove_prefix(size);
+        return result;
+    }
+};
+
+std::string EncodeBatch(const DeltaBatch& batch)
+{
+    Encoder encoder;
+    encoder.Write(static_cast<uint32_t>(batch.stops.size()));
+    for (const StopData& stop : batch.stops) {
+        encoder.WriteString(stop.name);
+        encoder.Write(stop.coordinates.lat);
+        encoder.Write(stop.coordinates.lng);
+        encoder.Write(static_cast<uint32_t>(stop.road_distances.size()));
+        for (const auto& [to, length] : stop.road_distances) {
+            encoder.WriteString(to);
+            encoder.Write(static_cast<uint64_t>(length));
+        }
+    }
+    encoder.Write(static_cast<uint32_t>(batch.routes.size()));
+    for (const RouteData& route : batch.routes) {
+        encoder.WriteString(route.name);
+        encoder.Write(static_cast<uint8_t>(route.is_roundtrip));
+        encoder.Write(static_cast<uint32_t>(route.stops.size()));
+        for (std::string_view stop : route.stops) {
+            encoder.WriteString(stop);
+        }
+    }
+    encoder.Write(static_cast<uint32_t>(batch.distances.size()));
+    for (const DistanceData& distance : batch.distances) {
+        encoder.WriteString(distance.from);
+        encoder.WriteString(distance.to);
+        encoder.Write(static_cast<uint64_t>(distance.length));
+    }
+    encoder.Write(static_cast<uint32_t>(batch.removed_routes.size()));
+    for (std::string_view name : batch.removed_routes) {
+        encoder.WriteString(name);
+    }
+    encoder.Write(static_cast<uint32_t>(batch.removed_distances.size()));
+    for (const auto& [from, to] : batch.removed_distances) {
+        encoder.WriteString(from);
+        encoder.WriteString(to);
+    }
+    encoder.Write(static_cast<uint32_t>(batch.removed_stops.size()));
+    for (std::string_view name : batch.removed_stops) {
+        encoder.WriteString(name);
+    }
+    return encoder.GetData();
+}
+
+DeltaBatch DecodeBatch(std::string_view data)
+{
+    Decoder decoder(data);
+    DeltaBatch batch;
+    batch.stops.resize(decoder.ReadCount());
+    for (StopData& stop : batch.stops) {
+        stop.name = decoder.ReadString();
+        stop.coordinates.lat = decoder.Read<double>();
+        stop.coordinates.lng = decoder.Read<double>();
+        stop.road_distances.resize(decoder.ReadCount());
+        for (auto& [to, length] : stop.road_distances) {
+            to = decoder.ReadString();
+            length = decoder.Read<uint64_t>();
+        }
+    }
+    batch.routes.resize(decoder.ReadCount());
+    for (RouteData& route : batch.routes) {
+        route.name = decoder.ReadString();
+        route.is_roundtrip = decoder.Read<uint8_t>() != 0;
+        route.stops.resize(decoder.ReadCount());
+        for (std::string_view& stop : route.stops) {
+            stop = decoder.ReadString();
+        }
+    }
+    batch.distances.resize(decoder.ReadCount());
+    for (DistanceData& distance : batch.distances) {
+        distance.from = decoder.ReadString();
+        distance.to = decoder.ReadString();
+        distance.length = decoder.Read<uint64_t>();
+    }
+    batch.removed_routes.resize(decoder.ReadCount());
+    for (std::string_view& name : batch.removed_routes) {
+        name = decoder.ReadString();
+    }
+    batch.removed_distances.resize(decoder.ReadCount());
+    for (auto& [from, to] : batch.removed_distances) {
+        from = decoder.ReadString();
+        to = decoder.ReadString();
+    }
+    batch.removed_stops.resize(decoder.ReadCount());
+    for (std::string_view& name : batch.removed_stops) {
+        name = decoder.ReadString();
+    }
+    if (!decoder.IsEmpty()) {
+        throw std::runtime_error("Change log record is corrupted");
+    }
+    return batch;
+}
+
+} // namespace
+
+ChangeLog::ChangeLog(std::filesystem::path directory)
+    : directory_(std::move(directory))
+{
+    std::filesystem::create_directories(directory_);
+}
+
+void ChangeLog::Append(uint64_t version, const DeltaBatch& batch)
+{
+    if (!file_) {
+        throw std::logic_error("Change log is not open for writing");
+    }
+    const std::string payload = EncodeBatch(batch);
+    const RecordHeader header{static_cast<uint32_t>(payload.size()), 0,
+                              version,
+                              catalogue_serialization::ComputeChecksum(
+                                  AsBytes(payload))};
+    std::string record(reinterpret_cast<const char*>(&header),
+                       sizeof(header));
+    record += payload;
+    const long offset = std::ftell(file_.get());
+    if (offset < 0) {
+        throw std::runtime_error("Cannot write change log");
+    }
+    bool is_written =
+        std::fwrite(record.data(), 1, record.size(), file_.get()) ==
+            record.size() &&
+        std::fflush(file_.get()) == 0;
+#ifndef _WIN32
+    is_written = is_written && ::fsync(::fileno(file_.get())) == 0;
+#endif
+    if (!is_written) {
+        // Оборванная запись скрыла бы от Replay все следующие записи файла:
+        // файл обрезается до ее начала, а если это не удается, закрывается
+        // до следующего Rotate
+        std::clearerr(file_.get());
+        bool is_restored = std::fseek(file_.get(), offset, SEEK_SET) == 0;
+#ifndef _WIN32
+        is_restored = is_restored &&
+                      ::ftruncate(::fileno(file_.get()), offset) == 0;
+#else
+        is_restored = false;
+#endif
+        if (!is_restored) {
+            file_.reset();
+        }
+        throw std::runtime_error("Cannot write change log");
+    }
+    ++tail_size_;
+}
+
+void ChangeLog::Rotate(uint64_t version)
+{
+    if (file_ && file_version_ == version) {
+        return;
+    }
+    const std::filesystem::path path = LogPath(directory_, version);
+    // Файл с той же версией мог остаться от прошлого запуска: его записи
+    // уже воспроизведены, новые начинаются с чистого файла
+    std::unique_ptr<std::FILE, FileCloser> file(
+        std::fopen(path.string().c_str(), "wb"));
+    if (!file) {
+        throw std::runtime_error("Cannot create " + path.string());
+    }
+    // Без буфера потока после неудачной записи в нем не остается байтов,
+    // которые попали бы в файл при следующей записи
+    std::setvbuf(file.get(), nullptr, _IONBF, 0);
+    // Записи, сброшенные на диск в файл без записи в каталоге, после сбоя
+    // питания не найти
+    catalogue_serialization::SyncDirectory(directory_);
+    file_ = std::move(file);
+    file_version_ = version;
+    tail_size_ = 0;
+}
+
+void ChangeLog::Discard(uint64_t version)
+{
+    const auto files = ListLogFiles(directory_);
+    // Файл содержит версии до начала следующего файла
+    for (size_t i = 0; i + 1 < files.size(); ++i) {
+        if (files[i + 1].first <= version &&
+            !(file_ && files[i].first == file_version_)) {
+            std::filesystem::remove(files[i].second);
+        }
+    }
+}
+
+void ChangeLog::Replay(
+    uint64_t version,
+    const std::function<void(uint64_t, const DeltaBatch&)>& apply) const
+{
+    for (const auto& [file_version, path] : ListLogFiles(directory_)) {
+        std::ifstream input(path, std::ios::binary);
+        const std::string content((std::istreambuf_iterator<char>(input)),
+                                  std::istreambuf_iterator<char>());
+        std::string_view data = content;
+        while (data.size() >= sizeof(RecordHeader)) {
+            RecordHeader header;
+            std::memcpy(&header, data.data(), sizeof(header));
+            data.remove_prefix(sizeof(header));
+            if (header.size > data.size()) {
+                break;
+            }
+            const std::string_view payload = data.substr(0, header.size);
+            data.remove_prefix(header.size);
+            if (catalogue_serialization::ComputeChecksum(AsBytes(payload)) !=
+                header.checksum) {
+                break;
+            }
+            if (header.version > version + 1) {
+                // Пропущенная версия: следующие записи к каталогу не
+                // применимы
+                return;
+            }
+            if (header.version > version) {
+                apply(header.version, DecodeBatch(payload));
+                version = header.version;
+            }
+        }
+    }
+}
+
+size_t ChangeLog::GetTailSize() const
+{
+    return tail_size_;
+}
+
+void ChangeLog::FileCloser::operator()(std::FILE* file) const
+{
+    std::fclose(file);
+}
+
+} // namespace change_log
\ No newline at end of file
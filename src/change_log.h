@@ -0,0 +1,59 @@
+// change_log.h
+
+#pragma once
+
+#include "transport_catalogue.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <memory>
+
+namespace change_log {
+
+// Журнал пакетов изменений каталога. Записи дописываются в файлы
+// changes-<N>.log, где N - версия каталога, после которой начинается файл.
+// Каждая запись хранит версию, которую получил каталог после применения
+// пакета, длину и контрольную сумму. Запись, оборванная при сбое,
+// и все следующие за ней в том же файле при чтении отбрасываются; на
+// пропуске версии чтение журнала прекращается.
+class ChangeLog {
+public:
+    explicit ChangeLog(std::filesystem::path directory);
+
+    // Дописывает пакет и сбрасывает его на диск до возврата. Если запись
+    // не удалась, ее начало из файла удаляется.
+    void Append(uint64_t version,
+                const transport_catalogue::DeltaBatch& batch);
+
+    // Начинает новый файл для версий после version и сбрасывает на диск
+    // запись о нем в каталоге
+    void Rotate(uint64_t version);
+
+    // Удаляет файлы, все записи которых не новее version
+    void Discard(uint64_t version);
+
+    // Передает apply по порядку все записи новее version. Строки пакета
+    // действительны только во время вызова apply.
+    void Replay(uint64_t version,
+                const std::function<void(
+                    uint64_t, const transport_catalogue::DeltaBatch&)>& apply)
+        const;
+
+    // Число записей в текущем файле
+    size_t GetTailSize() const;
+
+private:
+    struct FileCloser {
+        void operator()(std::FILE* file) const;
+    };
+
+    std::filesystem::path directory_;
+    std::unique_ptr<std::FILE, FileCloser> file_;
+    uint64_t file_version_ = 0;
+    size_t tail_size_ = 0;
+};
+
+} // namespace change_log
\ No newline at end of file
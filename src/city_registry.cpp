@@ -0,0 +1,99 @@
+// city_registry.cpp
+
+#include "city_registry.h"
+
+#include "catalogue_serialization.h"
+
+#include <stdexcept>
+#include <utility>
+
+namespace city_registry {
+
+City::City(const CitySettings& settings)
+    : snapshot(std::make_shared<const catalogue_snapshot::Snapshot>(
+          catalogue_serialization::LoadCatalogue(settings.snapshot_file),
+          settings.router_settings, 1))
+    , renderer(settings.render_settings)
+    , handler(snapshot, renderer)
+    , memory_usage(std::filesystem::file_size(settings.snapshot_file) +
+                   snapshot->router.GetMemoryUsage())
+{
+}
+
+CityRegistry::CityRegistry(size_t memory_budget)
+    : memory_budget_(memory_budget)
+{
+}
+
+void CityRegistry::AddCity(std::string name, CitySettings settings)
+{
+    std::lock_guard lock(mutex_);
+    Entry entry;
+    entry.settings = std::move(settings);
+    if (!cities_.emplace(std::move(name), std::move(entry)).second) {
+        throw std::invalid_argument("City is already added");
+    }
+}
+
+std::shared_ptr<const City> CityRegistry::Acquire(std::string_view name)
+{
+    std::unique_lock lock(mutex_);
+    const auto it = cities_.find(name);
+    if (it == cities_.end()) {
+        throw std::out_of_range("Unknown city");
+    }
+    Entry& entry = it->second;
+    if (entry.city) {
+        lru_.splice(lru_.begin(), lru_, entry.lru_position);
+        return entry.city;
+    }
+    if (entry.loading.valid()) {
+        // Город уже загружается в другом потоке
+        const auto loading = entry.loading;
+        lock.unlock();
+        return loading.get();
+    }
+
+    std::promise<std::shared_ptr<const City>> promise;
+    entry.loading = promise.get_future().share();
+    lock.unlock();
+
+    // Настройки города не меняются после AddCity, а узлы std::map не
+    // перемещаются, поэтому entry доступна без блокировки
+    std::shared_ptr<const City> city;
+    try {
+        city = std::make_shared<const City>(entry.settings);
+    } catch (...) {
+        lock.lock();
+        entry.loading = {};
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+
+    lock.lock();
+    entry.loading = {};
+    entry.city = city;
+    entry.lru_position = lru_.insert(lru_.begin(), &entry);
+    memory_usage_ += city->memory_usage;
+    EvictExcept(entry);
+    promise.set_value(city);
+    return city;
+}
+
+size_t CityRegistry::GetMemoryUsage() const
+{
+    std::lock_guard lock(mutex_);
+    return memory_usage_;
+}
+
+void CityRegistry::EvictExcept(const Entry& keep)
+{
+    while (memory_usage_ > memory_budget_ && lru_.back() != &keep) {
+        Entry& victim = *lru_.back();
+        lru_.pop_back();
+        memory_usage_ -= victim.city->memory_usage;
+        victim.city.reset();
+    }
+}
+
+} // namespace city_registry
\ No newline at end of file
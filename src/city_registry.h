@@ -0,0 +1,81 @@
+// city_registry.h
+
+#pragma once
+
+#include "catalogue_snapshot.h"
+#include "domain.h"
+#include "map_renderer.h"
+#include "request_handler.h"
+
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace city_registry {
+
+struct CitySettings {
+    std::filesystem::path snapshot_file;
+    domain::RouterSettings router_settings;
+    map_renderer::RenderSettings render_settings;
+};
+
+// Загруженный город: каталог из бинарного снимка, маршрутизатор,
+// отрисовщик карты и обработчик запросов к ним
+struct City {
+    explicit City(const CitySettings& settings);
+
+    City(const City&) = delete;
+    City& operator=(const City&) = delete;
+
+    const std::shared_ptr<const catalogue_snapshot::Snapshot> snapshot;
+    const map_renderer::MapRenderer renderer;
+    const request_handler::RequestHandler handler;
+    // Оценка памяти: размер снимка и структуры маршрутизатора
+    const size_t memory_usage;
+};
+
+// Города одного процесса. Город загружается при первом запросе к нему;
+// если оценка памяти загруженных городов превышает memory_budget, из
+// реестра выгружаются города, к которым дольше всего не обращались.
+// Выгруженный город освобождается, когда его отпускает последний
+// читатель, и загружается заново при следующем запросе.
+// Методы можно вызывать из нескольких потоков: разные города
+// загружаются параллельно, один город - однократно.
+class CityRegistry {
+public:
+    explicit CityRegistry(size_t memory_budget);
+
+    void AddCity(std::string name, CitySettings settings);
+
+    // Бросает std::out_of_range, если город не добавлен
+    std::shared_ptr<const City> Acquire(std::string_view name);
+
+    // Оценка памяти городов, которые удерживает реестр
+    size_t GetMemoryUsage() const;
+
+private:
+    struct Entry {
+        CitySettings settings;
+        std::shared_ptr<const City> city;
+        std::shared_future<std::shared_ptr<const City>> loading;
+        std::list<Entry*>::iterator lru_position;
+    };
+
+    const size_t memory_budget_;
+    mutable std::mutex mutex_;
+    std::map<std::string, Entry, std::less<>> cities_;
+    // Загруженные города, недавно запрошенные первыми
+    std::list<Entry*> lru_;
+    size_t memory_usage_ = 0;
+
+    void EvictExcept(const Entry& keep);
+};
+
+} // namespace city_registry
\ No newline at end of file
@@ -0,0 +1,217 @@
+// distance_table.cpp
+
+#include "distance_table.h"
+
+#include <limits>
+#include <stdexcept>
+
+namespace transport_catalogue {
+
+namespace {
+
+constexpr size_t MIN_CAPACITY = 16;
+
+size_t CapacityFor(size_t count)
+{
+    size_t capacity = MIN_CAPACITY;
+    while (capacity < count * 2) {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+} // namespace
+
+DistanceTable DistanceTable::FromSlots(std::vector<Slot> slots)
+{
+    if (!slots.empty() &&
+        (slots.size() < MIN_CAPACITY || (slots.size() & (slots.size() - 1)))) {
+        throw std::invalid_argument("Invalid distance table capacity");
+    }
+    DistanceTable table;
+    table.slots_ = std::move(slots);
+    for (const Slot& slot : table.slots_) {
+        table.size_ += slot.key != EMPTY_KEY;
+    }
+    if (table.size_ * 2 > table.slots_.size()) {
+        throw std::invalid_argument("Distance table is overloaded");
+    }
+    return table;
+}
+
+void DistanceTable::Reserve(size_t count)
+{
+    // Каждое расстояние может занять две ячейки: прямую и обратную
+    const size_t capacity = CapacityFor(count * 2);
+    if (capacity > slots_.size()) {
+        Rehash(capacity);
+    }
+}
+
+void DistanceTable::Set(domain::StopId from, domain::StopId to,
+                        size_t length)
+{
+    if (length > std::numeric_limits<uint32_t>::max()) {
+        throw std::out_of_range("Road distance is too large");
+    }
+    const uint32_t value = static_cast<uint32_t>(length);
+    Insert(MakeKey(from, to), value, true);
+    if (from != to) {
+        Insert(MakeKey(to, from), value, false);
+    }
+}
+
+size_t DistanceTable::Get(domain::StopId from, domain::StopId to) const
+{
+    const Slot* slot = FindSlot(MakeKey(from, to));
+    return slot ? slot->length : 0;
+}
+
+bool DistanceTable::Erase(domain::StopId from, domain::StopId to)
+{
+    if (slots_.empty()) {
+        return false;
+    }
+    Slot& forward = FindSlot(MakeKey(from, to));
+    if (forward.key == EMPTY_KEY || !forward.is_explicit) {
+        return false;
+    }
+    if (from == to) {
+        EraseSlot(forward);
+        return true;
+    }
+    const Slot& backward = FindSlot(MakeKey(to, from));
+    if (backward.is_explicit) {
+        forward.length = backward.length;
+        forward.is_explicit = false;
+    } else {
+        EraseSlot(forward);
+        EraseSlot(FindSlot(MakeKey(to, from)));
+    }
+    return true;
+}
+
+void DistanceTable::RemoveStop(domain::StopId stop_id,
+                               domain::StopId moved_id)
+{
+    const auto renumber = [&](domain::StopId id) {
+        return id == moved_id ? stop_id : id;
+    };
+    std::vector<Slot> old_slots(slots_.size());
+    old_slots.swap(slots_);
+    size_ = 0;
+    for (const Slot& slot : old_slots) {
+        if (slot.key == EMPTY_KEY) {
+            continue;
+        }
+        const auto from = static_cast<domain::StopId>(slot.key >> 32);
+        const auto to = static_cast<domain::StopId>(slot.key);
+        if (from == stop_id || to == stop_id) {
+            continue;
+        }
+        const uint64_t key = MakeKey(renumber(from), renumber(to));
+        FindSlot(key) = {key, slot.length, slot.is_explicit};
+        ++size_;
+    }
+}
+
+size_t DistanceTable::Size() const
+{
+    return size_;
+}
+
+std::span<const DistanceTable::Slot> DistanceTable::GetSlots() const
+{
+    return slots_;
+}
+
+uint64_t DistanceTable::MakeKey(domain::StopId from, domain::StopId to)
+{
+    return (static_cast<uint64_t>(from) << 32) | to;
+}
+
+uint64_t DistanceTable::Mix(uint64_t key)
+{
+    // Финализатор splitmix64
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebULL;
+    key ^= key >> 31;
+    return key;
+}
+
+DistanceTable::Slot& DistanceTable::FindSlot(uint64_t key)
+{
+    const size_t mask = slots_.size() - 1;
+    for (size_t i = Mix(key) & mask;; i = (i + 1) & mask) {
+        if (slots_[i].key == key || slots_[i].key == EMPTY_KEY) {
+            return slots_[i];
+        }
+    }
+}
+
+const DistanceTable::Slot* DistanceTable::FindSlot(uint64_t key) const
+{
+    if (slots_.empty()) {
+        return nullptr;
+    }
+    const size_t mask = slots_.size() - 1;
+    for (size_t i = Mix(key) & mask;; i = (i + 1) & mask) {
+        if (slots_[i].key == key) {
+            return &slots_[i];
+        }
+        if (slots_[i].key == EMPTY_KEY) {
+            return nullptr;
+        }
+    }
+}
+
+void DistanceTable::Insert(uint64_t key, uint32_t length, bool is_explicit)
+{
+    if ((size_ + 1) * 2 > slots_.size()) {
+        Rehash(CapacityFor(size_ + 1));
+    }
+    Slot& slot = FindSlot(key);
+    if (slot.key == EMPTY_KEY) {
+        slot = {key, length, is_explicit};
+        ++size_;
+    } else if (is_explicit || !slot.is_explicit) {
+        slot.length = length;
+        slot.is_explicit = is_explicit;
+    }
+}
+
+void DistanceTable::EraseSlot(Slot& slot)
+{
+    // Удаление со сдвигом: ячейки той же цепочки пробирования
+    // переносятся на освободившееся место, чтобы поиск не прерывался
+    const size_t mask = slots_.size() - 1;
+    size_t hole = static_cast<size_t>(&slot - slots_.data());
+    slots_[hole] = {};
+    --size_;
+    for (size_t i = (hole + 1) & mask; slots_[i].key != EMPTY_KEY;
+         i = (i + 1) & mask) {
+        const size_t home = Mix(slots_[i].key) & mask;
+        // Ячейку можно сдвинуть, если её начальная позиция не лежит
+        // циклически в промежутке (hole, i]
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            slots_[hole] = slots_[i];
+            slots_[i] = {};
+            hole = i;
+        }
+    }
+}
+
+void DistanceTable::Rehash(size_t capacity)
+{
+    std::vector<Slot> old_slots(capacity);
+    old_slots.swap(slots_);
+    for (const Slot& slot : old_slots) {
+        if (slot.key != EMPTY_KEY) {
+            FindSlot(slot.key) = slot;
+        }
+    }
+}
+
+} // namespace transport_catalogue
\ No newline at end of file
@@ -0,0 +1,63 @@
+// distance_table.h
+
+#pragma once
+
+#include "domain.h"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace transport_catalogue {
+
+// Таблица дорожных расстояний с открытой адресацией. Ключ - пара
+// идентификаторов остановок, упакованная в 64 бита. Обратное направление
+// записывается при вставке, если для него не задано собственное расстояние,
+// поэтому поиск выполняется за один проход пробирования.
+class DistanceTable {
+public:
+    static constexpr uint64_t EMPTY_KEY = ~uint64_t{0};
+
+    struct Slot {
+        uint64_t key = EMPTY_KEY;
+        uint32_t length = 0;
+        bool is_explicit = false;
+    };
+
+    // Восстанавливает таблицу из ячеек, полученных через GetSlots
+    static DistanceTable FromSlots(std::vector<Slot> slots);
+
+    void Reserve(size_t count);
+
+    void Set(domain::StopId from, domain::StopId to, size_t length);
+
+    size_t Get(domain::StopId from, domain::StopId to) const;
+
+    // Удаляет заданное расстояние from -> to. Если для обратного
+    // направления задано собственное расстояние, оно снова используется и
+    // для прямого. Возвращает false, если расстояние не было задано.
+    bool Erase(domain::StopId from, domain::StopId to);
+
+    // Удаляет все расстояния остановки stop_id и переносит расстояния
+    // остановки moved_id на идентификатор stop_id
+    void RemoveStop(domain::StopId stop_id, domain::StopId moved_id);
+
+    size_t Size() const;
+
+    std::span<const Slot> GetSlots() const;
+
+private:
+    std::vector<Slot> slots_;
+    size_t size_ = 0;
+
+    static uint64_t MakeKey(domain::StopId from, domain::StopId to);
+    static uint64_t Mix(uint64_t key);
+
+    Slot& FindSlot(uint64_t key);
+    const Slot* FindSlot(uint64_t key) const;
+    void Insert(uint64_t key, uint32_t length, bool is_explicit);
+    void EraseSlot(Slot& slot);
+    void Rehash(size_t capacity);
+};
+
+} // namespace transport_catalogue
\ No newline at end of file
@@ -5,21 +5,213 @@
 #include "geo.h"
 #include "graph.h"
 
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
 namespace domain {
 
+using StopId = uint32_t;
+using RouteId = uint32_t;
+
 struct Stop {
-    std::string name;
+    std::string_view name;
     geo::Coordinates coordinates;
+    StopId id = 0;
+};
+
+// Полная последовательность остановок маршрута. Для некольцевого маршрута
+// обратный путь не хранится, а достраивается при обходе: A-B-C -> A-B-C-B-A
+class RouteStops {
+public:
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = StopId;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const StopId*;
+        using reference = StopId;
+
+        Iterator() = default;
+
+        Iterator(std::span<const StopId> forward, size_t size, size_t index)
+            : forward_(forward)
+            , size_(size)
+            , index_(index)
+        {
+        }
+
+        StopId operator*() const
+        {
+            return RouteStops::At(forward_, size_, index_);
+        }
+
+        Iterator& operator++()
+        {
+            ++index_;
+            return *this;
+        }
+
+        Iterator operator++(int)
+        {
+            Iterator copy = *this;
+            ++index_;
+            return copy;
+        }
+
+        bool operator==(const Iterator& rhs) const
+        {
+            return index_ == rhs.index_;
+        }
+
+        bool operator!=(const Iterator& rhs) const
+        {
+            return !(*this == rhs);
+        }
+
+    private:
+        std::span<const StopId> forward_;
+        size_t size_ = 0;
+        size_t index_ = 0;
+    };
+
+    RouteStops(std::span<const StopId> forward, bool is_roundtrip)
+        : forward_(forward)
+        , size_(is_roundtrip || forward.empty() ? forward.size()
+                                                : 2 * forward.size() - 1)
+    {
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    StopId operator[](size_t index) const
+    {
+        return At(forward_, size_, index);
+    }
+
+    StopId front() const
+    {
+        return forward_.front();
+    }
+
+    StopId back() const
+    {
+        return (*this)[size_ - 1];
+    }
+
+    Iterator begin() const
+    {
+        return {forward_, size_, 0};
+    }
+
+    Iterator end() const
+    {
+        return {forward_, size_, size_};
+    }
+
+    // Остановки прямого направления, без достроенного обратного пути
+    std::span<const StopId> GetForward() const
+    {
+        return forward_;
+    }
+
+private:
+    std::span<const StopId> forward_;
+    size_t size_;
+
+    static StopId At(std::span<const StopId> forward, size_t size,
+                     size_t index)
+    {
+        return index < forward.size() ? forward[index]
+                                      : forward[size - 1 - index];
+    }
 };
 
 struct Route {
-    std::string name;
-    std::vector<Stop*> stops;
+    std::string_view name;
+    // Остановки в прямом направлении, как в запросе Bus. Хранятся в
+    // арене каталога или в загруженном снимке
+    std::span<const StopId> stops;
     bool is_roundtrip;
+    RouteId id = 0;
+
+    RouteStops GetStops() const
+    {
+        return RouteStops(stops, is_roundtrip);
+    }
+};
+
+// Легковесные ссылки на записи каталога без копирования данных.
+// Действительны, пока каталог не изменяется.
+class StopView {
+public:
+    explicit StopView(const Stop& stop)
+        : stop_(&stop)
+    {
+    }
+
+    StopId GetId() const
+    {
+        return stop_->id;
+    }
+
+    std::string_view GetName() const
+    {
+        return stop_->name;
+    }
+
+    geo::Coordinates GetCoordinates() const
+    {
+        return stop_->coordinates;
+    }
+
+private:
+    const Stop* stop_;
+};
+
+class RouteView {
+public:
+    explicit RouteView(const Route& route)
+        : route_(&route)
+    {
+    }
+
+    RouteId GetId() const
+    {
+        return route_->id;
+    }
+
+    std::string_view GetName() const
+    {
+        return route_->name;
+    }
+
+    RouteStops GetStops() const
+    {
+        return route_->GetStops();
+    }
+
+    bool IsRoundtrip() const
+    {
+        return route_->is_roundtrip;
+    }
+
+private:
+    const Route* route_;
 };
 
 struct RouteStats {
@@ -29,27 +221,44 @@ struct RouteStats {
     size_t uniquestops_count;
 };
 
-class HasherPairPtr {
-public:
-    size_t operator()(const std::pair<Stop*, Stop*>& pair_ptr) const;
-};
-
 struct RouterSettings {
     double bus_wait_time = 0;
     double bus_velocity = 0;
+    // Скорость пешехода, км/ч
+    double pedestrian_velocity = 5;
+    // Число ближайших остановок, к которым привязывается точка маршрута
+    size_t snap_stops_count = 3;
+    // Радиус пешей пересадки между остановками, метры; 0 - без пересадок
+    double walk_transfer_radius = 0;
 };
 
 struct StopEdge {
-    Stop* stopptr;
+    StopId stop_id;
     double time = 0;
 };
 
 struct BusEdge {
-    const Route* busptr;
+    RouteId route_id;
     size_t span_count = 0;
     double time = 0;
 };
 
+// Пеший переход; отсутствующая остановка означает точку из запроса
+struct WalkEdge {
+    std::optional<StopId> from;
+    std::optional<StopId> to;
+    double time = 0;
+};
+
+using RouteItem = std::variant<StopEdge, BusEdge, WalkEdge>;
+
+// Остановка, с которой может начаться или которой может закончиться
+// маршрут, и время пешего пути между ней и точкой из запроса
+struct RouteEndpoint {
+    StopId stop_id;
+    double walk_time = 0;
+};
+
 struct StopVertexIds {
     graph::VertexId bus_wait_start;
     graph::VertexId bus_wait_end;
@@ -57,7 +266,7 @@ struct StopVertexIds {
 
 struct RouteInfo {
     double total_time = 0.;
-    std::vector<std::variant<StopEdge, BusEdge>> edges;
+    std::vector<RouteItem> edges;
 };
 
 } // namespace domain
\ No newline at end of file
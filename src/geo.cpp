@@ -3,8 +3,14 @@
 #define _USE_MATH_DEFINES
 #include "geo.h"
 
+#include <algorithm>
+#include <cassert>
 #include <cmath>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 namespace geo {
 
 bool operator==(const Coordinates& lhs, const Coordinates& rhs)
@@ -17,16 +23,84 @@ bool operator!=(const Coordinates& lhs, const Coordinates& rhs)
     return !(lhs == rhs);
 }
 
+namespace {
+
+// Косинус углового расстояния между близкими точками после округления
+// может выйти за 1, и acos вернул бы NaN. У совпадающих точек он может
+// оказаться и чуть меньше 1, что дало бы около 0,1 м вместо нуля.
+double ArcLength(Coordinates from, Coordinates to, double cosine)
+{
+    if (from == to) {
+        return 0;
+    }
+    return std::acos(std::clamp(cosine, -1.0, 1.0)) * EARTH_RADIUS;
+}
+
+} // namespace
+
 double ComputeDistance(Coordinates from, Coordinates to)
 {
     using namespace std;
     const double dr = M_PI / 180.0;
-    static const int earth_radius = 6371000;
-    
-    return acos(sin(from.lat * dr) * sin(to.lat * dr) +
-                cos(from.lat * dr) * cos(to.lat * dr) *
-                cos(abs(from.lng - to.lng) * dr)) *
-           earth_radius;
+
+    return ArcLength(from, to,
+                     sin(from.lat * dr) * sin(to.lat * dr) +
+                         cos(from.lat * dr) * cos(to.lat * dr) *
+                             cos(abs(from.lng - to.lng) * dr));
+}
+
+LatitudeTrig ComputeLatitudeTrig(double lat)
+{
+    const double dr = M_PI / 180.0;
+    return {std::sin(lat * dr), std::cos(lat * dr)};
+}
+
+double ComputeDistance(Coordinates from, LatitudeTrig from_trig,
+                       Coordinates to, LatitudeTrig to_trig)
+{
+    using namespace std;
+    const double dr = M_PI / 180.0;
+
+    // Порядок операций как в ComputeDistance(from, to)
+    return ArcLength(from, to,
+                     from_trig.sin * to_trig.sin +
+                         from_trig.cos * to_trig.cos *
+                             cos(abs(from.lng - to.lng) * dr));
+}
+
+void ComputeApproxDistances(Coordinates center,
+                            std::span<const Coordinates> points,
+                            std::span<double> distances)
+{
+    assert(points.size() == distances.size());
+    const double dr = M_PI / 180.0;
+    const double lng_scale = std::cos(center.lat * dr);
+    size_t i = 0;
+#ifdef __SSE2__
+    // Coordinates - пара double, поэтому две точки - это два вектора
+    // (lat, lng); перестановкой получаем вектор широт и вектор долгот
+    const __m128d center_lat = _mm_set1_pd(center.lat);
+    const __m128d center_lng = _mm_set1_pd(center.lng);
+    const __m128d scale = _mm_set1_pd(lng_scale);
+    const __m128d factor = _mm_set1_pd(dr * EARTH_RADIUS);
+    for (; i + 2 <= points.size(); i += 2) {
+        const __m128d first = _mm_loadu_pd(&points[i].lat);
+        const __m128d second = _mm_loadu_pd(&points[i + 1].lat);
+        const __m128d lat = _mm_unpacklo_pd(first, second);
+        const __m128d lng = _mm_unpackhi_pd(first, second);
+        const __m128d dlat = _mm_sub_pd(lat, center_lat);
+        const __m128d dlng = _mm_mul_pd(_mm_sub_pd(lng, center_lng), scale);
+        const __m128d length = _mm_sqrt_pd(
+            _mm_add_pd(_mm_mul_pd(dlat, dlat), _mm_mul_pd(dlng, dlng)));
+        _mm_storeu_pd(&distances[i], _mm_mul_pd(length, factor));
+    }
+#endif
+    for (; i < points.size(); ++i) {
+        const double dlat = points[i].lat - center.lat;
+        const double dlng = (points[i].lng - center.lng) * lng_scale;
+        distances[i] =
+            std::sqrt(dlat * dlat + dlng * dlng) * (dr * EARTH_RADIUS);
+    }
 }
 
 } // namespace geo
\ No newline at end of file
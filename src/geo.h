@@ -2,8 +2,12 @@
 
 #pragma once
 
+#include <span>
+
 namespace geo {
 
+inline constexpr double EARTH_RADIUS = 6371000; // Метры
+
 struct Coordinates {
     double lat; // Широта
     double lng; // Долгота
@@ -12,6 +16,38 @@ struct Coordinates {
 bool operator==(const Coordinates& lhs, const Coordinates& rhs);
 bool operator!=(const Coordinates& lhs, const Coordinates& rhs);
 
+// Расстояние по дуге большого круга в метрах; всегда конечно, для
+// совпадающих точек - ровно 0
 double ComputeDistance(Coordinates from, Coordinates to);
 
+// Синус и косинус широты точки, вычисленные один раз для многих расчетов
+struct LatitudeTrig {
+    double sin = 0;
+    double cos = 1;
+};
+
+LatitudeTrig ComputeLatitudeTrig(double lat);
+
+// То же, что ComputeDistance, но без пересчета тригонометрии широт.
+// Результат совпадает с ComputeDistance побитово.
+double ComputeDistance(Coordinates from, LatitudeTrig from_trig,
+                       Coordinates to, LatitudeTrig to_trig);
+
+// Приближенные расстояния от center до points по равнопромежуточной
+// проекции с масштабом долготы на широте center. Только арифметика,
+// по две точки за шаг SSE2. Годится для отбора кандидатов перед точным
+// расчетом: если center и points не дальше APPROX_MAX_LATITUDE от
+// экватора, а точное расстояние exact не больше APPROX_MAX_DISTANCE, то
+// |approx - exact| <= APPROX_RELATIVE_ERROR * exact + APPROX_ABSOLUTE_ERROR.
+// Вблизи полюсов и меридиана 180° ошибка не ограничена.
+void ComputeApproxDistances(Coordinates center,
+                            std::span<const Coordinates> points,
+                            std::span<double> distances);
+
+inline constexpr double APPROX_MAX_LATITUDE = 70;    // Градусы
+inline constexpr double APPROX_MAX_DISTANCE = 100000; // Метры
+inline constexpr double APPROX_RELATIVE_ERROR = 0.01;
+// Погрешность самого ComputeDistance на расстояниях до метров
+inline constexpr double APPROX_ABSOLUTE_ERROR = 0.2; // Метры
+
 } // namespace geo
\ No newline at end of file
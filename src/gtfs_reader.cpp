@@ -0,0 +1,872 @@
+// gtfs_reader.cpp
+
+#include "gtfs_reader.h"
+
+#include "geo.h"
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace gtfs_reader {
+
+namespace {
+
+using namespace std::literals;
+
+constexpr size_t NO_COLUMN = std::numeric_limits<size_t>::max();
+constexpr uint32_t NO_SHAPE = std::numeric_limits<uint32_t>::max();
+constexpr size_t NO_PATTERN = std::numeric_limits<size_t>::max();
+
+// Меньшие части файла не делятся между потоками
+constexpr size_t MIN_CHUNK_SIZE = 1 << 16;
+
+// Остановка считается лежащей на отрезке линии, если она ближе этого
+// расстояния, в метрах
+constexpr double SHAPE_TOLERANCE = 25.0;
+
+// Разобранные поля в кавычках с удвоенными кавычками внутри. Хранилище
+// своё у каждой части файла, чтобы части разбирались независимо.
+using StringStorage = std::deque<std::deque<std::string>>;
+
+// Чтение строк CSV по RFC 4180. Поля без экранирования ссылаются на text.
+class CsvReader {
+public:
+    CsvReader(std::string_view text, std::deque<std::string>& strings)
+        : text_(text)
+        , strings_(strings)
+    {
+    }
+
+    // Возвращает false, когда строки закончились
+    bool ReadRow(std::vector<std::string_view>& fields)
+    {
+        fields.clear();
+        if (pos_ >= text_.size()) {
+            return false;
+        }
+        while (true) {
+            fields.push_back(ReadField());
+            if (pos_ >= text_.size()) {
+                return true;
+            }
+            const char separator = text_[pos_++];
+            if (separator == ',') {
+                continue;
+            }
+            if (separator == '\r' && pos_ < text_.size() &&
+                text_[pos_] == '\n') {
+                ++pos_;
+            }
+            return true;
+        }
+    }
+
+    size_t GetPosition() const
+    {
+        return pos_;
+    }
+
+private:
+    std::string_view text_;
+    std::deque<std::string>& strings_;
+    size_t pos_ = 0;
+
+    std::string_view ReadField()
+    {
+        if (pos_ >= text_.size() || text_[pos_] != '"') {
+            size_t end = text_.find_first_of(",\r\n", pos_);
+            if (end == std::string_view::npos) {
+                end = text_.size();
+            }
+            const std::string_view field = text_.substr(pos_, end - pos_);
+            pos_ = end;
+            return field;
+        }
+
+        const size_t begin = ++pos_;
+        std::string* unescaped = nullptr;
+        while (true) {
+            const size_t quote = text_.find('"', pos_);
+            if (quote == std::string_view::npos) {
+                throw std::runtime_error("unterminated quoted field");
+            }
+            if (quote + 1 < text_.size() && text_[quote + 1] == '"') {
+                if (unescaped == nullptr) {
+                    unescaped = &strings_.emplace_back();
+                }
+                unescaped->append(text_.substr(pos_, quote + 1 - pos_));
+                pos_ = quote + 2;
+                continue;
+            }
+            std::string_view field = text_.substr(begin, quote - begin);
+            if (unescaped != nullptr) {
+                unescaped->append(text_.substr(pos_, quote - pos_));
+                field = *unescaped;
+            }
+            pos_ = quote + 1;
+            if (pos_ < text_.size() && text_[pos_] != ',' &&
+                text_[pos_] != '\r' && text_[pos_] != '\n') {
+                throw std::runtime_error("text after closing quote");
+            }
+            return field;
+        }
+    }
+};
+
+std::string_view Trim(std::string_view text)
+{
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+template <typename Number>
+Number ParseNumber(std::string_view field)
+{
+    field = Trim(field);
+    Number value{};
+    const char* const end = field.data() + field.size();
+    const auto [ptr, error] = std::from_chars(field.data(), end, value);
+    if (error != std::errc{} || ptr != end) {
+        throw std::runtime_error("invalid number \""s + std::string(field) +
+                                 "\""s);
+    }
+    return value;
+}
+
+// Столбцы таблицы по заголовку
+class Columns {
+public:
+    explicit Columns(const std::vector<std::string_view>& names)
+    {
+        names_.reserve(names.size());
+        for (const std::string_view name : names) {
+            names_.push_back(Trim(name));
+        }
+    }
+
+    // NO_COLUMN, если столбца нет
+    size_t Find(std::string_view name) const
+    {
+        const auto it = std::find(names_.begin(), names_.end(), name);
+        return it == names_.end()
+                   ? NO_COLUMN
+                   : static_cast<size_t>(it - names_.begin());
+    }
+
+    size_t At(std::string_view name) const
+    {
+        const size_t column = Find(name);
+        if (column == NO_COLUMN) {
+            throw std::runtime_error("missing column "s + std::string(name));
+        }
+        return column;
+    }
+
+private:
+    std::vector<std::string_view> names_;
+};
+
+// Пустое поле, если столбца нет или строка короче заголовка
+std::string_view GetField(const std::vector<std::string_view>& fields,
+                          size_t column)
+{
+    return column < fields.size() ? fields[column] : std::string_view{};
+}
+
+// Делит текст на части примерно по size байт. Части кончаются переводом
+// строки вне кавычек: кавычки от начала части до границы должны быть
+// парными.
+std::vector<std::string_view> SplitChunks(std::string_view text, size_t size)
+{
+    std::vector<std::string_view> chunks;
+    size_t begin = 0;
+    while (begin < text.size()) {
+        size_t end = begin + size;
+        size_t counted = begin;
+        bool inside_quotes = false;
+        while (end < text.size()) {
+            end = text.find('\n', end);
+            if (end == std::string_view::npos) {
+                break;
+            }
+            ++end;
+            inside_quotes ^= std::count(text.begin() + counted,
+                                        text.begin() + end, '"') % 2 == 1;
+            counted = end;
+            if (!inside_quotes) {
+                break;
+            }
+        }
+        end = std::min(end, text.size());
+        chunks.push_back(text.substr(begin, end - begin));
+        begin = end;
+    }
+    return chunks;
+}
+
+// Разбирает таблицу file параллельно по частям. make_parser по столбцам
+// заголовка строит функцию bool(const vector<string_view>& fields,
+// Row& row), которая заполняет row и возвращает false для пропускаемых
+// строк. Строки возвращаются в порядке файла.
+template <typename Row, typename MakeParser>
+std::vector<Row> ReadTable(const mapped_file::MappedFile& file,
+                           std::string_view file_name,
+                           StringStorage& strings,
+                           const MakeParser& make_parser)
+{
+    std::string_view text = file.GetText();
+    if (text.starts_with("\xEF\xBB\xBF"sv)) {
+        text.remove_prefix(3);
+    }
+
+    try {
+        std::vector<std::string_view> header;
+        CsvReader header_reader(text, strings.emplace_back());
+        if (!header_reader.ReadRow(header)) {
+            return {};
+        }
+        const auto parse_row = make_parser(Columns(header));
+        text.remove_prefix(header_reader.GetPosition());
+
+        const size_t threads =
+            std::max<size_t>(1, std::thread::hardware_concurrency());
+        const size_t chunk_size =
+            std::max(MIN_CHUNK_SIZE, text.size() / threads + 1);
+        std::vector<std::future<std::vector<Row>>> parts;
+        for (const std::string_view chunk : SplitChunks(text, chunk_size)) {
+            std::deque<std::string>& chunk_strings = strings.emplace_back();
+            parts.push_back(std::async(std::launch::async, [&, chunk] {
+                CsvReader reader(chunk, chunk_strings);
+                std::vector<Row> rows;
+                std::vector<std::string_view> fields;
+                while (reader.ReadRow(fields)) {
+                    // Пустые строки пропускаются
+                    if (fields.size() == 1 && fields[0].empty()) {
+                        continue;
+                    }
+                    Row row;
+                    if (parse_row(fields, row)) {
+                        rows.push_back(std::move(row));
+                    }
+                }
+                return rows;
+            }));
+        }
+
+        std::vector<std::vector<Row>> results;
+        results.reserve(parts.size());
+        size_t total = 0;
+        for (auto& part : parts) {
+            total += results.emplace_back(part.get()).size();
+        }
+        std::vector<Row> rows;
+        rows.reserve(total);
+        for (auto& result : results) {
+            std::move(result.begin(), result.end(), std::back_inserter(rows));
+        }
+        return rows;
+    } catch (const std::runtime_error& error) {
+        throw std::runtime_error(std::string(file_name) + ": "s +
+                                 error.what());
+    }
+}
+
+// Раскладывает строки по группам row.group < group_count с сохранением
+// порядка файла и упорядочивает каждую группу по row.sequence.
+// Возвращает границы групп: group_count + 1 смещений.
+template <typename Row>
+std::vector<size_t> GroupRows(std::vector<Row>& rows, size_t group_count)
+{
+    std::vector<size_t> offsets(group_count + 1, 0);
+    for (const Row& row : rows) {
+        ++offsets[row.group + 1];
+    }
+    for (size_t group = 0; group < group_count; ++group) {
+        offsets[group + 1] += offsets[group];
+    }
+    std::vector<Row> grouped(rows.size());
+    std::vector<size_t> positions(offsets.begin(), offsets.end() - 1);
+    for (Row& row : rows) {
+        grouped[positions[row.group]++] = std::move(row);
+    }
+    rows = std::move(grouped);
+
+    const auto by_sequence = [](const Row& lhs, const Row& rhs) {
+        return lhs.sequence < rhs.sequence;
+    };
+    for (size_t group = 0; group < group_count; ++group) {
+        const auto begin = rows.begin() + offsets[group];
+        const auto end = rows.begin() + offsets[group + 1];
+        if (!std::is_sorted(begin, end, by_sequence)) {
+            std::stable_sort(begin, end, by_sequence);
+        }
+    }
+    return offsets;
+}
+
+struct StopRow {
+    std::string_view id;
+    std::string_view name;
+    geo::Coordinates coordinates;
+};
+
+struct RouteRow {
+    std::string_view id;
+    std::string_view name;
+};
+
+struct TripRow {
+    std::string_view id;
+    std::string_view route_id;
+    std::string_view shape_id;
+};
+
+struct StopTimeRow {
+    uint32_t group; // Рейс
+    uint32_t sequence;
+    uint32_t stop;
+};
+
+struct ShapePointRow {
+    std::string_view shape_id;
+    uint32_t group; // Линия, заполняется после разбора
+    uint32_t sequence;
+    geo::Coordinates coordinates;
+};
+
+// Различная последовательность остановок рейсов одного маршрута GTFS
+struct Pattern {
+    uint32_t route;
+    std::vector<uint32_t> stops;
+    uint32_t shape = NO_SHAPE;
+    size_t trip_count = 0;
+};
+
+// Маршрут каталога: вариант маршрута GTFS и, для маршрута туда и
+// обратно, вариант обратного направления
+struct OutputRoute {
+    std::string_view name;
+    size_t forward;
+    size_t backward = NO_PATTERN;
+};
+
+template <typename Row>
+std::unordered_map<std::string_view, uint32_t> IndexIds(
+    const std::vector<Row>& rows, std::string_view what)
+{
+    std::unordered_map<std::string_view, uint32_t> index;
+    index.reserve(rows.size());
+    for (size_t i = 0; i < rows.size(); ++i) {
+        if (!index.emplace(rows[i].id, static_cast<uint32_t>(i)).second) {
+            throw std::runtime_error(std::string(what) + ": duplicate id "s +
+                                     std::string(rows[i].id));
+        }
+    }
+    return index;
+}
+
+std::vector<StopRow> ReadStops(const mapped_file::MappedFile& file,
+                               StringStorage& strings)
+{
+    return ReadTable<StopRow>(
+        file, "stops.txt", strings, [](const Columns& columns) {
+            const size_t id = columns.At("stop_id");
+            const size_t name = columns.At("stop_name");
+            const size_t lat = columns.At("stop_lat");
+            const size_t lon = columns.At("stop_lon");
+            const size_t location_type = columns.Find("location_type");
+            return [=](const std::vector<std::string_view>& fields,
+                       StopRow& row) {
+                // Станции, входы и узлы не являются остановками
+                const std::string_view type =
+                    Trim(GetField(fields, location_type));
+                if (!type.empty() && type != "0"sv) {
+                    return false;
+                }
+                row.id = GetField(fields, id);
+                row.name = GetField(fields, name);
+                row.coordinates = {
+                    ParseNumber<double>(GetField(fields, lat)),
+                    ParseNumber<double>(GetField(fields, lon))};
+                return true;
+            };
+        });
+}
+
+std::vector<RouteRow> ReadRoutes(const mapped_file::MappedFile& file,
+                                 StringStorage& strings)
+{
+    return ReadTable<RouteRow>(
+        file, "routes.txt", strings, [](const Columns& columns) {
+            const size_t id = columns.At("route_id");
+            const size_t short_name = columns.Find("route_short_name");
+            const size_t long_name = columns.Find("route_long_name");
+            return [=](const std::vector<std::string_view>& fields,
+                       RouteRow& row) {
+                row.id = GetField(fields, id);
+                row.name = GetField(fields, short_name);
+                if (row.name.empty()) {
+                    row.name = GetField(fields, long_name);
+                }
+                if (row.name.empty()) {
+                    row.name = row.id;
+                }
+                return true;
+            };
+        });
+}
+
+std::vector<TripRow> ReadTrips(const mapped_file::MappedFile& file,
+                               StringStorage& strings)
+{
+    return ReadTable<TripRow>(
+        file, "trips.txt", strings, [](const Columns& columns) {
+            const size_t id = columns.At("trip_id");
+            const size_t route_id = columns.At("route_id");
+            const size_t shape_id = columns.Find("shape_id");
+            return [=](const std::vector<std::string_view>& fields,
+                       TripRow& row) {
+                row.id = GetField(fields, id);
+                row.route_id = GetField(fields, route_id);
+                row.shape_id = GetField(fields, shape_id);
+                return true;
+            };
+        });
+}
+
+std::vector<StopTimeRow> ReadStopTimes(
+    const mapped_file::MappedFile& file, StringStorage& strings,
+    const std::unordered_map<std::string_view, uint32_t>& trip_index,
+    const std::unordered_map<std::string_view, uint32_t>& stop_index)
+{
+    return ReadTable<StopTimeRow>(
+        file, "stop_times.txt", strings, [&](const Columns& columns) {
+            const size_t trip_id = columns.At("trip_id");
+            const size_t stop_id = columns.At("stop_id");
+            const size_t sequence = columns.At("stop_sequence");
+            return [=, &trip_index, &stop_index](
+                       const std::vector<std::string_view>& fields,
+                       StopTimeRow& row) {
+                const auto trip = trip_index.find(GetField(fields, trip_id));
+                if (trip == trip_index.end()) {
+                    throw std::runtime_error(
+                        "unknown trip_id "s +
+                        std::string(GetField(fields, trip_id)));
+                }
+                const auto stop = stop_index.find(GetField(fields, stop_id));
+                if (stop == stop_index.end()) {
+                    throw std::runtime_error(
+                        "unknown stop_id "s +
+                        std::string(GetField(fields, stop_id)));
+                }
+                row.group = trip->second;
+                row.sequence =
+                    ParseNumber<uint32_t>(GetField(fields, sequence));
+                row.stop = stop->second;
+                return true;
+            };
+        });
+}
+
+std::vector<ShapePointRow> ReadShapes(const mapped_file::MappedFile& file,
+                                      StringStorage& strings)
+{
+    return ReadTable<ShapePointRow>(
+        file, "shapes.txt", strings, [](const Columns& columns) {
+            const size_t id = columns.At("shape_id");
+            const size_t lat = columns.At("shape_pt_lat");
+            const size_t lon = columns.At("shape_pt_lon");
+            const size_t sequence = columns.At("shape_pt_sequence");
+            return [=](const std::vector<std::string_view>& fields,
+                       ShapePointRow& row) {
+                row.shape_id = GetField(fields, id);
+                row.sequence =
+                    ParseNumber<uint32_t>(GetField(fields, sequence));
+                row.coordinates = {
+                    ParseNumber<double>(GetField(fields, lat)),
+                    ParseNumber<double>(GetField(fields, lon))};
+                return true;
+            };
+        });
+}
+
+// Различные последовательности остановок рейсов по маршрутам. Повтор
+// остановки подряд сворачивается; рейсы меньше чем с двумя остановками
+// пропускаются. Линия варианта - линия первого рейса, у которого она
+// задана.
+std::vector<Pattern> CollectPatterns(
+    const std::vector<StopTimeRow>& stop_times,
+    const std::vector<size_t>& offsets,
+    const std::vector<uint32_t>& trip_routes,
+    const std::vector<uint32_t>& trip_shapes)
+{
+    std::vector<Pattern> trips;
+    trips.reserve(trip_routes.size());
+    for (size_t trip = 0; trip < trip_routes.size(); ++trip) {
+        Pattern pattern{trip_routes[trip], {}, trip_shapes[trip], 1};
+        for (size_t i = offsets[trip]; i < offsets[trip + 1]; ++i) {
+            if (pattern.stops.empty() ||
+                pattern.stops.back() != stop_times[i].stop) {
+                pattern.stops.push_back(stop_times[i].stop);
+            }
+        }
+        if (pattern.stops.size() >= 2) {
+            trips.push_back(std::move(pattern));
+        }
+    }
+
+    std::stable_sort(trips.begin(), trips.end(),
+                     [](const Pattern& lhs, const Pattern& rhs) {
+                         return std::tie(lhs.route, lhs.stops) <
+                                std::tie(rhs.route, rhs.stops);
+                     });
+    std::vector<Pattern> patterns;
+    for (Pattern& trip : trips) {
+        if (!patterns.empty() && patterns.back().route == trip.route &&
+            patterns.back().stops == trip.stops) {
+            Pattern& pattern = patterns.back();
+            ++pattern.trip_count;
+            if (pattern.shape == NO_SHAPE) {
+                pattern.shape = trip.shape;
+            }
+        } else {
+            patterns.push_back(std::move(trip));
+        }
+    }
+
+    // Внутри маршрута сначала самые частые варианты
+    std::sort(patterns.begin(), patterns.end(),
+              [](const Pattern& lhs, const Pattern& rhs) {
+                  if (lhs.route != rhs.route) {
+                      return lhs.route < rhs.route;
+                  }
+                  if (lhs.trip_count != rhs.trip_count) {
+                      return lhs.trip_count > rhs.trip_count;
+                  }
+                  return lhs.stops < rhs.stops;
+              });
+    return patterns;
+}
+
+// Объединяет вариант с обратным ему в маршрут туда и обратно и дает
+// маршрутам уникальные названия
+std::vector<OutputRoute> MakeRoutes(
+    const std::vector<Pattern>& patterns,
+    const std::vector<std::string_view>& route_names,
+    std::deque<std::string>& names)
+{
+    std::vector<OutputRoute> routes;
+    std::unordered_set<std::string_view> used_names;
+    std::vector<bool> merged(patterns.size(), false);
+    size_t begin = 0;
+    while (begin < patterns.size()) {
+        const uint32_t route = patterns[begin].route;
+        size_t end = begin;
+        std::map<std::vector<uint32_t>, size_t> by_stops;
+        while (end < patterns.size() && patterns[end].route == route) {
+            by_stops.emplace(patterns[end].stops, end);
+            ++end;
+        }
+
+        size_t number = 1;
+        for (size_t i = begin; i < end; ++i) {
+            if (merged[i]) {
+                continue;
+            }
+            OutputRoute& output = routes.emplace_back();
+            output.forward = i;
+            const std::vector<uint32_t> reversed(patterns[i].stops.rbegin(),
+                                                 patterns[i].stops.rend());
+            const auto it = by_stops.find(reversed);
+            if (it != by_stops.end() && it->second != i &&
+                !merged[it->second]) {
+                output.backward = it->second;
+                merged[it->second] = true;
+            }
+
+            // Первый вариант называется как маршрут, следующие - с номером
+            const auto make_name = [&](size_t n) -> std::string_view {
+                const std::string_view base = route_names[route];
+                return n == 1 ? base
+                              : names.emplace_back(std::string(base) + " ("s +
+                                                   std::to_string(n) + ")"s);
+            };
+            std::string_view name = make_name(number++);
+            while (used_names.count(name) > 0) {
+                name = make_name(number++);
+            }
+            used_names.insert(name);
+            output.name = name;
+        }
+        begin = end;
+    }
+    return routes;
+}
+
+// Положение точки относительно center в метрах в локальной плоской
+// системе координат
+struct LocalPoint {
+    double x;
+    double y;
+};
+
+LocalPoint ToLocal(geo::Coordinates point, geo::Coordinates center)
+{
+    static constexpr double METERS_PER_DEGREE = 6371000.0 * M_PI / 180.0;
+    const double scale = std::cos(center.lat * M_PI / 180.0);
+    return {(point.lng - center.lng) * scale * METERS_PER_DEGREE,
+            (point.lat - center.lat) * METERS_PER_DEGREE};
+}
+
+// Длины перегонов варианта по линии: остановки проецируются на отрезки
+// линии по порядку, не возвращаясь назад. Остановка ложится на первый
+// отрезок в пределах SHAPE_TOLERANCE или, если такого нет, на
+// ближайший. Перегон не короче расстояния по прямой.
+std::vector<size_t> ComputeLengths(
+    const std::vector<geo::Coordinates>& stops,
+    const std::vector<geo::Coordinates>& line)
+{
+    std::vector<double> cumulative(line.size(), 0.0);
+    for (size_t i = 1; i < line.size(); ++i) {
+        cumulative[i] =
+            cumulative[i - 1] + geo::ComputeDistance(line[i - 1], line[i]);
+    }
+
+    std::vector<double> positions;
+    positions.reserve(stops.size());
+    size_t segment = 0;
+    for (const geo::Coordinates stop : stops) {
+        double best_distance = std::numeric_limits<double>::infinity();
+        size_t best_segment = segment;
+        double best_fraction = 0.0;
+        for (size_t i = segment; i + 1 < line.size(); ++i) {
+            const LocalPoint a = ToLocal(line[i], stop);
+            const LocalPoint b = ToLocal(line[i + 1], stop);
+            const double dx = b.x - a.x;
+            const double dy = b.y - a.y;
+            const double length = dx * dx + dy * dy;
+            const double fraction =
+                length > 0.0
+                    ? std::clamp(-(a.x * dx + a.y * dy) / length, 0.0, 1.0)
+                    : 0.0;
+            const double x = a.x + fraction * dx;
+            const double y = a.y + fraction * dy;
+            const double distance = std::sqrt(x * x + y * y);
+            if (distance < best_distance) {
+                best_distance = distance;
+                best_segment = i;
+                best_fraction = fraction;
+            }
+            if (distance <= SHAPE_TOLERANCE) {
+                break;
+            }
+        }
+        segment = best_segment;
+        double position = line.size() < 2
+                              ? 0.0
+                              : cumulative[segment] +
+                                    best_fraction * (cumulative[segment + 1] -
+                                                     cumulative[segment]);
+        if (!positions.empty()) {
+            position = std::max(position, positions.back());
+        }
+        positions.push_back(position);
+    }
+
+    std::vector<size_t> lengths;
+    lengths.reserve(stops.size() - 1);
+    for (size_t i = 0; i + 1 < stops.size(); ++i) {
+        const double straight = geo::ComputeDistance(stops[i], stops[i + 1]);
+        lengths.push_back(static_cast<size_t>(
+            std::llround(std::max(positions[i + 1] - positions[i], straight))));
+    }
+    return lengths;
+}
+
+} // namespace
+
+transport_catalogue::TransportCatalogue ReadGtfs(
+    const std::filesystem::path& directory)
+{
+    // Файлы и разобранные строки нужны, пока пакет не применен к каталогу
+    StringStorage strings;
+    const mapped_file::MappedFile stops_file(directory / "stops.txt");
+    const mapped_file::MappedFile trips_file(directory / "trips.txt");
+    const mapped_file::MappedFile stop_times_file(directory /
+                                                  "stop_times.txt");
+    std::optional<mapped_file::MappedFile> routes_file;
+    if (std::filesystem::exists(directory / "routes.txt")) {
+        routes_file.emplace(directory / "routes.txt");
+    }
+    std::optional<mapped_file::MappedFile> shapes_file;
+    if (std::filesystem::exists(directory / "shapes.txt")) {
+        shapes_file.emplace(directory / "shapes.txt");
+    }
+
+    const std::vector<StopRow> stops = ReadStops(stops_file, strings);
+    const auto stop_index = IndexIds(stops, "stops.txt");
+
+    std::vector<RouteRow> routes;
+    if (routes_file) {
+        routes = ReadRoutes(*routes_file, strings);
+    }
+    auto route_index = IndexIds(routes, "routes.txt");
+
+    std::vector<ShapePointRow> shape_points;
+    if (shapes_file) {
+        shape_points = ReadShapes(*shapes_file, strings);
+    }
+    std::unordered_map<std::string_view, uint32_t> shape_index;
+    for (ShapePointRow& point : shape_points) {
+        point.group = shape_index
+                          .emplace(point.shape_id,
+                                   static_cast<uint32_t>(shape_index.size()))
+                          .first->second;
+    }
+    const std::vector<size_t> shape_offsets =
+        GroupRows(shape_points, shape_index.size());
+
+    // Маршрут без описания в routes.txt называется по route_id
+    const std::vector<TripRow> trips = ReadTrips(trips_file, strings);
+    const auto trip_index = IndexIds(trips, "trips.txt");
+    std::vector<uint32_t> trip_routes;
+    std::vector<uint32_t> trip_shapes;
+    trip_routes.reserve(trips.size());
+    trip_shapes.reserve(trips.size());
+    for (const TripRow& trip : trips) {
+        const auto [route, added] = route_index.emplace(
+            trip.route_id, static_cast<uint32_t>(routes.size()));
+        if (added) {
+            routes.push_back({trip.route_id, trip.route_id});
+        }
+        trip_routes.push_back(route->second);
+        const auto shape = shape_index.find(trip.shape_id);
+        trip_shapes.push_back(shape == shape_index.end() ? NO_SHAPE
+                                                         : shape->second);
+    }
+
+    std::vector<StopTimeRow> stop_times =
+        ReadStopTimes(stop_times_file, strings, trip_index, stop_index);
+    const std::vector<size_t> trip_offsets =
+        GroupRows(stop_times, trips.size());
+
+    std::vector<std::string_view> route_names;
+    route_names.reserve(routes.size());
+    for (const RouteRow& route : routes) {
+        route_names.push_back(route.name);
+    }
+    const std::vector<Pattern> patterns =
+        CollectPatterns(stop_times, trip_offsets, trip_routes, trip_shapes);
+    stop_times = {};
+    std::deque<std::string>& names = strings.emplace_back();
+    const std::vector<OutputRoute> output_routes =
+        MakeRoutes(patterns, route_names, names);
+
+    // Одноименные остановки различаются по stop_id
+    std::unordered_map<std::string_view, size_t> name_counts;
+    for (const StopRow& stop : stops) {
+        ++name_counts[stop.name];
+    }
+    std::vector<std::string_view> stop_names;
+    stop_names.reserve(stops.size());
+    for (const StopRow& stop : stops) {
+        stop_names.push_back(
+            name_counts[stop.name] == 1
+                ? stop.name
+                : names.emplace_back(std::string(stop.name) + " ("s +
+                                     std::string(stop.id) + ")"s));
+    }
+
+    // Длины перегонов вариантов считаются параллельно
+    std::vector<std::vector<size_t>> lengths(patterns.size());
+    const size_t threads =
+        std::max<size_t>(1, std::thread::hardware_concurrency());
+    const size_t chunk = (patterns.size() + threads - 1) / threads;
+    std::vector<std::future<void>> parts;
+    for (size_t begin = 0; begin < patterns.size(); begin += chunk) {
+        const size_t end = std::min(patterns.size(), begin + chunk);
+        parts.push_back(std::async(std::launch::async, [&, begin, end] {
+            std::vector<geo::Coordinates> points;
+            std::vector<geo::Coordinates> line;
+            for (size_t i = begin; i < end; ++i) {
+                const Pattern& pattern = patterns[i];
+                points.clear();
+                for (const uint32_t stop : pattern.stops) {
+                    points.push_back(stops[stop].coordinates);
+                }
+                line.clear();
+                if (pattern.shape != NO_SHAPE) {
+                    for (size_t j = shape_offsets[pattern.shape];
+                         j < shape_offsets[pattern.shape + 1]; ++j) {
+                        line.push_back(shape_points[j].coordinates);
+                    }
+                }
+                lengths[i] = ComputeLengths(points, line);
+            }
+        }));
+    }
+    for (auto& part : parts) {
+        part.get();
+    }
+
+    transport_catalogue::DeltaBatch batch;
+    batch.stops.reserve(stops.size());
+    for (size_t i = 0; i < stops.size(); ++i) {
+        batch.stops.push_back({stop_names[i], stops[i].coordinates, {}});
+    }
+    // Для пары остановок берется длина из первого варианта, где она есть
+    std::unordered_set<uint64_t> known_pairs;
+    const auto add_lengths = [&](size_t pattern) {
+        const std::vector<uint32_t>& pattern_stops = patterns[pattern].stops;
+        for (size_t i = 0; i + 1 < pattern_stops.size(); ++i) {
+            const uint32_t from = pattern_stops[i];
+            const uint32_t to = pattern_stops[i + 1];
+            if (known_pairs.insert(uint64_t{from} << 32 | to).second) {
+                batch.distances.push_back(
+                    {stop_names[from], stop_names[to], lengths[pattern][i]});
+            }
+        }
+    };
+    batch.routes.reserve(output_routes.size());
+    for (const OutputRoute& route : output_routes) {
+        transport_catalogue::RouteData& data = batch.routes.emplace_back();
+        data.name = route.name;
+        data.is_roundtrip = route.backward == NO_PATTERN;
+        for (const uint32_t stop : patterns[route.forward].stops) {
+            data.stops.push_back(stop_names[stop]);
+        }
+        add_lengths(route.forward);
+        if (route.backward != NO_PATTERN) {
+            add_lengths(route.backward);
+        }
+    }
+
+    transport_catalogue::TransportCatalogue catalogue;
+    catalogue.ApplyDelta(batch);
+    return catalogue;
+}
+
+} // namespace gtfs_reader
\ No newline at end of file
@@ -0,0 +1,32 @@
+// gtfs_reader.h
+
+#pragma once
+
+#include "transport_catalogue.h"
+
+#include <filesystem>
+
+namespace gtfs_reader {
+
+// Строит каталог по расписанию в формате GTFS из каталога directory.
+//
+// Остановки берутся из stops.txt (кроме станций, входов и других
+// объектов с location_type больше 0); одноименным остановкам к названию
+// добавляется stop_id в скобках. Маршрутами становятся различные
+// последовательности остановок рейсов (trips.txt и stop_times.txt)
+// каждого маршрута GTFS. Последовательность, обратная уже найденной,
+// объединяется с ней в маршрут туда и обратно, остальные загружаются
+// как кольцевые. Название маршрута - route_short_name из routes.txt,
+// затем route_long_name или route_id; второй и следующие варианты
+// маршрута получают номер в скобках.
+//
+// Дорожные расстояния между соседними остановками вычисляются вдоль
+// линии из shapes.txt, если она задана для рейса, иначе берется
+// расстояние по прямой.
+//
+// Файлы отображаются в память и разбираются параллельно по частям,
+// без промежуточного дерева документа. Ошибки формата - runtime_error.
+transport_catalogue::TransportCatalogue ReadGtfs(
+    const std::filesystem::path& directory);
+
+} // namespace gtfs_reader
\ No newline at end of file
@@ -2,227 +2,712 @@
 
 #include "json.h"
 
-#include <iterator>
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#endif
 
 namespace json {
 
 namespace {
 using namespace std::literals;
 
-Node LoadNode(std::istream& input);
-Node LoadString(std::istream& input);
-
-std::string LoadLiteral(std::istream& input)
+bool IsSpace(char c)
 {
-    std::string s;
-    while (std::isalpha(input.peek())) {
-        s.push_back(static_cast<char>(input.get()));
-    }
-    return s;
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' ||
+           c == '\f';
 }
 
-Node LoadArray(std::istream& input)
+bool IsDigit(char c)
 {
-    std::vector<Node> result;
+    return c >= '0' && c <= '9';
+}
+
+// Признаки символов блока из 64 байт, бит i - байт i
+struct BlockMasks {
+    uint64_t quotes = 0;
+    uint64_t backslashes = 0;
+    uint64_t spaces = 0;
+    uint64_t structurals = 0;
+    uint64_t line_ends = 0;
+    uint64_t non_ascii = 0;
+    // Байты продолжения UTF-8 (0x80-0xBF) и первые байты двухбайтовых
+    // символов (0xC2-0xDF)
+    uint64_t continuations = 0;
+    uint64_t leads2 = 0;
+};
 
-    for (char c; input >> c && c != ']';) {
-        if (c != ',') {
-            input.putback(c);
+constexpr size_t BLOCK_SIZE = 64;
+
+using ClassifyBlock = void (*)(const char* block, BlockMasks& masks);
+
+[[maybe_unused]] void ClassifyBlockScalar(const char* block, BlockMasks& masks)
+{
+    masks = {};
+    for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+        const uint64_t bit = uint64_t{1} << i;
+        switch (block[i]) {
+        case '"':
+            masks.quotes |= bit;
+            break;
+        case '\\':
+            masks.backslashes |= bit;
+            break;
+        case '\n':
+            [[fallthrough]];
+        case '\r':
+            masks.line_ends |= bit;
+            [[fallthrough]];
+        case ' ':
+            [[fallthrough]];
+        case '\t':
+            [[fallthrough]];
+        case '\v':
+            [[fallthrough]];
+        case '\f':
+            masks.spaces |= bit;
+            break;
+        case '{':
+            [[fallthrough]];
+        case '}':
+            [[fallthrough]];
+        case '[':
+            [[fallthrough]];
+        case ']':
+            [[fallthrough]];
+        case ':':
+            [[fallthrough]];
+        case ',':
+            masks.structurals |= bit;
+            break;
+        default: {
+            const auto byte = static_cast<unsigned char>(block[i]);
+            if (byte >= 0x80) {
+                masks.non_ascii |= bit;
+            }
+            if (byte >= 0x80 && byte <= 0xBF) {
+                masks.continuations |= bit;
+            } else if (byte >= 0xC2 && byte <= 0xDF) {
+                masks.leads2 |= bit;
+            }
+            break;
+        }
         }
-        result.push_back(LoadNode(input));
     }
-    if (!input) {
-        throw ParsingError("Array parsing error"s);
+}
+
+#ifdef __SSE2__
+void ClassifyBlockSse2(const char* block, BlockMasks& masks)
+{
+    masks = {};
+    for (size_t part = 0; part < BLOCK_SIZE / 16; ++part) {
+        const __m128i v = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(block + 16 * part));
+        const auto bits = [part](__m128i mask) {
+            return static_cast<uint64_t>(static_cast<uint16_t>(
+                       _mm_movemask_epi8(mask)))
+                   << (16 * part);
+        };
+        const auto equal = [&v](char c) {
+            return _mm_cmpeq_epi8(v, _mm_set1_epi8(c));
+        };
+        // '[' и ']' отличаются от '{' и '}' только битом 0x20
+        const __m128i folded = _mm_or_si128(v, _mm_set1_epi8(0x20));
+        const __m128i line_ends = _mm_or_si128(equal('\n'), equal('\r'));
+        // \t, \n, \v, \f, \r - коды с 9 по 13
+        const __m128i controls =
+            _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(8)),
+                          _mm_cmplt_epi8(v, _mm_set1_epi8(14)));
+        masks.quotes |= bits(equal('"'));
+        masks.backslashes |= bits(equal('\\'));
+        masks.spaces |= bits(_mm_or_si128(equal(' '), controls));
+        masks.structurals |= bits(_mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(folded, _mm_set1_epi8('{')),
+                         _mm_cmpeq_epi8(folded, _mm_set1_epi8('}'))),
+            _mm_or_si128(equal(':'), equal(','))));
+        masks.line_ends |= bits(line_ends);
+        masks.non_ascii |= bits(v);
+        // Сравнения знаковые: 0x80-0xBF - это -128..-65, 0xC2-0xDF -
+        // -62..-33
+        masks.continuations |= bits(_mm_cmplt_epi8(v, _mm_set1_epi8(-64)));
+        masks.leads2 |=
+            bits(_mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(-63)),
+                               _mm_cmplt_epi8(v, _mm_set1_epi8(-32))));
     }
-    return Node(std::move(result));
 }
+#endif
 
-Node LoadDict(std::istream& input)
+#if defined(__GNUC__) && defined(__x86_64__)
+// Лямбды не наследуют атрибут target, поэтому маски считаются явно
+__attribute__((target("avx2"))) void ClassifyBlockAvx2(const char* block,
+                                                       BlockMasks& masks)
 {
-    Dict dict;
+    masks = {};
+    for (size_t part = 0; part < BLOCK_SIZE / 32; ++part) {
+        const __m256i v = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(block + 32 * part));
+        const __m256i folded = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+        const __m256i line_ends =
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')),
+                            _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')));
+        const __m256i spaces = _mm256_or_si256(
+            _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+            _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(8)),
+                             _mm256_cmpgt_epi8(_mm256_set1_epi8(14), v)));
+        const __m256i structurals = _mm256_or_si256(
+            _mm256_or_si256(
+                _mm256_cmpeq_epi8(folded, _mm256_set1_epi8('{')),
+                _mm256_cmpeq_epi8(folded, _mm256_set1_epi8('}'))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(':')),
+                            _mm256_cmpeq_epi8(v, _mm256_set1_epi8(','))));
+        const int shift = static_cast<int>(32 * part);
+        masks.quotes |= static_cast<uint64_t>(static_cast<uint32_t>(
+                            _mm256_movemask_epi8(_mm256_cmpeq_epi8(
+                                v, _mm256_set1_epi8('"')))))
+                        << shift;
+        masks.backslashes |= static_cast<uint64_t>(static_cast<uint32_t>(
+                                 _mm256_movemask_epi8(_mm256_cmpeq_epi8(
+                                     v, _mm256_set1_epi8('\\')))))
+                             << shift;
+        masks.spaces |= static_cast<uint64_t>(static_cast<uint32_t>(
+                            _mm256_movemask_epi8(spaces)))
+                        << shift;
+        masks.structurals |= static_cast<uint64_t>(static_cast<uint32_t>(
+                                 _mm256_movemask_epi8(structurals)))
+                             << shift;
+        masks.line_ends |= static_cast<uint64_t>(static_cast<uint32_t>(
+                               _mm256_movemask_epi8(line_ends)))
+                           << shift;
+        masks.non_ascii |= static_cast<uint64_t>(
+                               static_cast<uint32_t>(_mm256_movemask_epi8(v)))
+                           << shift;
+        const __m256i continuations =
+            _mm256_cmpgt_epi8(_mm256_set1_epi8(-64), v);
+        const __m256i leads2 =
+            _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(-63)),
+                             _mm256_cmpgt_epi8(_mm256_set1_epi8(-32), v));
+        masks.continuations |= static_cast<uint64_t>(static_cast<uint32_t>(
+                                   _mm256_movemask_epi8(continuations)))
+                               << shift;
+        masks.leads2 |= static_cast<uint64_t>(static_cast<uint32_t>(
+                            _mm256_movemask_epi8(leads2)))
+                        << shift;
+    }
+}
+#endif
 
-    for (char c; input >> c && c != '}';) {
-        if (c == '"') {
-            std::string key = LoadString(input).AsString();
-            if (input >> c && c == ':') {
-                if (dict.find(key) != dict.end()) {
-                    throw ParsingError("Duplicate key '"s + key +
-                                       "' have been found");
-                }
-                dict.emplace(std::move(key), LoadNode(input));
-            } else {
-                throw ParsingError(": is expected but '"s + c +
-                                   "' has been found"s);
-            }
-        } else if (c != ',') {
-            throw ParsingError(R"(',' is expected but ')"s + c +
-                               "' has been found"s);
+// Разбор блоков выбирается один раз по возможностям процессора
+ClassifyBlock GetClassifyBlock()
+{
+    static const ClassifyBlock classify = [] {
+#if defined(__GNUC__) && defined(__x86_64__)
+        if (__builtin_cpu_supports("avx2")) {
+            return &ClassifyBlockAvx2;
         }
-    }
-    if (!input) {
-        throw ParsingError("Dictionary parsing error"s);
-    }
-    return Node(std::move(dict));
+#endif
+#ifdef __SSE2__
+        return &ClassifyBlockSse2;
+#else
+        return &ClassifyBlockScalar;
+#endif
+    }();
+    return classify;
 }
 
-Node LoadString(std::istream& input)
+// Бит i результата - xor битов с 0 по i
+uint64_t PrefixXor(uint64_t bits)
 {
-    auto it = std::istreambuf_iterator<char>(input);
-    auto end = std::istreambuf_iterator<char>();
-    std::string s;
-    while (true) {
-        if (it == end) {
-            throw ParsingError("String parsing error");
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+// Первая стадия разбора: индекс позиций, с которых вторая стадия
+// продолжает разбор. В индекс попадают структурные символы вне строк,
+// кавычки, начала чисел и литералов, а внутри строк - обратные косые
+// черты и переводы строк. Текст индексируется окнами, поэтому индекс
+// большого документа не занимает много памяти; заодно проверяется, что
+// текст в UTF-8.
+class StructuralIndexer {
+public:
+    explicit StructuralIndexer(std::string_view input)
+        : pos_(input.data())
+        , end_(input.data() + input.size())
+        , classify_(GetClassifyBlock())
+    {
+    }
+
+    bool HasMore() const
+    {
+        return pos_ != end_;
+    }
+
+    // Дописывает в index позиции следующего окна
+    void IndexWindow(std::vector<const char*>& index)
+    {
+        constexpr size_t WINDOW_SIZE = 1 << 16;
+        const char* window_end =
+            static_cast<size_t>(end_ - pos_) > WINDOW_SIZE ? pos_ + WINDOW_SIZE
+                                                           : end_;
+        for (; window_end - pos_ >= static_cast<ptrdiff_t>(BLOCK_SIZE);
+             pos_ += BLOCK_SIZE) {
+            IndexBlock(pos_, pos_, BLOCK_SIZE, index);
         }
-        const char ch = *it;
-        if (ch == '"') {
-            ++it;
-            break;
-        } else if (ch == '\\') {
-            ++it;
-            if (it == end) {
-                throw ParsingError("String parsing error");
-            }
-            const char escaped_char = *(it);
-            switch (escaped_char) {
-            case 'n':
-                s.push_back('\n');
-                break;
-            case 't':
-                s.push_back('\t');
-                break;
-            case 'r':
-                s.push_back('\r');
-                break;
-            case '"':
-                s.push_back('"');
-                break;
-            case '\\':
-                s.push_back('\\');
+        if (pos_ != window_end) {
+            // Последний неполный блок дополняется пробелами
+            char block[BLOCK_SIZE];
+            const size_t size = static_cast<size_t>(window_end - pos_);
+            std::fill(std::copy(pos_, window_end, block), block + BLOCK_SIZE,
+                      ' ');
+            IndexBlock(block, pos_, size, index);
+            pos_ = window_end;
+        }
+        if (pos_ == end_ && utf8_needed_ != 0) {
+            throw ParsingError("Invalid UTF-8"s);
+        }
+    }
+
+private:
+    const char* pos_;
+    const char* end_;
+    const ClassifyBlock classify_;
+    // Первый символ следующего блока экранирован
+    bool escaped_ = false;
+    // Все единицы, если следующий блок начинается внутри строки
+    uint64_t in_string_ = 0;
+    // Первому символу следующего блока предшествует пробел, структурный
+    // символ или кавычка (или начало текста)
+    uint64_t follows_separator_ = 1;
+    // Недостающие байты последнего символа UTF-8 и допустимые значения
+    // следующего из них
+    int utf8_needed_ = 0;
+    unsigned char utf8_low_ = 0x80;
+    unsigned char utf8_high_ = 0xBF;
+
+    // Символы блока, перед которыми нечетное число обратных косых черт.
+    // Обратные косые черты встречаются редко, поэтому перебираются по
+    // одной.
+    uint64_t FindEscaped(uint64_t backslashes)
+    {
+        uint64_t escaped = escaped_ ? 1 : 0;
+        backslashes &= ~escaped;
+        escaped_ = false;
+        while (backslashes != 0) {
+            const uint64_t bit = backslashes & (~backslashes + 1);
+            if (bit == uint64_t{1} << 63) {
+                escaped_ = true;
                 break;
-            default:
-                throw ParsingError("Unrecognized escape sequence \\"s +
-                                   escaped_char);
             }
-        } else if (ch == '\n' || ch == '\r') {
-            throw ParsingError("Unexpected end of line"s);
-        } else {
-            s.push_back(ch);
+            escaped |= bit << 1;
+            backslashes &= ~(bit | bit << 1);
         }
-        ++it;
+        return escaped;
     }
 
-    return Node(std::move(s));
-}
+    void IndexBlock(const char* block, const char* origin, size_t size,
+                    std::vector<const char*>& index)
+    {
+        BlockMasks masks;
+        classify_(block, masks);
+        if ((masks.non_ascii != 0 || utf8_needed_ != 0) &&
+            !ValidateTwoByteUtf8(masks)) {
+            ValidateUtf8(block, size);
+        }
 
-Node LoadBool(std::istream& input)
-{
-    const auto s = LoadLiteral(input);
-    if (s == "true"sv) {
-        return Node{true};
-    } else if (s == "false"sv) {
-        return Node{false};
-    } else {
-        throw ParsingError("Failed to parse '"s + s + "' as bool"s);
+        const uint64_t quotes =
+            masks.quotes & ~FindEscaped(masks.backslashes);
+        // Открывающая кавычка входит в строку, закрывающая - нет
+        const uint64_t in_string = PrefixXor(quotes) ^ in_string_;
+        in_string_ = uint64_t{0} - (in_string >> 63);
+
+        const uint64_t structurals = masks.structurals & ~in_string;
+        const uint64_t separators =
+            structurals | (masks.spaces & ~in_string) | quotes;
+        const uint64_t atoms = ~separators & ~in_string &
+                               (separators << 1 | follows_separator_);
+        follows_separator_ = separators >> 63;
+        const uint64_t specials =
+            (masks.backslashes | masks.line_ends) & in_string;
+
+        for (uint64_t bits = structurals | quotes | atoms | specials;
+             bits != 0; bits &= bits - 1) {
+            index.push_back(origin + std::countr_zero(bits));
+        }
     }
-}
 
-Node LoadNull(std::istream& input)
-{
-    if (auto literal = LoadLiteral(input); literal == "null"sv) {
-        return Node{nullptr};
-    } else {
-        throw ParsingError("Failed to parse '"s + literal + "' as null"s);
+    // Проверка по маскам для блока, в котором, как в кириллице, только
+    // ASCII и двухбайтовые символы: байты продолжения должны стоять ровно
+    // после первых байтов. Возвращает false, если блок так не проверить
+    // (трехбайтовые и четырехбайтовые символы) или в нем ошибка; тогда
+    // блок проверяется побайтово.
+    bool ValidateTwoByteUtf8(const BlockMasks& masks)
+    {
+        if (utf8_needed_ > 1 ||
+            (masks.non_ascii & ~(masks.continuations | masks.leads2)) != 0) {
+            return false;
+        }
+        // После utf8_needed_ == 1 подходит любой байт продолжения
+        if (masks.continuations !=
+            (masks.leads2 << 1 | static_cast<uint64_t>(utf8_needed_))) {
+            return false;
+        }
+        utf8_needed_ = static_cast<int>(masks.leads2 >> 63);
+        return true;
     }
-}
 
-Node LoadNumber(std::istream& input)
-{
-    std::string parsed_num;
+    void ValidateUtf8(const char* block, size_t size)
+    {
+        for (size_t i = 0; i < size; ++i) {
+            const auto byte = static_cast<unsigned char>(block[i]);
+            if (utf8_needed_ != 0) {
+                if (byte < utf8_low_ || byte > utf8_high_) {
+                    throw ParsingError("Invalid UTF-8"s);
+                }
+                --utf8_needed_;
+                utf8_low_ = 0x80;
+                utf8_high_ = 0xBF;
+            } else if (byte < 0x80) {
+                continue;
+            } else if (byte >= 0xC2 && byte <= 0xDF) {
+                utf8_needed_ = 1;
+            } else if (byte >= 0xE0 && byte <= 0xEF) {
+                // Без сокращенных форм и суррогатов
+                utf8_needed_ = 2;
+                utf8_low_ = byte == 0xE0 ? 0xA0 : 0x80;
+                utf8_high_ = byte == 0xED ? 0x9F : 0xBF;
+            } else if (byte >= 0xF0 && byte <= 0xF4) {
+                utf8_needed_ = 3;
+                utf8_low_ = byte == 0xF0 ? 0x90 : 0x80;
+                utf8_high_ = byte == 0xF4 ? 0x8F : 0xBF;
+            } else {
+                throw ParsingError("Invalid UTF-8"s);
+            }
+        }
+    }
+};
+
+// Вторая стадия разбора. Грамматика и сообщения об ошибках те же, что у
+// прежнего разбора из потока: запятые между элементами необязательны,
+// после документа может идти что угодно. Пробелы пропускаются переходом
+// к следующей позиции индекса, строка без экранирования и переводов строк
+// передается получателю прямо из буфера; остальное разбирается
+// посимвольно. Получатель - Handler или NodeBuilder, вызовы которого
+// не виртуальные.
+template <typename Consumer>
+class Parser {
+public:
+    Parser(std::string_view input, Consumer& consumer)
+        : pos_(input.data())
+        , end_(input.data() + input.size())
+        , indexer_(input)
+        , consumer_(consumer)
+    {
+    }
 
-    auto read_char = [&parsed_num, &input] {
-        parsed_num += static_cast<char>(input.get());
-        if (!input) {
-            throw ParsingError("Failed to read number from stream"s);
+    void ParseValue()
+    {
+        char c;
+        if (!NextToken(c)) {
+            throw ParsingError("Unexpected EOF"s);
+        }
+        switch (c) {
+        case '[':
+            ParseArray();
+            break;
+        case '{':
+            ParseDict();
+            break;
+        case '"':
+            consumer_.Value(ReadString());
+            break;
+        case 't':
+            [[fallthrough]];
+        case 'f':
+            --pos_;
+            ParseBool();
+            break;
+        case 'n':
+            --pos_;
+            ParseNull();
+            break;
+        default:
+            --pos_;
+            ParseNumber();
+            break;
         }
-    };
+    }
 
-    auto read_digits = [&input, read_char] {
-        if (!std::isdigit(input.peek())) {
-            throw ParsingError("A digit is expected"s);
+    // Проверяет кодировку оставшейся части текста
+    void Finish()
+    {
+        while (indexer_.HasMore()) {
+            index_.clear();
+            indexer_.IndexWindow(index_);
         }
-        while (std::isdigit(input.peek())) {
-            read_char();
+    }
+
+private:
+    const char* pos_;
+    const char* end_;
+    StructuralIndexer indexer_;
+    std::vector<const char*> index_;
+    size_t next_ = 0;
+    Consumer& consumer_;
+    // Строка с экранированием после замены последовательностей
+    std::string unescaped_;
+
+    // Первая позиция индекса не раньше pos_ или nullptr
+    const char* NextIndexed()
+    {
+        while (true) {
+            while (next_ < index_.size() && index_[next_] < pos_) {
+                ++next_;
+            }
+            if (next_ < index_.size()) {
+                return index_[next_];
+            }
+            if (!indexer_.HasMore()) {
+                return nullptr;
+            }
+            index_.clear();
+            next_ = 0;
+            indexer_.IndexWindow(index_);
         }
-    };
+    }
 
-    if (input.peek() == '-') {
-        read_char();
+    // Следующий символ после пробелов, как operator>> потока. Вне строк
+    // за пробелом первый непробельный символ всегда есть в индексе.
+    bool NextToken(char& c)
+    {
+        if (pos_ == end_) {
+            return false;
+        }
+        if (IsSpace(*pos_)) {
+            pos_ = NextIndexed();
+            if (pos_ == nullptr) {
+                pos_ = end_;
+                return false;
+            }
+        }
+        c = *pos_++;
+        return true;
     }
 
-    if (input.peek() == '0') {
-        read_char();
-    } else {
-        read_digits();
+    bool Peek(char c) const
+    {
+        return pos_ != end_ && *pos_ == c;
     }
 
-    bool is_int = true;
+    bool PeekDigit() const
+    {
+        return pos_ != end_ && IsDigit(*pos_);
+    }
 
-    if (input.peek() == '.') {
-        read_char();
-        read_digits();
-        is_int = false;
+    std::string_view ReadLiteral()
+    {
+        const char* begin = pos_;
+        while (pos_ != end_ &&
+               std::isalpha(static_cast<unsigned char>(*pos_))) {
+            ++pos_;
+        }
+        return {begin, static_cast<size_t>(pos_ - begin)};
     }
 
-    if (int ch = input.peek(); ch == 'e' || ch == 'E') {
-        read_char();
-        if (ch = input.peek(); ch == '+' || ch == '-') {
-            read_char();
+    void ParseArray()
+    {
+        consumer_.StartArray();
+        for (char c; NextToken(c);) {
+            if (c == ']') {
+                consumer_.EndArray();
+                return;
+            }
+            if (c != ',') {
+                --pos_;
+            }
+            ParseValue();
         }
-        read_digits();
-        is_int = false;
+        throw ParsingError("Array parsing error"s);
     }
 
-    try {
-        if (is_int) {
-            try {
-                return std::stoi(parsed_num);
-            } catch (...) {
+    void ParseDict()
+    {
+        consumer_.StartDict();
+        for (char c; NextToken(c);) {
+            if (c == '}') {
+                consumer_.EndDict();
+                return;
+            }
+            if (c == '"') {
+                const std::string_view key = ReadString();
+                if (NextToken(c) && c == ':') {
+                    consumer_.Key(key);
+                    ParseValue();
+                } else {
+                    throw ParsingError(": is expected but '"s + c +
+                                       "' has been found"s);
+                }
+            } else if (c != ',') {
+                throw ParsingError(R"(',' is expected but ')"s + c +
+                                   "' has been found"s);
             }
         }
-        return std::stod(parsed_num);
-    } catch (...) {
-        throw ParsingError("Failed to convert "s + parsed_num +
-                           " to number"s);
+        throw ParsingError("Dictionary parsing error"s);
     }
-}
 
-Node LoadNode(std::istream& input)
-{
-    char c;
-    if (!(input >> c)) {
-        throw ParsingError("Unexpected EOF"s);
+    // Строка после открывающей кавычки. Строка без экранирования
+    // возвращается из буфера, остальные собираются в unescaped_ и
+    // действительны до чтения следующей строки.
+    std::string_view ReadString()
+    {
+        if (const char* next = NextIndexed(); next && *next == '"') {
+            const std::string_view s(pos_, next - pos_);
+            pos_ = next + 1;
+            return s;
+        }
+        std::string& s = unescaped_;
+        s.clear();
+        while (true) {
+            const char* run = pos_;
+            while (pos_ != end_ && *pos_ != '"' && *pos_ != '\\' &&
+                   *pos_ != '\n' && *pos_ != '\r') {
+                ++pos_;
+            }
+            s.append(run, pos_);
+            if (pos_ == end_) {
+                throw ParsingError("String parsing error");
+            }
+            const char ch = *pos_++;
+            if (ch == '"') {
+                break;
+            } else if (ch == '\\') {
+                if (pos_ == end_) {
+                    throw ParsingError("String parsing error");
+                }
+                const char escaped_char = *pos_++;
+                switch (escaped_char) {
+                case 'n':
+                    s.push_back('\n');
+                    break;
+                case 't':
+                    s.push_back('\t');
+                    break;
+                case 'r':
+                    s.push_back('\r');
+                    break;
+                case '"':
+                    s.push_back('"');
+                    break;
+                case '\\':
+                    s.push_back('\\');
+                    break;
+                default:
+                    throw ParsingError("Unrecognized escape sequence \\"s +
+                                       escaped_char);
+                }
+            } else {
+                throw ParsingError("Unexpected end of line"s);
+            }
+        }
+        return s;
     }
-    switch (c) {
-    case '[':
-        return LoadArray(input);
-    case '{':
-        return LoadDict(input);
-    case '"':
-        return LoadString(input);
-    case 't':
-        [[fallthrough]];
-    case 'f':
-        input.putback(c);
-        return LoadBool(input);
-    case 'n':
-        input.putback(c);
-        return LoadNull(input);
-    default:
-        input.putback(c);
-        return LoadNumber(input);
+
+    void ParseBool()
+    {
+        const std::string_view s = ReadLiteral();
+        if (s == "true"sv) {
+            consumer_.Value(true);
+        } else if (s == "false"sv) {
+            consumer_.Value(false);
+        } else {
+            throw ParsingError("Failed to parse '"s + std::string(s) +
+                               "' as bool"s);
+        }
     }
-}
+
+    void ParseNull()
+    {
+        if (const std::string_view literal = ReadLiteral();
+            literal == "null"sv) {
+            consumer_.Value(nullptr);
+        } else {
+            throw ParsingError("Failed to parse '"s + std::string(literal) +
+                               "' as null"s);
+        }
+    }
+
+    void ReadDigits()
+    {
+        if (!PeekDigit()) {
+            throw ParsingError("A digit is expected"s);
+        }
+        while (PeekDigit()) {
+            ++pos_;
+        }
+    }
+
+    void ParseNumber()
+    {
+        const char* begin = pos_;
+        if (Peek('-')) {
+            ++pos_;
+        }
+
+        if (Peek('0')) {
+            ++pos_;
+        } else {
+            ReadDigits();
+        }
+
+        bool is_int = true;
+
+        if (Peek('.')) {
+            ++pos_;
+            ReadDigits();
+            is_int = false;
+        }
+
+        if (Peek('e') || Peek('E')) {
+            ++pos_;
+            if (Peek('+') || Peek('-')) {
+                ++pos_;
+            }
+            ReadDigits();
+            is_int = false;
+        }
+
+        // Целое, не помещающееся в int, читается как double
+        if (is_int) {
+            int value;
+            if (std::from_chars(begin, pos_, value).ec == std::errc()) {
+                consumer_.Value(value);
+                return;
+            }
+        }
+        double value;
+        if (std::from_chars(begin, pos_, value).ec != std::errc()) {
+            throw ParsingError("Failed to convert "s +
+                               std::string(begin, pos_) + " to number"s);
+        }
+        consumer_.Value(value);
+    }
+};
 
 struct PrintContext {
     std::ostream& out;
@@ -250,7 +735,7 @@ void PrintValue(const Value& value, const PrintContext& ctx)
     ctx.out << value;
 }
 
-void PrintString(const std::string& value, std::ostream& out)
+void PrintString(std::string_view value, std::ostream& out)
 {
     out.put('"');
     for (const char c : value) {
@@ -284,6 +769,45 @@ void PrintValue<std::string>(const std::string& value,
     PrintString(value, ctx.out);
 }
 
+template <>
+void PrintValue<StringRef>(const StringRef& value, const PrintContext& ctx)
+{
+    PrintString(value.value, ctx.out);
+}
+
+// В JSON нет бесконечности и NaN: такой документ никто не прочитает
+void CheckFinite(double value)
+{
+    if (!std::isfinite(value)) {
+        throw std::invalid_argument("Cannot print non-finite number "s +
+                                    std::to_string(value) + " as JSON"s);
+    }
+}
+
+template <>
+void PrintValue<double>(const double& value, const PrintContext& ctx)
+{
+    CheckFinite(value);
+    ctx.out << value;
+}
+
+// Проверяет числа узла до печати, чтобы ошибка не оставила в выводе
+// половину элемента
+void CheckFinite(const Node& node)
+{
+    if (node.IsPureDouble()) {
+        CheckFinite(node.AsDouble());
+    } else if (node.IsArray()) {
+        for (const Node& item : node.AsArray()) {
+            CheckFinite(item);
+        }
+    } else if (node.IsDict()) {
+        for (const auto& [key, item] : node.AsDict()) {
+            CheckFinite(item);
+        }
+    }
+}
+
 template <>
 void PrintValue<std::nullptr_t>(const std::nullptr_t&,
                                 const PrintContext& ctx)
@@ -350,9 +874,103 @@ void PrintNode(const Node& node, const PrintContext& ctx)
 
 } // namespace
 
+void NodeBuilder::StartDict()
+{
+    Node& node = NextSlot();
+    node = Dict{};
+    stack_.push_back(&node);
+}
+
+void NodeBuilder::EndDict()
+{
+    stack_.pop_back();
+}
+
+void NodeBuilder::StartArray()
+{
+    Node& node = NextSlot();
+    node = Array{};
+    stack_.push_back(&node);
+}
+
+void NodeBuilder::EndArray()
+{
+    stack_.pop_back();
+}
+
+void NodeBuilder::Key(std::string_view key)
+{
+    const auto [it, inserted] =
+        stack_.back()->AsDict().try_emplace(std::string(key), nullptr);
+    if (!inserted) {
+        throw ParsingError("Duplicate key '"s + std::string(key) +
+                           "' have been found");
+    }
+    slot_ = &it->second;
+}
+
+void NodeBuilder::Value(std::nullptr_t)
+{
+    NextSlot() = nullptr;
+}
+
+void NodeBuilder::Value(bool value)
+{
+    NextSlot() = value;
+}
+
+void NodeBuilder::Value(int value)
+{
+    NextSlot() = value;
+}
+
+void NodeBuilder::Value(double value)
+{
+    NextSlot() = value;
+}
+
+void NodeBuilder::Value(std::string_view value)
+{
+    NextSlot() = std::string(value);
+}
+
+Node NodeBuilder::Extract()
+{
+    return std::move(root_);
+}
+
+Node& NodeBuilder::NextSlot()
+{
+    if (stack_.empty()) {
+        return root_;
+    }
+    if (stack_.back()->IsArray()) {
+        return stack_.back()->AsArray().emplace_back(nullptr);
+    }
+    return *std::exchange(slot_, nullptr);
+}
+
+void Parse(std::string_view input, Handler& handler)
+{
+    Parser<Handler> parser(input, handler);
+    parser.ParseValue();
+    parser.Finish();
+}
+
+Document Load(std::string_view input)
+{
+    NodeBuilder builder;
+    Parser<NodeBuilder> parser(input, builder);
+    parser.ParseValue();
+    parser.Finish();
+    return Document{builder.Extract()};
+}
+
 Document Load(std::istream& input)
 {
-    return Document{LoadNode(input)};
+    std::ostringstream buffer;
+    buffer << input.rdbuf();
+    return Load(buffer.view());
 }
 
 void Print(const Document& doc, std::ostream& output)
@@ -360,4 +978,28 @@ void Print(const Document& doc, std::ostream& output)
     PrintNode(doc.GetRoot(), PrintContext{output});
 }
 
+ArrayPrinter::ArrayPrinter(std::ostream& output)
+    : output_(output)
+{
+    output_ << "[\n"sv;
+}
+
+void ArrayPrinter::Print(const Node& node)
+{
+    CheckFinite(node);
+    if (is_first_) {
+        is_first_ = false;
+    } else {
+        output_ << ",\n"sv;
+    }
+    const PrintContext ctx = PrintContext{output_}.Indented();
+    ctx.PrintIndent();
+    PrintNode(node, ctx);
+}
+
+void ArrayPrinter::Finish()
+{
+    output_ << "\n]"sv;
+}
+
 } // namespace json
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include <iostream>
 #include <map>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
@@ -19,8 +20,24 @@ public:
     using runtime_error::runtime_error;
 };
 
-class Node final : private std::variant<std::nullptr_t, Array, Dict, bool,
-                                        int, double, std::string> {
+// Строка, не принадлежащая узлу: ссылается на внешний буфер, например на
+// название в каталоге. Для IsString, AsStringView, сравнения и печати
+// такой узел не отличается от узла со строкой std::string. Буфер должен
+// жить, пока используется узел.
+struct StringRef {
+    explicit StringRef(std::string_view value)
+        : value(value)
+    {
+    }
+
+    bool operator==(const StringRef& rhs) const = default;
+
+    std::string_view value;
+};
+
+class Node final
+    : private std::variant<std::nullptr_t, Array, Dict, bool, int, double,
+                           std::string, StringRef> {
 public:
     using variant::variant;
     using Value = variant;
@@ -112,18 +129,34 @@ public:
 
     bool IsString() const
     {
-        return std::holds_alternative<std::string>(*this);
+        return std::holds_alternative<std::string>(*this) ||
+               std::holds_alternative<StringRef>(*this);
     }
 
+    // Только для строки, принадлежащей узлу; строку из StringRef
+    // возвращает AsStringView
     const std::string& AsString() const
     {
         using namespace std::literals;
-        if (!IsString()) {
-            throw std::logic_error("Not a string"s);
+        if (!std::holds_alternative<std::string>(*this)) {
+            throw std::logic_error(IsString() ? "Not an owned string"s
+                                              : "Not a string"s);
         }
         return std::get<std::string>(*this);
     }
 
+    std::string_view AsStringView() const
+    {
+        using namespace std::literals;
+        if (const auto* value = std::get_if<StringRef>(this)) {
+            return value->value;
+        }
+        if (const auto* value = std::get_if<std::string>(this)) {
+            return *value;
+        }
+        throw std::logic_error("Not a string"s);
+    }
+
     bool IsDict() const
     {
         return std::holds_alternative<Dict>(*this);
@@ -147,8 +180,12 @@ public:
         return std::get<Dict>(*this);
     }
 
+    // Строки сравниваются по содержимому, как бы они ни хранились
     bool operator==(const Node& rhs) const
     {
+        if (IsString() && rhs.IsString()) {
+            return AsStringView() == rhs.AsStringView();
+        }
         return GetValue() == rhs.GetValue();
     }
 
@@ -189,8 +226,83 @@ inline bool operator!=(const Document& lhs, const Document& rhs)
     return !(lhs == rhs);
 }
 
+// Получатель событий разбора. Строки ключей и значений действительны
+// только до возврата из обработчика.
+class Handler {
+public:
+    virtual ~Handler() = default;
+
+    virtual void StartDict() = 0;
+    virtual void EndDict() = 0;
+    virtual void StartArray() = 0;
+    virtual void EndArray() = 0;
+    virtual void Key(std::string_view key) = 0;
+    virtual void Value(std::nullptr_t) = 0;
+    virtual void Value(bool value) = 0;
+    virtual void Value(int value) = 0;
+    virtual void Value(double value) = 0;
+    virtual void Value(std::string_view value) = 0;
+};
+
+// Собирает узлы из событий разбора; повтор ключа в словаре - ParsingError
+class NodeBuilder final : public Handler {
+public:
+    void StartDict() override;
+    void EndDict() override;
+    void StartArray() override;
+    void EndArray() override;
+    void Key(std::string_view key) override;
+    void Value(std::nullptr_t) override;
+    void Value(bool value) override;
+    void Value(int value) override;
+    void Value(double value) override;
+    void Value(std::string_view value) override;
+
+    Node Extract();
+
+private:
+    Node root_ = nullptr;
+    // Открытые массивы и словари
+    std::vector<Node*> stack_;
+    // Место для значения после ключа
+    Node* slot_ = nullptr;
+
+    Node& NextSlot();
+};
+
+// Разбирает документ в непрерывном буфере, например в отображенном в
+// память файле, и сообщает о его элементах обработчику, не строя узлов.
+// Грамматика и ошибки те же, что у Load.
+void Parse(std::string_view input, Handler& handler);
+
+// Разбирает документ в непрерывном буфере, например в отображенном в
+// память файле. Узлы документа не ссылаются на буфер. Текст должен быть в
+// UTF-8, иначе выбрасывается ParsingError.
+Document Load(std::string_view input);
+
+// Читает поток целиком и разбирает как Load(std::string_view)
 Document Load(std::istream& input);
 
+// Бесконечность и NaN в JSON не записываются: на них выбрасывается
+// std::invalid_argument
 void Print(const Document& doc, std::ostream& output);
 
+// Печатает массив по одному элементу так же, как Print печатает документ
+// с этим массивом, не храня элементы. Элемент с бесконечностью или NaN не
+// печатается вовсе: выбрасывается std::invalid_argument, и вывод остается
+// на границе элементов.
+class ArrayPrinter {
+public:
+    explicit ArrayPrinter(std::ostream& output);
+
+    void Print(const Node& node);
+
+    // Закрывает массив
+    void Finish();
+
+private:
+    std::ostream& output_;
+    bool is_first_ = true;
+};
+
 } // namespace json
\ No newline at end of file
@@ -2,9 +2,17 @@
 
 #include "json_reader.h"
 
+#include "gtfs_reader.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+
 namespace json_reader {
 
 struct EdgeInfoGetter {
+    const transport_catalogue::TransportCatalogue& catalogue;
+
     json::Node operator()(const domain::StopEdge& edge_info)
     {
         return json::Builder{}
@@ -12,7 +20,7 @@ struct EdgeInfoGetter {
             .Key("type")
             .Value("Wait")
             .Key("stop_name")
-            .Value(std::string(edge_info.stopptr->name))
+            .Value(json::StringRef(catalogue.GetStop(edge_info.stop_id).name))
             .Key("time")
             .Value(edge_info.time)
             .EndDict()
@@ -26,7 +34,7 @@ struct EdgeInfoGetter {
             .Key("type")
             .Value("Bus")
             .Key("bus")
-            .Value(std::string(edge_info.busptr->name))
+            .Value(json::StringRef(catalogue.GetRoute(edge_info.route_id).name))
             .Key("span_count")
             .Value(static_cast<int>(edge_info.span_count))
             .Key("time")
@@ -34,8 +42,52 @@ struct EdgeInfoGetter {
             .EndDict()
             .Build();
     }
+
+    json::Node operator()(const domain::WalkEdge& edge_info)
+    {
+        json::Builder item;
+        item.StartDict().Key("type").Value("Walk").Key("time").Value(
+            edge_info.time);
+        if (edge_info.from) {
+            item.Key("from").Value(
+                json::StringRef(catalogue.GetStop(*edge_info.from).name));
+        }
+        if (edge_info.to) {
+            item.Key("to").Value(
+                json::StringRef(catalogue.GetStop(*edge_info.to).name));
+        }
+        return item.EndDict().Build();
+    }
 };
 
+// Точка маршрута - название остановки или объект с координатами
+request_handler::RoutePoint ReadRoutePoint(const json::Node& node)
+{
+    if (node.IsString()) {
+        return std::string_view(node.AsString());
+    }
+    const json::Dict& point = node.AsDict();
+    return geo::Coordinates{point.at("latitude").AsDouble(),
+                            point.at("longitude").AsDouble()};
+}
+
+// Необязательное поле запроса с числом записей, по умолчанию limit;
+// nullopt, если число не положительно
+std::optional<size_t> ReadLimit(const json::Dict& request,
+                                size_t default_limit,
+                                const std::string& key = "limit")
+{
+    const auto it = request.find(key);
+    if (it == request.end()) {
+        return default_limit;
+    }
+    const int limit = it->second.AsInt();
+    if (limit <= 0) {
+        return std::nullopt;
+    }
+    return static_cast<size_t>(limit);
+}
+
 svg::Color NodeToSVGColor(const json::Node& node_color)
 {
     if (node_color.IsArray()) {
@@ -63,53 +115,394 @@ svg::Color NodeToSVGColor(const json::Node& node_color)
     return node_color.AsString();
 }
 
-transport_catalogue::TransportCatalogue JsonReader::ReadTransportCatalogue()
-    const
+transport_catalogue::DeltaBatch ReadDeltaBatch(const json::Array& requests)
 {
-    transport_catalogue::TransportCatalogue transport_catalogue;
-    json::Dict dict = doc_.GetRoot().AsDict();
-    json::Array requests = dict.at("base_requests").AsArray();
-
+    transport_catalogue::DeltaBatch batch;
     for (const auto& request : requests) {
-        if (request.AsDict().at("type").AsString() == "Stop") {
-            std::unordered_map<std::string_view, size_t> length_to_stop;
-            for (const auto& [name, length] :
-                 request.AsDict().at("road_distances").AsDict()) {
-                length_to_stop[name] = static_cast<size_t>(length.AsInt());
+        ReadDeltaRecord(request, batch);
+    }
+    return batch;
+}
+
+void ReadDeltaRecord(const json::Node& request,
+                     transport_catalogue::DeltaBatch& batch)
+{
+    const json::Dict& dict = request.AsDict();
+    const std::string& type = dict.at("type").AsString();
+    if (type == "Stop") {
+        const json::Dict& distances = dict.at("road_distances").AsDict();
+        transport_catalogue::StopData& stop = batch.stops.emplace_back();
+        stop.name = dict.at("name").AsString();
+        stop.coordinates = {dict.at("latitude").AsDouble(),
+                            dict.at("longitude").AsDouble()};
+        stop.road_distances.reserve(distances.size());
+        for (const auto& [name, length] : distances) {
+            stop.road_distances.emplace_back(
+                name, static_cast<size_t>(length.AsInt()));
+        }
+    } else if (type == "Bus") {
+        const json::Array& bus_stops = dict.at("stops").AsArray();
+        transport_catalogue::RouteData& route = batch.routes.emplace_back();
+        route.name = dict.at("name").AsString();
+        route.is_roundtrip = dict.at("is_roundtrip").AsBool();
+        route.stops.reserve(bus_stops.size());
+        for (const auto& stop : bus_stops) {
+            route.stops.push_back(stop.AsString());
+        }
+    } else if (type == "Distance") {
+        batch.distances.push_back(
+            {dict.at("from").AsString(), dict.at("to").AsString(),
+             static_cast<size_t>(dict.at("distance").AsInt())});
+    } else if (type == "RemoveStop") {
+        batch.removed_stops.push_back(dict.at("name").AsString());
+    } else if (type == "RemoveBus") {
+        batch.removed_routes.push_back(dict.at("name").AsString());
+    } else if (type == "RemoveDistance") {
+        batch.removed_distances.emplace_back(dict.at("from").AsString(),
+                                             dict.at("to").AsString());
+    }
+}
+
+// Передает события значения ключа key корневого словаря обработчику
+// selected, остальные события - обработчику others. Вместо отсутствующего
+// обработчика события пропускаются.
+class RootKeySplitter final : public json::Handler {
+public:
+    RootKeySplitter(std::string_view key, json::Handler* selected,
+                    json::Handler* others)
+        : key_(key)
+        , selected_(selected)
+        , others_(others)
+    {
+    }
+
+    void StartDict() override
+    {
+        if (json::Handler* handler = Target()) {
+            handler->StartDict();
+        }
+        ++depth_;
+    }
+
+    void EndDict() override
+    {
+        json::Handler* handler = Target();
+        --depth_;
+        if (handler) {
+            handler->EndDict();
+        }
+        EndValue();
+    }
+
+    void StartArray() override
+    {
+        if (json::Handler* handler = Target()) {
+            handler->StartArray();
+        }
+        ++depth_;
+    }
+
+    void EndArray() override
+    {
+        json::Handler* handler = Target();
+        --depth_;
+        if (handler) {
+            handler->EndArray();
+        }
+        EndValue();
+    }
+
+    void Key(std::string_view key) override
+    {
+        if (depth_ == 1 && key == key_) {
+            if (found_) {
+                throw json::ParsingError("Duplicate key '" +
+                                         std::string(key) +
+                                         "' have been found");
             }
-            transport_catalogue.AddStop(
-                request.AsDict().at("name").AsString(),
-                {request.AsDict().at("latitude").AsDouble(),
-                 request.AsDict().at("longitude").AsDouble()},
-                length_to_stop);
+            found_ = true;
+            is_selected_ = true;
+        } else if (json::Handler* handler = Target()) {
+            handler->Key(key);
         }
     }
 
-    for (const auto& request : requests) {
-        if (request.AsDict().at("type").AsString() == "Bus") {
-            std::vector<std::string_view> stops;
-            for (const auto& stop :
-                 request.AsDict().at("stops").AsArray()) {
-                stops.push_back(stop.AsString());
+    void Value(std::nullptr_t) override
+    {
+        ForwardValue(nullptr);
+    }
+
+    void Value(bool value) override
+    {
+        ForwardValue(value);
+    }
+
+    void Value(int value) override
+    {
+        ForwardValue(value);
+    }
+
+    void Value(double value) override
+    {
+        ForwardValue(value);
+    }
+
+    void Value(std::string_view value) override
+    {
+        ForwardValue(value);
+    }
+
+private:
+    std::string_view key_;
+    json::Handler* selected_;
+    json::Handler* others_;
+    int depth_ = 0;
+    bool found_ = false;
+    bool is_selected_ = false;
+
+    json::Handler* Target() const
+    {
+        return is_selected_ ? selected_ : others_;
+    }
+
+    template <typename Value>
+    void ForwardValue(Value value)
+    {
+        if (json::Handler* handler = Target()) {
+            handler->Value(value);
+        }
+        EndValue();
+    }
+
+    // Значение ключа корневого словаря закончилось
+    void EndValue()
+    {
+        if (depth_ == 1) {
+            is_selected_ = false;
+        }
+    }
+};
+
+// Применяет base_requests к каталогу по мере разбора с тем же результатом,
+// что ApplyDelta(ReadDeltaBatch(...)). Каждый запрос собирается в
+// отдельный узел и сразу переносится в каталог или в отложенный пакет,
+// названия которого хранятся в пуле загрузчика.
+//
+// Из пустого каталога удалять нечего, поэтому в него остановки
+// добавляются пачками по мере чтения. Расстояния и маршруты могут
+// ссылаться на остановки, описанные позже, и добавляются в Finish в том
+// же порядке, что и в ApplyDelta, - идентификаторы получаются те же. В
+// непустой каталог весь пакет добавляется в Finish: удаления должны
+// предшествовать добавлениям.
+class BaseRequestsLoader final : public json::Handler {
+public:
+    explicit BaseRequestsLoader(
+        transport_catalogue::TransportCatalogue& catalogue)
+        : catalogue_(catalogue)
+        , is_streaming_(catalogue.GetStops().empty() &&
+                        catalogue.GetRoutes().empty())
+    {
+    }
+
+    void StartDict() override
+    {
+        CheckArrayStarted();
+        request_.StartDict();
+        ++depth_;
+    }
+
+    void EndDict() override
+    {
+        request_.EndDict();
+        --depth_;
+        EndValue();
+    }
+
+    void StartArray() override
+    {
+        if (depth_ > 0) {
+            request_.StartArray();
+        }
+        ++depth_;
+    }
+
+    void EndArray() override
+    {
+        --depth_;
+        if (depth_ > 0) {
+            request_.EndArray();
+            EndValue();
+        }
+    }
+
+    void Key(std::string_view key) override
+    {
+        request_.Key(key);
+    }
+
+    void Value(std::nullptr_t) override
+    {
+        AddValue(nullptr);
+    }
+
+    void Value(bool value) override
+    {
+        AddValue(value);
+    }
+
+    void Value(int value) override
+    {
+        AddValue(value);
+    }
+
+    void Value(double value) override
+    {
+        AddValue(value);
+    }
+
+    void Value(std::string_view value) override
+    {
+        AddValue(value);
+    }
+
+    // Добавляет отложенные записи после конца массива
+    void Finish()
+    {
+        if (!is_streaming_) {
+            catalogue_.ApplyDelta(delta_);
+            return;
+        }
+        FlushStops();
+        // Остановки уже в каталоге, их координаты не меняются
+        for (transport_catalogue::StopData& stop : delta_.stops) {
+            stop.coordinates = catalogue_.FindStop(stop.name)->GetCoordinates();
+        }
+        catalogue_.AddBatch(delta_.stops, delta_.routes);
+        for (const auto& [from, to, length] : delta_.distances) {
+            catalogue_.SetLengthFromTo(from, to, length);
+        }
+    }
+
+private:
+    // Наименьшая пачка остановок; пачки растут вместе с каталогом, чтобы
+    // индексы каталога перестраивались реже
+    static constexpr size_t MIN_STOPS_CHUNK = 4096;
+
+    transport_catalogue::TransportCatalogue& catalogue_;
+    const bool is_streaming_;
+    // Вложенность внутри массива base_requests
+    int depth_ = 0;
+    json::NodeBuilder request_;
+    transport_catalogue::NamePool names_;
+    // При потоковой загрузке в stops только остановки с расстояниями
+    transport_catalogue::DeltaBatch delta_;
+    // Остановки без расстояний, еще не добавленные в каталог
+    std::vector<transport_catalogue::StopData> chunk_stops_;
+
+    void CheckArrayStarted() const
+    {
+        if (depth_ == 0) {
+            throw std::logic_error("Not an array");
+        }
+    }
+
+    template <typename Value>
+    void AddValue(Value value)
+    {
+        CheckArrayStarted();
+        request_.Value(value);
+        EndValue();
+    }
+
+    void EndValue()
+    {
+        if (depth_ == 1) {
+            AddRequest(request_.Extract());
+        }
+    }
+
+    void AddRequest(const json::Node& request)
+    {
+        transport_catalogue::DeltaBatch record;
+        ReadDeltaRecord(request, record);
+        // Удаление из пустого каталога не находит записи, как и в
+        // ApplyDelta
+        if (is_streaming_ && !record.removed_routes.empty()) {
+            throw std::out_of_range("Route not found");
+        }
+        if (is_streaming_ && (!record.removed_distances.empty() ||
+                              !record.removed_stops.empty())) {
+            throw std::out_of_range("Stop not found");
+        }
+
+        for (const transport_catalogue::StopData& stop : record.stops) {
+            AddStop(stop);
+        }
+        for (const transport_catalogue::RouteData& route : record.routes) {
+            transport_catalogue::RouteData& added =
+                delta_.routes.emplace_back();
+            added.name = names_.Intern(route.name);
+            added.is_roundtrip = route.is_roundtrip;
+            added.stops.reserve(route.stops.size());
+            for (std::string_view stop : route.stops) {
+                added.stops.push_back(names_.Intern(stop));
             }
-            if (!request.AsDict().at("is_roundtrip").AsBool()) {
-                for (int it = static_cast<int>(stops.size() - 2); it >= 0;
-                     --it) {
-                    stops.push_back(stops[static_cast<size_t>(it)]);
-                }
+        }
+        for (const auto& [from, to, length] : record.distances) {
+            delta_.distances.push_back(
+                {names_.Intern(from), names_.Intern(to), length});
+        }
+        for (std::string_view name : record.removed_routes) {
+            delta_.removed_routes.push_back(names_.Intern(name));
+        }
+        for (const auto& [from, to] : record.removed_distances) {
+            delta_.removed_distances.emplace_back(names_.Intern(from),
+                                                  names_.Intern(to));
+        }
+        for (std::string_view name : record.removed_stops) {
+            delta_.removed_stops.push_back(names_.Intern(name));
+        }
+    }
+
+    void AddStop(const transport_catalogue::StopData& stop)
+    {
+        const std::string_view name = names_.Intern(stop.name);
+        if (is_streaming_) {
+            chunk_stops_.push_back({name, stop.coordinates, {}});
+        }
+        if (!is_streaming_ || !stop.road_distances.empty()) {
+            transport_catalogue::StopData& added = delta_.stops.emplace_back();
+            added.name = name;
+            added.coordinates = stop.coordinates;
+            added.road_distances.reserve(stop.road_distances.size());
+            for (const auto& [to, length] : stop.road_distances) {
+                added.road_distances.emplace_back(names_.Intern(to), length);
             }
-            transport_catalogue.AddRoute(
-                request.AsDict().at("name").AsString(), stops,
-                request.AsDict().at("is_roundtrip").AsBool());
+        }
+        if (chunk_stops_.size() >=
+            std::max(MIN_STOPS_CHUNK, catalogue_.GetAllStopsCount())) {
+            FlushStops();
         }
     }
-    return transport_catalogue;
+
+    void FlushStops()
+    {
+        catalogue_.AddBatch(chunk_stops_, {});
+        chunk_stops_.clear();
+    }
+};
+
+json::Document LoadWithoutBaseRequests(std::string_view input)
+{
+    json::NodeBuilder builder;
+    RootKeySplitter splitter("base_requests", nullptr, &builder);
+    json::Parse(input, splitter);
+    return json::Document(builder.Extract());
 }
 
-map_renderer::RenderSettings JsonReader::FillRenderSettings() const
+map_renderer::RenderSettings ReadRenderSettings(
+    const json::Dict& dict_settings)
 {
-    json::Dict dict = doc_.GetRoot().AsDict();
-    json::Dict dict_settings = dict.at("render_settings").AsDict();
     map_renderer::RenderSettings render_settings;
     render_settings.width = dict_settings.at("width").AsDouble();
     render_settings.height = dict_settings.at("height").AsDouble();
@@ -145,174 +538,556 @@ map_renderer::RenderSettings JsonReader::FillRenderSettings() const
     return render_settings;
 }
 
-domain::RouterSettings JsonReader::FillRouterSettings() const
+// Отрицательные веса ребер и деление на нулевую скорость проявились бы
+// только при поиске маршрута, поэтому настройки проверяются при чтении
+domain::RouterSettings ReadRouterSettings(const json::Dict& dict_settings)
 {
-    json::Dict dict = doc_.GetRoot().AsDict();
-    json::Dict dict_settings = dict.at("routing_settings").AsDict();
     domain::RouterSettings router_settings;
 
     router_settings.bus_wait_time =
         dict_settings.at("bus_wait_time").AsDouble();
+    if (!(router_settings.bus_wait_time >= 0)) {
+        throw std::invalid_argument(
+            "Routing setting bus_wait_time must not be negative");
+    }
     router_settings.bus_velocity =
         dict_settings.at("bus_velocity").AsDouble();
+    if (!(router_settings.bus_velocity > 0)) {
+        throw std::invalid_argument(
+            "Routing setting bus_velocity must be positive");
+    }
+    if (const auto it = dict_settings.find("pedestrian_velocity");
+        it != dict_settings.end()) {
+        router_settings.pedestrian_velocity = it->second.AsDouble();
+        if (!(router_settings.pedestrian_velocity > 0)) {
+            throw std::invalid_argument(
+                "Routing setting pedestrian_velocity must be positive");
+        }
+    }
+    if (const auto it = dict_settings.find("snap_stops_count");
+        it != dict_settings.end()) {
+        const int count = it->second.AsInt();
+        if (count < 1) {
+            throw std::invalid_argument(
+                "Routing setting snap_stops_count must be at least 1");
+        }
+        router_settings.snap_stops_count = static_cast<size_t>(count);
+    }
+    if (const auto it = dict_settings.find("walk_transfer_radius");
+        it != dict_settings.end()) {
+        router_settings.walk_transfer_radius = it->second.AsDouble();
+        if (!(router_settings.walk_transfer_radius >= 0)) {
+            throw std::invalid_argument(
+                "Routing setting walk_transfer_radius must not be negative");
+        }
+    }
 
     return router_settings;
 }
 
-Response JsonReader::GenerateResponses(
-    request_handler::RequestHandler& handler) const
+std::filesystem::path ReadSerializationFile(const json::Dict& dict)
 {
-    json::Dict dict = doc_.GetRoot().AsDict();
-    json::Array requests = dict.at("stat_requests").AsArray();
-    json::Array response_data;
+    return dict.at("serialization_settings").AsDict().at("file").AsString();
+}
 
-    router::TransportRouter router(
-        handler.GetTransportCatalogue(), FillRouterSettings(),
-        handler.GetTransportCatalogue().GetAllStopsCount());
+// Ответ на запрос id с сообщением об ошибке
+json::Node MakeErrorResponse(int id, std::string message)
+{
+    return json::Builder{}
+        .StartDict()
+        .Key("request_id")
+        .Value(id)
+        .Key("error_message")
+        .Value(std::move(message))
+        .EndDict()
+        .Build();
+}
 
-    for (const auto& request : requests) {
-        if (request.AsDict().at("type").AsString() == "Bus") {
-            if (handler
-                    .GetRouteStat(request.AsDict().at("name").AsString())
-                    .has_value()) {
-                domain::RouteStats route_stats =
-                    handler
-                        .GetRouteStat(request.AsDict().at("name").AsString())
-                        .value();
-
-                json::Node response =
-                    json::Builder{}
-                        .StartDict()
-                        .Key("request_id")
-                        .Value(request.AsDict().at("id").AsInt())
-                        .Key("curvature")
-                        .Value(static_cast<double>(route_stats.route_length) /
-                               route_stats.geo_distance)
-                        .Key("route_length")
-                        .Value(static_cast<int>(route_stats.route_length))
-                        .Key("stop_count")
-                        .Value(static_cast<int>(route_stats.stops_count))
-                        .Key("unique_stop_count")
-                        .Value(static_cast<int>(route_stats.uniquestops_count))
-                        .EndDict()
-                        .Build();
-                response_data.push_back(response.AsDict());
-            } else {
-                json::Node response =
-                    json::Builder{}
-                        .StartDict()
-                        .Key("request_id")
-                        .Value(request.AsDict().at("id").AsInt())
-                        .Key("error_message")
-                        .Value("not found")
-                        .EndDict()
-                        .Build();
-                response_data.push_back(response.AsDict());
-            }
-        } else if (request.AsDict().at("type").AsString() == "Stop") {
-            if (handler
-                    .GetStop(request.AsDict().at("name").AsString())
-                    .has_value()) {
-                json::Array buses;
-                std::set<std::string_view> buses_on_stop =
-                    handler.GetBusesByStop(
-                        request.AsDict().at("name").AsString());
-                for (auto& bus : buses_on_stop) {
-                    buses.push_back(std::string(bus));
-                }
-                json::Node response =
-                    json::Builder{}
-                        .StartDict()
-                        .Key("request_id")
-                        .Value(request.AsDict().at("id").AsInt())
-                        .Key("buses")
-                        .Value(buses)
-                        .EndDict()
-                        .Build();
-                response_data.push_back(response.AsDict());
-            } else {
-                json::Node response =
-                    json::Builder{}
-                        .StartDict()
-                        .Key("request_id")
-                        .Value(request.AsDict().at("id").AsInt())
-                        .Key("error_message")
-                        .Value("not found")
-                        .EndDict()
-                        .Build();
-                response_data.push_back(response.AsDict());
-            }
-        } else if (request.AsDict().at("type").AsString() == "Map") {
-            std::ostringstream outputStream;
-            handler.RenderMap().Render(outputStream);
-            std::string str = "\"" + outputStream.str() + "\"";
-
-            json::Node response =
-                json::Builder{}
-                    .StartDict()
-                    .Key("request_id")
-                    .Value(request.AsDict().at("id").AsInt())
-                    .Key("map")
-                    .Value(outputStream.str())
-                    .EndDict()
-                    .Build();
-            response_data.push_back(response.AsDict());
-        } else if (request.AsDict().at("type").AsString() == "Route") {
-            const auto& route_info =
-                GetRouteInfo(request.AsDict().at("from").AsString(),
-                             request.AsDict().at("to").AsString(), router,
-                             handler);
-            if (route_info.has_value()) {
-                json::Array items;
-                for (const auto& item : route_info->edges) {
-                    items.emplace_back(std::visit(EdgeInfoGetter{}, item));
-                }
-
-                json::Node response =
-                    json::Builder{}
-                        .StartDict()
-                        .Key("request_id")
-                        .Value(request.AsDict().at("id").AsInt())
-                        .Key("total_time")
-                        .Value(route_info->total_time)
-                        .Key("items")
-                        .Value(items)
-                        .EndDict()
-                        .Build();
-                response_data.push_back(response.AsDict());
-            } else {
-                json::Node response =
-                    json::Builder{}
-                        .StartDict()
-                        .Key("request_id")
-                        .Value(request.AsDict().at("id").AsInt())
-                        .Key("error_message")
-                        .Value("not found")
-                        .EndDict()
-                        .Build();
-                response_data.push_back(response.AsDict());
-            }
+// Ответ с error_message на запрос, обработка которого не удалась;
+// request_id есть, если он указан в запросе
+json::Node MakeErrorResponse(const json::Node& request,
+                             const std::string& message)
+{
+    if (request.IsDict()) {
+        const json::Dict& dict = request.AsDict();
+        if (const auto it = dict.find("id");
+            it != dict.end() && it->second.IsInt()) {
+            return MakeErrorResponse(it->second.AsInt(), message);
+        }
+    }
+    return json::Builder{}
+        .StartDict()
+        .Key("error_message")
+        .Value(message)
+        .EndDict()
+        .Build();
+}
+
+// Ответ, у которого кроме request_id одно поле key
+json::Node MakeResponse(int id, std::string key, json::Node::Value value)
+{
+    return json::Builder{}
+        .StartDict()
+        .Key("request_id")
+        .Value(id)
+        .Key(std::move(key))
+        .Value(std::move(value))
+        .EndDict()
+        .Build();
+}
+
+json::Node MakeBusResponse(const json::Dict& request,
+                           const request_handler::RequestHandler& handler)
+{
+    const int id = request.at("id").AsInt();
+    const std::optional<domain::RouteStats> stats =
+        handler.GetRouteStat(request.at("name").AsString());
+    if (!stats) {
+        return MakeErrorResponse(id, "not found");
+    }
+    return json::Builder{}
+        .StartDict()
+        .Key("request_id")
+        .Value(id)
+        .Key("curvature")
+        .Value(static_cast<double>(stats->route_length) / stats->geo_distance)
+        .Key("route_length")
+        .Value(static_cast<int>(stats->route_length))
+        .Key("stop_count")
+        .Value(static_cast<int>(stats->stops_count))
+        .Key("unique_stop_count")
+        .Value(static_cast<int>(stats->uniquestops_count))
+        .EndDict()
+        .Build();
+}
+
+json::Node MakeStopResponse(const json::Dict& request,
+                            const request_handler::RequestHandler& handler)
+{
+    const int id = request.at("id").AsInt();
+    const std::string& name = request.at("name").AsString();
+    if (!handler.GetStop(name)) {
+        return MakeErrorResponse(id, "not found");
+    }
+    json::Array buses;
+    for (const std::string_view bus : handler.GetBusesByStop(name)) {
+        buses.push_back(json::StringRef(bus));
+    }
+    return MakeResponse(id, "buses", std::move(buses));
+}
+
+json::Node MakeMapResponse(const json::Dict& request,
+                           const request_handler::RequestHandler& handler)
+{
+    std::ostringstream output;
+    handler.RenderMap().Render(output);
+    return MakeResponse(request.at("id").AsInt(), "map",
+                        std::move(output).str());
+}
+
+json::Node MakeStopsNearbyResponse(
+    const json::Dict& request,
+    const request_handler::RequestHandler& handler)
+{
+    const int id = request.at("id").AsInt();
+    std::optional<double> radius;
+    if (const auto it = request.find("radius"); it != request.end()) {
+        radius = it->second.AsDouble();
+    }
+    std::optional<size_t> count;
+    if (request.count("count")) {
+        count = ReadLimit(request, 0, "count");
+        if (!count) {
+            return MakeErrorResponse(id, "invalid count");
+        }
+    }
+    if (!radius && !count) {
+        return MakeErrorResponse(id, "radius or count required");
+    }
+    json::Array stops;
+    for (const auto& [stop_id, distance] : handler.GetStopsNearby(
+             {request.at("latitude").AsDouble(),
+              request.at("longitude").AsDouble()},
+             radius, count)) {
+        stops.push_back(
+            json::Builder{}
+                .StartDict()
+                .Key("name")
+                .Value(json::StringRef(
+                    handler.GetTransportCatalogue().GetStop(stop_id).name))
+                .Key("distance")
+                .Value(distance)
+                .EndDict()
+                .Build());
+    }
+    return MakeResponse(id, "stops", std::move(stops));
+}
+
+json::Node MakeStopsInBoxResponse(
+    const json::Dict& request,
+    const request_handler::RequestHandler& handler)
+{
+    json::Array stops;
+    for (const domain::StopView& stop : handler.GetStopsInBox(
+             {request.at("min_latitude").AsDouble(),
+              request.at("min_longitude").AsDouble()},
+             {request.at("max_latitude").AsDouble(),
+              request.at("max_longitude").AsDouble()})) {
+        stops.push_back(json::StringRef(stop.GetName()));
+    }
+    return MakeResponse(request.at("id").AsInt(), "stops", std::move(stops));
+}
+
+json::Node MakeStopSearchResponse(
+    const json::Dict& request,
+    const request_handler::RequestHandler& handler)
+{
+    const int id = request.at("id").AsInt();
+    const std::optional<size_t> limit = ReadLimit(request, 10);
+    if (!limit) {
+        return MakeErrorResponse(id, "invalid limit");
+    }
+    const std::string& query = request.at("query").AsString();
+    json::Array stops;
+    for (const domain::StopView& stop : handler.SearchStops(query, *limit)) {
+        stops.push_back(json::StringRef(stop.GetName()));
+    }
+
+    json::Builder response;
+    response.StartDict().Key("request_id").Value(id).Key("stops").Value(
+        std::move(stops));
+    if (const auto it = request.find("include_buses");
+        it != request.end() && it->second.AsBool()) {
+        json::Array buses;
+        for (const domain::RouteView& route :
+             handler.SearchRoutes(query, *limit)) {
+            buses.push_back(json::StringRef(route.GetName()));
+        }
+        response.Key("buses").Value(std::move(buses));
+    }
+    return response.EndDict().Build();
+}
+
+// Ответ на ListStops и ListBuses
+json::Node MakeListResponse(const json::Dict& request,
+                            const request_handler::RequestHandler& handler)
+{
+    const int id = request.at("id").AsInt();
+    const bool is_stops = request.at("type").AsString() == "ListStops";
+    const std::optional<size_t> limit = ReadLimit(request, 100);
+    if (!limit) {
+        return MakeErrorResponse(id, "invalid limit");
+    }
+    std::optional<std::string_view> cursor;
+    if (const auto it = request.find("cursor"); it != request.end()) {
+        cursor = it->second.AsString();
+    }
+    json::Array items;
+    std::optional<std::string_view> next_cursor;
+    if (is_stops) {
+        const auto page = handler.ListStops(cursor, *limit);
+        for (const domain::StopView& stop : page.items) {
+            items.push_back(json::StringRef(stop.GetName()));
+        }
+        next_cursor = page.next_cursor;
+    } else {
+        const auto page = handler.ListBuses(cursor, *limit);
+        for (const domain::RouteView& route : page.items) {
+            items.push_back(json::StringRef(route.GetName()));
+        }
+        next_cursor = page.next_cursor;
+    }
+
+    json::Builder response;
+    response.StartDict().Key("request_id").Value(id).Key(
+        is_stops ? "stops" : "buses").Value(std::move(items));
+    if (next_cursor) {
+        response.Key("next_cursor").Value(json::StringRef(*next_cursor));
+    }
+    return response.EndDict().Build();
+}
+
+json::Node MakeNetworkAnalyticsResponse(
+    const json::Dict& request,
+    const request_handler::RequestHandler& handler)
+{
+    const int id = request.at("id").AsInt();
+    network_analytics::AnalyticsSettings settings;
+    if (request.count("pivots")) {
+        settings.pivots = ReadLimit(request, 0, "pivots");
+        if (!settings.pivots) {
+            return MakeErrorResponse(id, "invalid pivots");
+        }
+    }
+    const std::optional<size_t> limit =
+        ReadLimit(request, std::numeric_limits<size_t>::max());
+    if (!limit) {
+        return MakeErrorResponse(id, "invalid limit");
+    }
+    if (const auto it = request.find("seed"); it != request.end()) {
+        settings.seed = static_cast<uint64_t>(it->second.AsInt());
+    }
+    const auto centrality = handler.GetStopCentrality(settings);
+    if (!centrality) {
+        return MakeErrorResponse(id, "not found");
+    }
+
+    // Самые важные остановки первыми, при равенстве - по названию
+    const transport_catalogue::TransportCatalogue& db =
+        handler.GetTransportCatalogue();
+    std::vector<network_analytics::StopCentrality> stops = *centrality;
+    std::sort(stops.begin(), stops.end(),
+              [&db](const auto& lhs, const auto& rhs) {
+                  if (lhs.betweenness != rhs.betweenness) {
+                      return lhs.betweenness > rhs.betweenness;
+                  }
+                  return db.GetStop(lhs.stop_id).name <
+                         db.GetStop(rhs.stop_id).name;
+              });
+    stops.resize(std::min(stops.size(), *limit));
+    json::Array items;
+    for (const network_analytics::StopCentrality& stop : stops) {
+        items.push_back(
+            json::Builder{}
+                .StartDict()
+                .Key("name")
+                .Value(json::StringRef(db.GetStop(stop.stop_id).name))
+                .Key("betweenness")
+                .Value(stop.betweenness)
+                .Key("closeness")
+                .Value(stop.closeness)
+                .EndDict()
+                .Build());
+    }
+    return MakeResponse(id, "stops", std::move(items));
+}
+
+json::Node MakeRouteResponse(const json::Dict& request,
+                             const request_handler::RequestHandler& handler)
+{
+    const int id = request.at("id").AsInt();
+    const std::optional<domain::RouteInfo> route_info = handler.BuildRoute(
+        ReadRoutePoint(request.at("from")), ReadRoutePoint(request.at("to")));
+    if (!route_info) {
+        return MakeErrorResponse(id, "not found");
+    }
+    json::Array items;
+    for (const auto& item : route_info->edges) {
+        items.emplace_back(
+            std::visit(EdgeInfoGetter{handler.GetTransportCatalogue()}, item));
+    }
+    return json::Builder{}
+        .StartDict()
+        .Key("request_id")
+        .Value(id)
+        .Key("total_time")
+        .Value(route_info->total_time)
+        .Key("items")
+        .Value(std::move(items))
+        .EndDict()
+        .Build();
+}
+
+// Печатает ответ на один запрос stat_requests; запрос неизвестного типа
+// остается без ответа
+void PrintResponse(const json::Node& request,
+                   const request_handler::RequestHandler& handler,
+                   json::ArrayPrinter& responses)
+{
+    using MakeResponseFunction =
+        json::Node (*)(const json::Dict&,
+                       const request_handler::RequestHandler&);
+    static const std::unordered_map<std::string_view, MakeResponseFunction>
+        make_response{{"Bus", MakeBusResponse},
+                      {"Stop", MakeStopResponse},
+                      {"Map", MakeMapResponse},
+                      {"StopsNearby", MakeStopsNearbyResponse},
+                      {"StopsInBox", MakeStopsInBoxResponse},
+                      {"StopSearch", MakeStopSearchResponse},
+                      {"ListStops", MakeListResponse},
+                      {"ListBuses", MakeListResponse},
+                      {"NetworkAnalytics", MakeNetworkAnalyticsResponse},
+                      {"Route", MakeRouteResponse}};
+
+    const json::Dict& dict = request.AsDict();
+    const auto it = make_response.find(dict.at("type").AsString());
+    if (it != make_response.end()) {
+        responses.Print(it->second(dict, handler));
+    }
+}
+
+JsonReader::JsonReader(std::istream& input)
+    : buffer_([&input] {
+        std::ostringstream buffer;
+        buffer << input.rdbuf();
+        return std::move(buffer).str();
+    }())
+    , input_(buffer_)
+    , doc_(LoadWithoutBaseRequests(input_))
+    , is_buffered_(true)
+{
+}
+
+JsonReader::JsonReader(std::string_view input)
+    : input_(input)
+    , doc_(LoadWithoutBaseRequests(input_))
+    , is_buffered_(false)
+{
+}
+
+transport_catalogue::TransportCatalogue JsonReader::ReadTransportCatalogue()
+    const
+{
+    if (is_buffered_ && input_.data() == nullptr) {
+        throw std::logic_error("base_requests have already been read");
+    }
+    const json::Dict& root = doc_.GetRoot().AsDict();
+
+    // Сначала загружается расписание GTFS, затем к нему применяются
+    // base_requests
+    transport_catalogue::TransportCatalogue transport_catalogue;
+    if (const auto gtfs = root.find("gtfs_settings"); gtfs != root.end()) {
+        transport_catalogue = gtfs_reader::ReadGtfs(std::filesystem::path(
+            gtfs->second.AsDict().at("directory").AsString()));
+    }
+    BaseRequestsLoader loader(transport_catalogue);
+    RootKeySplitter splitter("base_requests", &loader, nullptr);
+    json::Parse(input_, splitter);
+    loader.Finish();
+
+    // Остальной документ уже в узлах: текст из потока больше не нужен
+    if (is_buffered_) {
+        std::string().swap(buffer_);
+        input_ = {};
+    }
+    return transport_catalogue;
+}
+
+map_renderer::RenderSettings JsonReader::FillRenderSettings() const
+{
+    return ReadRenderSettings(
+        doc_.GetRoot().AsDict().at("render_settings").AsDict());
+}
+
+domain::RouterSettings JsonReader::FillRouterSettings() const
+{
+    return ReadRouterSettings(
+        doc_.GetRoot().AsDict().at("routing_settings").AsDict());
+}
+
+std::filesystem::path JsonReader::GetSerializationFile() const
+{
+    return ReadSerializationFile(doc_.GetRoot().AsDict());
+}
+
+std::vector<std::pair<std::string, city_registry::CitySettings>>
+JsonReader::ReadCities() const
+{
+    std::vector<std::pair<std::string, city_registry::CitySettings>> cities;
+    for (const auto& [name, node] :
+         doc_.GetRoot().AsDict().at("cities").AsDict()) {
+        const json::Dict& dict = node.AsDict();
+        cities.emplace_back(
+            name,
+            city_registry::CitySettings{
+                ReadSerializationFile(dict),
+                ReadRouterSettings(dict.at("routing_settings").AsDict()),
+                ReadRenderSettings(dict.at("render_settings").AsDict())});
+    }
+    return cities;
+}
+
+size_t JsonReader::GetMemoryBudget() const
+{
+    const json::Dict& root = doc_.GetRoot().AsDict();
+    if (const auto it = root.find("registry_settings"); it != root.end()) {
+        const json::Dict& dict = it->second.AsDict();
+        if (const auto budget = dict.find("memory_budget");
+            budget != dict.end()) {
+            return static_cast<size_t>(budget->second.AsDouble());
         }
     }
-    std::ostringstream outputStream;
-    json::Print(json::Document(response_data), outputStream);
-    return {"success", "json", outputStream.str()};
+    return std::numeric_limits<size_t>::max();
+}
+
+size_t JsonReader::GetRegionCount() const
+{
+    return static_cast<size_t>(doc_.GetRoot()
+                                   .AsDict()
+                                   .at("partition_settings")
+                                   .AsDict()
+                                   .at("regions")
+                                   .AsInt());
+}
+
+std::filesystem::path JsonReader::GetStoreDirectory() const
+{
+    return doc_.GetRoot()
+        .AsDict()
+        .at("store_settings")
+        .AsDict()
+        .at("directory")
+        .AsString();
 }
 
-std::optional<domain::RouteInfo> JsonReader::GetRouteInfo(
-    std::string_view from, std::string_view to,
-    router::TransportRouter& router,
-    request_handler::RequestHandler& handler) const
+size_t JsonReader::GetCompactionThreshold() const
 {
-    domain::Stop* begin =
-        handler.GetTransportCatalogue().FindStop(from).value();
-    domain::Stop* finish =
-        handler.GetTransportCatalogue().FindStop(to).value();
-    graph::VertexId start =
-        router.GetVertexIdByStop(begin)->bus_wait_start;
-    graph::VertexId end =
-        router.GetVertexIdByStop(finish)->bus_wait_start;
-    return router.GetRouteInfo(start, end);
+    const json::Dict& dict =
+        doc_.GetRoot().AsDict().at("store_settings").AsDict();
+    if (const auto it = dict.find("compaction_threshold"); it != dict.end()) {
+        const int threshold = it->second.AsInt();
+        if (threshold <= 0) {
+            throw std::invalid_argument(
+                "compaction_threshold must be positive");
+        }
+        return static_cast<size_t>(threshold);
+    }
+    return 1024;
+}
+
+std::vector<transport_catalogue::DeltaBatch> JsonReader::ReadDeltaBatches()
+    const
+{
+    std::vector<transport_catalogue::DeltaBatch> batches;
+    const json::Dict& root = doc_.GetRoot().AsDict();
+    if (const auto it = root.find("delta_batches"); it != root.end()) {
+        for (const json::Node& batch : it->second.AsArray()) {
+            batches.push_back(ReadDeltaBatch(batch.AsArray()));
+        }
+    }
+    return batches;
+}
+
+void JsonReader::GenerateResponses(
+    const request_handler::RequestHandler& handler,
+    std::ostream& output) const
+{
+    GenerateResponses(
+        [&handler](const json::Dict&)
+            -> const request_handler::RequestHandler& { return handler; },
+        output);
+}
+
+void JsonReader::GenerateResponses(
+    const std::function<const request_handler::RequestHandler&(
+        const json::Dict& request)>& get_handler,
+    std::ostream& output) const
+{
+    const json::Array& requests =
+        doc_.GetRoot().AsDict().at("stat_requests").AsArray();
+    json::ArrayPrinter responses(output);
+
+    for (const auto& request : requests) {
+        // Ошибка в одном запросе, в том числе при печати ответа, не
+        // прерывает ответы на остальные: ArrayPrinter проверяет ответ до
+        // записи, поэтому в выводе не остается его части
+        try {
+            PrintResponse(request, get_handler(request.AsDict()), responses);
+        } catch (const std::exception& error) {
+            responses.Print(MakeErrorResponse(request, error.what()));
+        }
+    }
+    responses.Finish();
 }
 
 } // namespace json_reader
\ No newline at end of file
@@ -2,30 +2,53 @@
 
 #pragma once
 
+#include "city_registry.h"
 #include "json.h"
 #include "json_builder.h"
 #include "map_renderer.h"
 #include "request_handler.h"
 #include "transport_router.h"
 
+#include <filesystem>
+#include <functional>
+#include <limits>
 #include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
 #include <variant>
+#include <vector>
 
 namespace json_reader {
 
-struct Response {
-    std::string status;
-    std::string data_type;
-    std::string data;
-};
+// Разбирает запросы в формате base_requests. Кроме Stop и Bus понимает
+// Distance, RemoveStop, RemoveBus и RemoveDistance. Строки пакета ссылаются
+// на узлы requests.
+transport_catalogue::DeltaBatch ReadDeltaBatch(const json::Array& requests);
+
+// Дописывает в пакет один запрос в формате base_requests. Строки пакета
+// ссылаются на узлы request.
+void ReadDeltaRecord(const json::Node& request,
+                     transport_catalogue::DeltaBatch& batch);
 
+// Документ, кроме base_requests, разбирается в узлы при создании.
+// base_requests читаются из текста документа прямо в каталог при вызове
+// ReadTransportCatalogue. Внешний буфер можно читать сколько угодно
+// раз. Текст из потока читатель хранит только до построения каталога:
+// после первого вызова ReadTransportCatalogue он освобождается, и в
+// памяти остается каталог без текста.
 class JsonReader {
 public:
-    explicit JsonReader(std::istream& input)
-        : doc_(json::Load(input))
-    {
-    }
+    explicit JsonReader(std::istream& input);
+
+    // Буфер должен существовать, пока существует читатель
+    explicit JsonReader(std::string_view input);
+
+    JsonReader(const JsonReader&) = delete;
+    JsonReader& operator=(const JsonReader&) = delete;
 
+    // Для читателя потока вызывается один раз, повторный вызов -
+    // std::logic_error
     transport_catalogue::TransportCatalogue ReadTransportCatalogue()
         const;
 
@@ -33,16 +56,48 @@ public:
 
     domain::RouterSettings FillRouterSettings() const;
 
-    Response GenerateResponses(
-        request_handler::RequestHandler& handler) const;
+    // Путь к бинарному снимку каталога из serialization_settings
+    std::filesystem::path GetSerializationFile() const;
+
+    // Города из словаря cities: у каждого serialization_settings,
+    // routing_settings и render_settings
+    std::vector<std::pair<std::string, city_registry::CitySettings>>
+    ReadCities() const;
+
+    // registry_settings.memory_budget в байтах, по умолчанию без ограничения
+    size_t GetMemoryBudget() const;
+
+    // Число регионов из partition_settings.regions
+    size_t GetRegionCount() const;
+
+    // Каталог для хранилища из store_settings.directory
+    std::filesystem::path GetStoreDirectory() const;
+
+    // store_settings.compaction_threshold, по умолчанию 1024 записи
+    size_t GetCompactionThreshold() const;
+
+    // Пакеты изменений из массива delta_batches, каждый в формате
+    // base_requests. Строки пакетов ссылаются на узлы документа.
+    std::vector<transport_catalogue::DeltaBatch> ReadDeltaBatches() const;
+
+    // Печатает ответы на stat_requests в output по мере обработки
+    // запросов
+    void GenerateResponses(const request_handler::RequestHandler& handler,
+                           std::ostream& output) const;
+
+    // Обработчик выбирается для каждого запроса отдельно
+    void GenerateResponses(
+        const std::function<const request_handler::RequestHandler&(
+            const json::Dict& request)>& get_handler,
+        std::ostream& output) const;
 
 private:
+    // Текст, прочитанный из потока; пуст, если разбирается внешний буфер
+    // или каталог уже построен
+    mutable std::string buffer_;
+    mutable std::string_view input_;
     const json::Document doc_;
-
-    std::optional<domain::RouteInfo> GetRouteInfo(
-        std::string_view start, std::string_view end,
-        router::TransportRouter& routing,
-        request_handler::RequestHandler& handler) const;
+    const bool is_buffered_;
 };
 
 } // namespace json_reader
\ No newline at end of file
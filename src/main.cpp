@@ -1,27 +1,142 @@
 // main.cpp
 
+#include <exception>
 #include <iostream>
+#include <string_view>
 
+#include "catalogue_serialization.h"
+#include "catalogue_snapshot.h"
+#include "catalogue_store.h"
+#include "city_registry.h"
 #include "json_reader.h"
 #include "map_renderer.h"
+#include "mapped_file.h"
+#include "partitioned_router.h"
 #include "request_handler.h"
 #include "transport_catalogue.h"
 #include "transport_router.h"
 
-int main()
+// Режимы запуска:
+//   без аргументов    - base_requests и stat_requests из одного документа;
+//   make_base         - строит каталог по base_requests и сохраняет снимок
+//                       в serialization_settings.file;
+//   process_requests  - загружает снимок и отвечает на stat_requests;
+//   process_city_requests
+//                     - отвечает на stat_requests к городам из cities,
+//                       город запроса задает поле city;
+//   process_partitioned_requests
+//                     - как process_requests, но маршруты ищут рабочие
+//                       процессы регионов из partition_settings;
+//   process_store_requests
+//                     - открывает хранилище store_settings.directory:
+//                       последний снимок и хвост журнала, применяет
+//                       пакеты из delta_batches и отвечает на
+//                       stat_requests по опубликованной версии. Если
+//                       пакет не применен, код завершения ненулевой.
+int main(int argc, char* argv[])
 {
-    json_reader::JsonReader reader(std::cin);
+    const std::string_view mode = argc > 1 ? argv[1] : "";
+    if (!mode.empty() && mode != "make_base" &&
+        mode != "process_requests" && mode != "process_city_requests" &&
+        mode != "process_partitioned_requests" &&
+        mode != "process_store_requests") {
+        std::cerr << "Usage: transport_catalogue "
+                     "[make_base|process_requests|process_city_requests|"
+                     "process_partitioned_requests|"
+                     "process_store_requests]\n";
+        return 1;
+    }
 
-    transport_catalogue::TransportCatalogue catalog =
-        reader.ReadTransportCatalogue();
+    // Перенаправленный из файла ввод разбирается прямо в отображенной
+    // памяти, которую читатель использует до конца работы
+    const auto input = mapped_file::MappedFile::FromStandardInput();
+    const json_reader::JsonReader reader =
+        input ? json_reader::JsonReader(input->GetText())
+              : json_reader::JsonReader(std::cin);
 
-    map_renderer::MapRenderer map_renderer(reader.FillRenderSettings());
+    if (mode == "make_base") {
+        catalogue_serialization::SaveCatalogue(
+            reader.ReadTransportCatalogue(), reader.GetSerializationFile());
+        return 0;
+    }
+
+    if (mode == "process_city_requests") {
+        city_registry::CityRegistry registry(reader.GetMemoryBudget());
+        for (auto& [name, settings] : reader.ReadCities()) {
+            registry.AddCity(std::move(name), std::move(settings));
+        }
+        // Город удерживается, пока обрабатывается его запрос
+        std::shared_ptr<const city_registry::City> city;
+        reader.GenerateResponses(
+            [&](const json::Dict& request)
+                -> const request_handler::RequestHandler& {
+                city = registry.Acquire(request.at("city").AsString());
+                return city->handler;
+            },
+            std::cout);
+        return 0;
+    }
+
+    if (mode == "process_partitioned_requests") {
+        // Общий маршрутизатор не строится
+        const auto snapshot =
+            std::make_shared<const catalogue_snapshot::Snapshot>(
+                catalogue_serialization::LoadCatalogue(
+                    reader.GetSerializationFile()),
+                reader.FillRouterSettings(), 1, false);
+        const partitioned_router::PartitionedRouter router(
+            snapshot->catalogue, reader.FillRouterSettings(),
+            reader.GetRegionCount());
+        map_renderer::MapRenderer map_renderer(reader.FillRenderSettings());
+        request_handler::RequestHandler handler(
+            snapshot, map_renderer,
+            [&router](const std::vector<domain::RouteEndpoint>& sources,
+                      const std::vector<domain::RouteEndpoint>& targets) {
+                return router.GetRouteInfo(sources, targets);
+            });
+        reader.GenerateResponses(handler, std::cout);
+        return 0;
+    }
 
-    request_handler::RequestHandler handler(catalog, map_renderer);
+    if (mode == "process_store_requests") {
+        catalogue_store::CatalogueStore store(reader.GetStoreDirectory(),
+                                              reader.FillRouterSettings(),
+                                              reader.GetCompactionThreshold());
+        // Непримененный пакет не меняет хранилище: следующие пакеты
+        // применяются, а запуск завершается с ошибкой
+        int status = 0;
+        const auto batches = reader.ReadDeltaBatches();
+        for (size_t i = 0; i < batches.size(); ++i) {
+            try {
+                store.Apply(batches[i]);
+            } catch (const std::exception& e) {
+                std::cerr << "Delta batch " << i << " is not applied: "
+                          << e.what() << '\n';
+                status = 1;
+            }
+        }
+        map_renderer::MapRenderer map_renderer(reader.FillRenderSettings());
+        request_handler::RequestHandler handler(store.Acquire(),
+                                                map_renderer);
+        reader.GenerateResponses(handler, std::cout);
+        // Ошибка фоновой компакции не должна теряться при выходе
+        store.WaitForCompaction();
+        return status;
+    }
+
+    catalogue_snapshot::SnapshotHolder catalogue(
+        mode == "process_requests"
+            ? catalogue_serialization::LoadCatalogue(
+                  reader.GetSerializationFile())
+            : reader.ReadTransportCatalogue(),
+        reader.FillRouterSettings());
+
+    map_renderer::MapRenderer map_renderer(reader.FillRenderSettings());
 
-    std::istringstream strm(reader.GenerateResponses(handler).data);
+    request_handler::RequestHandler handler(catalogue.Acquire(),
+                                            map_renderer);
 
-    json::Print(json::Load(strm), std::cout);
+    reader.GenerateResponses(handler, std::cout);
 
     return 0;
 }
\ No newline at end of file
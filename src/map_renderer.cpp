@@ -45,7 +45,7 @@ svg::Text MapRenderer::RenderRouteNameSubstrate(std::string_view name,
         static_cast<uint32_t>(render_settings_.bus_label_font_size));
     route_name_substrate.SetFontFamily("Verdana");
     route_name_substrate.SetFontWeight("bold");
-    route_name_substrate.SetData(std::string(name));
+    route_name_substrate.SetDataView(name);
     route_name_substrate.SetFillColor(render_settings_.underlayer_color);
     route_name_substrate.SetStrokeColor(render_settings_.underlayer_color);
     route_name_substrate.SetStrokeWidth(render_settings_.underlayer_width);
@@ -69,7 +69,7 @@ svg::Text MapRenderer::RenderRouteName(std::string_view name,
         static_cast<uint32_t>(render_settings_.bus_label_font_size));
     route_name.SetFontFamily("Verdana");
     route_name.SetFontWeight("bold");
-    route_name.SetData(std::string(name));
+    route_name.SetDataView(name);
     route_name.SetFillColor(
         render_settings_.color_palette[route_counter %
                                        render_settings_.color_palette.size()]);
@@ -100,7 +100,7 @@ svg::Text MapRenderer::RenderStopNameSubstrate(std::string_view name,
     stop_name_substrate.SetFontSize(
         static_cast<uint32_t>(render_settings_.stop_label_font_size));
     stop_name_substrate.SetFontFamily("Verdana");
-    stop_name_substrate.SetData(std::string(name));
+    stop_name_substrate.SetDataView(name);
     stop_name_substrate.SetFillColor(render_settings_.underlayer_color);
     stop_name_substrate.SetStrokeColor(render_settings_.underlayer_color);
     stop_name_substrate.SetStrokeWidth(render_settings_.underlayer_width);
@@ -122,7 +122,7 @@ svg::Text MapRenderer::RenderStopName(std::string_view name,
     stop_name.SetFontSize(
         static_cast<uint32_t>(render_settings_.stop_label_font_size));
     stop_name.SetFontFamily("Verdana");
-    stop_name.SetData(std::string(name));
+    stop_name.SetDataView(name);
     stop_name.SetFillColor("black");
 
     return stop_name;
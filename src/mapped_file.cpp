@@ -0,0 +1,109 @@
+// mapped_file.cpp
+
+#include "mapped_file.h"
+
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace mapped_file {
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::filesystem::path& path)
+{
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+        throw std::runtime_error("Cannot open " + path.string());
+    }
+    std::vector<char> content((std::istreambuf_iterator<char>(input)),
+                              std::istreambuf_iterator<char>());
+    buffer_.resize(content.size());
+    std::memcpy(buffer_.data(), content.data(), content.size());
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+}
+
+MappedFile::~MappedFile() = default;
+
+std::unique_ptr<MappedFile> MappedFile::FromStandardInput()
+{
+    return nullptr;
+}
+
+#else
+
+MappedFile::MappedFile(const std::filesystem::path& path)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + path.string());
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot stat " + path.string());
+    }
+    size_ = static_cast<size_t>(info.st_size);
+    if (size_ > 0) {
+        void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Cannot map " + path.string());
+        }
+        data_ = static_cast<const std::byte*>(data);
+    }
+    ::close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    if (data_ != nullptr) {
+        ::munmap(const_cast<std::byte*>(data_), size_);
+    }
+}
+
+std::unique_ptr<MappedFile> MappedFile::FromStandardInput()
+{
+    // Канал и терминал не отображаются; ввод, из которого уже что-то
+    // прочитано, тоже
+    struct stat info;
+    if (::fstat(STDIN_FILENO, &info) != 0 || !S_ISREG(info.st_mode) ||
+        info.st_size == 0 || ::lseek(STDIN_FILENO, 0, SEEK_CUR) != 0) {
+        return nullptr;
+    }
+    const size_t size = static_cast<size_t>(info.st_size);
+    void* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE,
+                        STDIN_FILENO, 0);
+    if (data == MAP_FAILED) {
+        return nullptr;
+    }
+    std::unique_ptr<MappedFile> file(new MappedFile());
+    file->data_ = static_cast<const std::byte*>(data);
+    file->size_ = size;
+    return file;
+}
+
+#endif
+
+std::span<const std::byte> MappedFile::GetData() const
+{
+    return {data_, size_};
+}
+
+std::string_view MappedFile::GetText() const
+{
+    return {reinterpret_cast<const char*>(data_), size_};
+}
+
+} // namespace mapped_file
\ No newline at end of file
@@ -0,0 +1,42 @@
+// mapped_file.h
+
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace mapped_file {
+
+// Файл, отображенный в память только для чтения
+class MappedFile {
+public:
+    explicit MappedFile(const std::filesystem::path& path);
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    // Стандартный ввод, если он перенаправлен из обычного файла, иначе
+    // nullptr
+    static std::unique_ptr<MappedFile> FromStandardInput();
+
+    std::span<const std::byte> GetData() const;
+
+    // Содержимое файла как текст
+    std::string_view GetText() const;
+
+private:
+    MappedFile() = default;
+
+#ifdef _WIN32
+    // Без POSIX mmap файл читается целиком
+    std::vector<std::byte> buffer_;
+#endif
+    const std::byte* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+} // namespace mapped_file
\ No newline at end of file
@@ -0,0 +1,27 @@
+// name_pool.cpp
+
+#include "name_pool.h"
+
+namespace transport_catalogue {
+
+std::string_view NamePool::Intern(std::string_view name)
+{
+    if (auto it = names_.find(name); it != names_.end()) {
+        return *it;
+    }
+    const std::span<const char> data =
+        arena_.Copy(std::span<const char>(name.data(), name.size()));
+    return *names_.emplace(data.data(), data.size()).first;
+}
+
+void NamePool::Adopt(std::shared_ptr<const void> memory)
+{
+    arena_.Adopt(std::move(memory));
+}
+
+size_t NamePool::Size() const
+{
+    return names_.size();
+}
+
+} // namespace transport_catalogue
\ No newline at end of file
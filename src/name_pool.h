@@ -0,0 +1,37 @@
+// name_pool.h
+
+#pragma once
+
+#include "arena.h"
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <unordered_set>
+
+namespace transport_catalogue {
+
+// Хранилище названий остановок и маршрутов. Каждое название хранится один
+// раз в непрерывных блоках памяти; выданные string_view остаются
+// действительными до уничтожения пула, в том числе после его перемещения.
+class NamePool {
+public:
+    NamePool() = default;
+    NamePool(const NamePool&) = delete;
+    NamePool& operator=(const NamePool&) = delete;
+    NamePool(NamePool&&) = default;
+    NamePool& operator=(NamePool&&) = default;
+
+    std::string_view Intern(std::string_view name);
+
+    // Удерживает внешнюю память, названия из которой используются напрямую
+    void Adopt(std::shared_ptr<const void> memory);
+
+    size_t Size() const;
+
+private:
+    Arena arena_;
+    std::unordered_set<std::string_view> names_;
+};
+
+} // namespace transport_catalogue
\ No newline at end of file
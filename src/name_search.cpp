@@ -0,0 +1,325 @@
+// name_search.cpp
+
+#include "name_search.h"
+
+#include <algorithm>
+#include <numeric>
+#include <span>
+#include <unordered_map>
+#include <utility>
+
+namespace transport_catalogue {
+
+namespace {
+
+// Более коротким запросам соответствует слишком много названий
+constexpr size_t MIN_FUZZY_LENGTH = 3;
+
+// Читает символ UTF-8, начиная с pos. Байт, не образующий корректную
+// последовательность, возвращается как есть.
+char32_t DecodeNext(std::string_view text, size_t& pos)
+{
+    const auto byte = static_cast<unsigned char>(text[pos]);
+    size_t length = 0;
+    char32_t code = 0;
+    if (byte >= 0xC2 && byte < 0xE0) {
+        length = 2;
+        code = byte & 0x1F;
+    } else if (byte >= 0xE0 && byte < 0xF0) {
+        length = 3;
+        code = byte & 0x0F;
+    } else if (byte >= 0xF0 && byte < 0xF5) {
+        length = 4;
+        code = byte & 0x07;
+    }
+    if (length == 0 || pos + length > text.size()) {
+        ++pos;
+        return byte;
+    }
+    for (size_t i = 1; i < length; ++i) {
+        const auto next = static_cast<unsigned char>(text[pos + i]);
+        if ((next & 0xC0) != 0x80) {
+            ++pos;
+            return byte;
+        }
+        code = (code << 6) | (next & 0x3F);
+    }
+    pos += length;
+    return code;
+}
+
+void Encode(char32_t code, std::string& out)
+{
+    if (code < 0x80) {
+        out.push_back(static_cast<char>(code));
+    } else if (code < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+        out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    } else if (code < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (code >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    }
+}
+
+char32_t ToLower(char32_t code)
+{
+    if (code >= U'A' && code <= U'Z') {
+        return code + 0x20;
+    }
+    if (code >= U'А' && code <= U'Я') {
+        return code + 0x20;
+    }
+    if (code >= U'Ѐ' && code <= U'Џ') {
+        code += 0x50;
+    }
+    return code == U'ё' ? U'е' : code;
+}
+
+// Различные триграммы нормализованного названия. Перед названием
+// добавляются два пробела, чтобы учитывать и начало слова; после
+// названия - пробел, если with_end, иначе запрос считается незаконченным.
+std::vector<uint64_t> GetTrigrams(std::string_view key, bool with_end)
+{
+    std::vector<uint64_t> trigrams;
+    trigrams.reserve(key.size() + 1);
+    uint64_t window = (uint64_t{U' '} << 21) | U' ';
+    const auto push = [&](char32_t code) {
+        window = ((window << 21) | code) & ((uint64_t{1} << 63) - 1);
+        trigrams.push_back(window);
+    };
+    for (size_t pos = 0; pos < key.size();) {
+        push(DecodeNext(key, pos));
+    }
+    if (with_end) {
+        push(U' ');
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()),
+                   trigrams.end());
+    return trigrams;
+}
+
+size_t CountCodes(std::string_view key)
+{
+    size_t count = 0;
+    for (size_t pos = 0; pos < key.size(); ++count) {
+        DecodeNext(key, pos);
+    }
+    return count;
+}
+
+} // namespace
+
+std::string NormalizeName(std::string_view name)
+{
+    std::string result;
+    result.reserve(name.size());
+    for (size_t pos = 0; pos < name.size();) {
+        const size_t start = pos;
+        const char32_t code = DecodeNext(name, pos);
+        if (pos - start == 1 && code >= 0x80) {
+            // Некорректный байт UTF-8 копируется без изменений
+            result.push_back(name[start]);
+        } else {
+            Encode(ToLower(code), result);
+        }
+    }
+    return result;
+}
+
+void NameSearchIndex::Build(const std::vector<std::string_view>& names)
+{
+    *this = NameSearchIndex();
+    if (names.empty()) {
+        return;
+    }
+
+    key_offsets_.reserve(names.size() + 1);
+    key_offsets_.push_back(0);
+    for (std::string_view name : names) {
+        keys_ += NormalizeName(name);
+        key_offsets_.push_back(static_cast<uint32_t>(keys_.size()));
+    }
+
+    order_.resize(names.size());
+    std::iota(order_.begin(), order_.end(), 0);
+    std::stable_sort(order_.begin(), order_.end(),
+                     [this](uint32_t lhs, uint32_t rhs) {
+                         return GetKey(lhs) < GetKey(rhs);
+                     });
+
+    // Триграммам назначаются номера в порядке появления, затем списки
+    // названий раскладываются подсчетом: названия перебираются по
+    // возрастанию id, поэтому списки сразу упорядочены
+    std::unordered_map<uint64_t, uint32_t> trigram_ids;
+    std::vector<uint32_t> name_trigrams;
+    std::vector<uint32_t> name_offsets{0};
+    name_offsets.reserve(names.size() + 1);
+    trigram_counts_.reserve(names.size());
+    for (uint32_t id = 0; id < names.size(); ++id) {
+        const std::vector<uint64_t> trigrams = GetTrigrams(GetKey(id), true);
+        trigram_counts_.push_back(static_cast<uint16_t>(
+            std::min<size_t>(trigrams.size(), UINT16_MAX)));
+        for (uint64_t trigram : trigrams) {
+            const auto [it, inserted] = trigram_ids.emplace(
+                trigram, static_cast<uint32_t>(trigram_ids.size()));
+            name_trigrams.push_back(it->second);
+        }
+        name_offsets.push_back(static_cast<uint32_t>(name_trigrams.size()));
+    }
+
+    // Номер триграммы -> ее позиция в упорядоченном trigrams_
+    std::vector<std::pair<uint64_t, uint32_t>> sorted(trigram_ids.begin(),
+                                                      trigram_ids.end());
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<uint32_t> rank(sorted.size());
+    trigrams_.reserve(sorted.size());
+    for (const auto& [trigram, trigram_id] : sorted) {
+        rank[trigram_id] = static_cast<uint32_t>(trigrams_.size());
+        trigrams_.push_back(trigram);
+    }
+
+    posting_offsets_.assign(trigrams_.size() + 1, 0);
+    for (uint32_t trigram_id : name_trigrams) {
+        ++posting_offsets_[rank[trigram_id] + 1];
+    }
+    for (size_t i = 1; i < posting_offsets_.size(); ++i) {
+        posting_offsets_[i] += posting_offsets_[i - 1];
+    }
+    postings_.resize(name_trigrams.size());
+    std::vector<uint32_t> next(posting_offsets_.begin(),
+                               posting_offsets_.end() - 1);
+    for (uint32_t id = 0; id < names.size(); ++id) {
+        for (uint32_t i = name_offsets[id]; i < name_offsets[id + 1]; ++i) {
+            postings_[next[rank[name_trigrams[i]]]++] = id;
+        }
+    }
+}
+
+std::vector<uint32_t> NameSearchIndex::Find(std::string_view query,
+                                            size_t limit) const
+{
+    std::vector<uint32_t> result;
+    const std::string key = NormalizeName(query);
+    if (key.empty() || limit == 0) {
+        return result;
+    }
+    FindPrefix(key, limit, result);
+    if (result.size() < limit && CountCodes(key) >= MIN_FUZZY_LENGTH) {
+        FindSimilar(key, limit, result);
+    }
+    return result;
+}
+
+size_t NameSearchIndex::Size() const
+{
+    return order_.size();
+}
+
+std::string_view NameSearchIndex::GetKey(uint32_t id) const
+{
+    return std::string_view(keys_).substr(
+        key_offsets_[id], key_offsets_[id + 1] - key_offsets_[id]);
+}
+
+void NameSearchIndex::FindPrefix(std::string_view prefix, size_t limit,
+                                 std::vector<uint32_t>& result) const
+{
+    auto it = std::lower_bound(order_.begin(), order_.end(), prefix,
+                               [this](uint32_t id, std::string_view value) {
+                                   return GetKey(id) < value;
+                               });
+    for (; it != order_.end() && result.size() < limit &&
+           GetKey(*it).starts_with(prefix);
+         ++it) {
+        result.push_back(*it);
+    }
+}
+
+// Счетчики общих триграмм; ненулевые только у candidates
+struct NameSearchIndex::SimilarityScratch {
+    std::vector<uint16_t> counts;
+    std::vector<uint32_t> candidates;
+};
+
+void NameSearchIndex::FindSimilar(std::string_view query, size_t limit,
+                                  std::vector<uint32_t>& result) const
+{
+    const std::vector<uint64_t> trigrams = GetTrigrams(query, false);
+    std::vector<std::span<const uint32_t>> lists;
+    for (uint64_t trigram : trigrams) {
+        const auto it =
+            std::lower_bound(trigrams_.begin(), trigrams_.end(), trigram);
+        if (it != trigrams_.end() && *it == trigram) {
+            const size_t i = static_cast<size_t>(it - trigrams_.begin());
+            lists.push_back(std::span(postings_).subspan(
+                posting_offsets_[i],
+                posting_offsets_[i + 1] - posting_offsets_[i]));
+        }
+    }
+
+    // Совпадать должна хотя бы половина триграмм запроса. Общие триграммы
+    // подсчитываются в массиве по всем названиям: это дешевле сортировки
+    // кандидатов и слияния списков, когда в запросе есть частые триграммы.
+    // Массив у потока один на все запросы и индексы, и перед подсчетом
+    // обнуляются только счетчики кандидатов прошлого запроса.
+    const size_t required = (trigrams.size() + 1) / 2;
+    if (lists.size() < required) {
+        return;
+    }
+    thread_local SimilarityScratch scratch;
+    std::vector<uint16_t>& counts = scratch.counts;
+    std::vector<uint32_t>& candidates = scratch.candidates;
+    for (uint32_t id : candidates) {
+        counts[id] = 0;
+    }
+    candidates.clear();
+    if (counts.size() < Size()) {
+        counts.resize(Size(), 0);
+    }
+    for (const std::span<const uint32_t> list : lists) {
+        for (uint32_t id : list) {
+            if (counts[id]++ == 0) {
+                candidates.push_back(id);
+            }
+        }
+    }
+
+    struct Match {
+        uint32_t id;
+        size_t common;
+    };
+    std::vector<Match> matches;
+    for (uint32_t id : candidates) {
+        if (counts[id] >= required &&
+            std::find(result.begin(), result.end(), id) == result.end()) {
+            matches.push_back({id, counts[id]});
+        }
+    }
+
+    // Больше общих триграмм, затем короче название
+    const size_t count = std::min(limit - result.size(), matches.size());
+    std::partial_sort(
+        matches.begin(), matches.begin() + count, matches.end(),
+        [this](const Match& lhs, const Match& rhs) {
+            if (lhs.common != rhs.common) {
+                return lhs.common > rhs.common;
+            }
+            if (trigram_counts_[lhs.id] != trigram_counts_[rhs.id]) {
+                return trigram_counts_[lhs.id] < trigram_counts_[rhs.id];
+            }
+            return std::pair(GetKey(lhs.id), lhs.id) <
+                   std::pair(GetKey(rhs.id), rhs.id);
+        });
+    for (size_t i = 0; i < count; ++i) {
+        result.push_back(matches[i].id);
+    }
+}
+
+} // namespace transport_catalogue
\ No newline at end of file
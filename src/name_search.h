@@ -0,0 +1,57 @@
+// name_search.h
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace transport_catalogue {
+
+// Приводит название к виду для поиска: латиница и кириллица переводятся
+// в нижний регистр, ё заменяется на е, остальные символы не меняются
+std::string NormalizeName(std::string_view name);
+
+// Поисковый индекс по названиям, идентификатор названия - его позиция
+// при построении. Нормализованные названия хранятся одной строкой в
+// лексикографическом порядке, поэтому названия с заданным префиксом
+// образуют непрерывный диапазон. Для поиска с опечатками построены
+// списки названий по триграммам символов.
+class NameSearchIndex {
+public:
+    void Build(const std::vector<std::string_view>& names);
+
+    // До limit идентификаторов: сначала названия, начинающиеся с query,
+    // в лексикографическом порядке, затем похожие на query по триграммам,
+    // по убыванию сходства
+    std::vector<uint32_t> Find(std::string_view query, size_t limit) const;
+
+    size_t Size() const;
+
+private:
+    // Нормализованное название i - keys_[key_offsets_[i],
+    // key_offsets_[i + 1])
+    std::string keys_;
+    std::vector<uint32_t> key_offsets_;
+    // Позиции названий в лексикографическом порядке ключей
+    std::vector<uint32_t> order_;
+    // Названия с триграммой trigrams_[i] -
+    // postings_[posting_offsets_[i], posting_offsets_[i + 1])
+    std::vector<uint64_t> trigrams_;
+    std::vector<uint32_t> posting_offsets_;
+    std::vector<uint32_t> postings_;
+    // Число различных триграмм названия
+    std::vector<uint16_t> trigram_counts_;
+
+    std::string_view GetKey(uint32_t id) const;
+    void FindPrefix(std::string_view prefix, size_t limit,
+                    std::vector<uint32_t>& result) const;
+
+    struct SimilarityScratch;
+    void FindSimilar(std::string_view query, size_t limit,
+                     std::vector<uint32_t>& result) const;
+};
+
+} // namespace transport_catalogue
\ No newline at end of file
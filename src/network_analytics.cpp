@@ -0,0 +1,311 @@
+// network_analytics.cpp
+
+#include "network_analytics.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#include <queue>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace network_analytics {
+
+namespace {
+
+constexpr uint32_t NO_STOP = std::numeric_limits<uint32_t>::max();
+constexpr double INF = std::numeric_limits<double>::infinity();
+// Пути, времена которых совпадают с точностью до ошибки округления,
+// считаются одинаково короткими: одно и то же время, сложенное из ребер в
+// разном порядке, может отличаться в последних знаках
+constexpr double TIE_TOLERANCE = 1e-9;
+// Число источников в части, которую считает один поток
+constexpr size_t SOURCES_PER_CHUNK = 16;
+
+bool IsTie(double lhs, double rhs)
+{
+    return std::abs(lhs - rhs) <= TIE_TOLERANCE * std::max(1.0, rhs);
+}
+
+// Граф в плоских массивах: ребра вершины v - с offsets[v] по
+// offsets[v + 1]
+struct FlatGraph {
+    std::vector<size_t> offsets;
+    std::vector<graph::VertexId> targets;
+    std::vector<double> weights;
+    // Остановка, для которой вершина - начало ожидания, или NO_STOP
+    std::vector<uint32_t> vertex_stops;
+};
+
+FlatGraph Flatten(const router::TransportRouter& router, size_t stops_count)
+{
+    const graph::DirectedWeightedGraph<double>& graph = *router.GetGraph();
+    const size_t vertex_count = graph.GetVertexCount();
+    FlatGraph result;
+    result.offsets.reserve(vertex_count + 1);
+    result.targets.reserve(graph.GetEdgeCount());
+    result.weights.reserve(graph.GetEdgeCount());
+    result.offsets.push_back(0);
+    for (graph::VertexId v = 0; v < vertex_count; ++v) {
+        for (const graph::EdgeId edge_id : graph.GetIncidentEdges(v)) {
+            const graph::Edge<double>& edge = graph.GetEdge(edge_id);
+            result.targets.push_back(edge.to);
+            result.weights.push_back(edge.weight);
+        }
+        result.offsets.push_back(result.targets.size());
+    }
+    result.vertex_stops.assign(vertex_count, NO_STOP);
+    for (domain::StopId stop_id = 0; stop_id < stops_count; ++stop_id) {
+        result.vertex_stops[router.GetVertexIdByStop(stop_id)
+                                ->bus_wait_start] =
+            static_cast<uint32_t>(stop_id);
+    }
+    return result;
+}
+
+// Суммы одного потока (индекс - id остановки)
+struct Accumulator {
+    std::vector<double> betweenness;
+    std::vector<double> distance_sums;
+    std::vector<size_t> reached_from;
+};
+
+class SourceSearch {
+public:
+    SourceSearch(const FlatGraph& graph, Accumulator& accumulator)
+        : graph_(graph)
+        , accumulator_(accumulator)
+        , distances_(graph.vertex_stops.size(), INF)
+        , path_counts_(graph.vertex_stops.size(), 0)
+        , dependencies_(graph.vertex_stops.size(), 0)
+    {
+    }
+
+    void Run(graph::VertexId source)
+    {
+        FindPaths(source);
+        Accumulate(source);
+        for (const graph::VertexId v : order_) {
+            distances_[v] = INF;
+            path_counts_[v] = 0;
+            dependencies_[v] = 0;
+        }
+        order_.clear();
+    }
+
+private:
+    using QueueItem = std::pair<double, graph::VertexId>;
+
+    const FlatGraph& graph_;
+    Accumulator& accumulator_;
+    std::vector<double> distances_;
+    // Число кратчайших путей до вершины
+    std::vector<double> path_counts_;
+    std::vector<double> dependencies_;
+    // Вершины в порядке удаления из очереди
+    std::vector<graph::VertexId> order_;
+    std::priority_queue<QueueItem, std::vector<QueueItem>,
+                        std::greater<QueueItem>>
+        queue_;
+
+    void FindPaths(graph::VertexId source)
+    {
+        distances_[source] = 0;
+        path_counts_[source] = 1;
+        queue_.push({0, source});
+        while (!queue_.empty()) {
+            const auto [distance, v] = queue_.top();
+            queue_.pop();
+            if (distance > distances_[v]) {
+                continue;
+            }
+            order_.push_back(v);
+            for (size_t i = graph_.offsets[v]; i < graph_.offsets[v + 1];
+                 ++i) {
+                const graph::VertexId w = graph_.targets[i];
+                const double candidate = distance + graph_.weights[i];
+                if (distances_[w] != INF &&
+                    IsTie(candidate, distances_[w])) {
+                    path_counts_[w] += path_counts_[v];
+                } else if (candidate < distances_[w]) {
+                    distances_[w] = candidate;
+                    path_counts_[w] = path_counts_[v];
+                    queue_.push({candidate, w});
+                }
+            }
+        }
+    }
+
+    // Обратный проход Брандеса. Ребро лежит на кратчайшем пути, если
+    // расстояние до его конца равно расстоянию до начала плюс вес, поэтому
+    // списки предшественников не нужны.
+    void Accumulate(graph::VertexId source)
+    {
+        for (auto it = order_.rbegin(); it != order_.rend(); ++it) {
+            const graph::VertexId v = *it;
+            double dependency = 0;
+            for (size_t i = graph_.offsets[v]; i < graph_.offsets[v + 1];
+                 ++i) {
+                const graph::VertexId w = graph_.targets[i];
+                if (!IsTie(distances_[v] + graph_.weights[i],
+                           distances_[w])) {
+                    continue;
+                }
+                const bool is_target =
+                    graph_.vertex_stops[w] != NO_STOP && w != source;
+                dependency += path_counts_[v] / path_counts_[w] *
+                              ((is_target ? 1 : 0) + dependencies_[w]);
+            }
+            dependencies_[v] = dependency;
+
+            const uint32_t stop = graph_.vertex_stops[v];
+            if (stop != NO_STOP && v != source) {
+                accumulator_.betweenness[stop] += dependency;
+                accumulator_.distance_sums[stop] += distances_[v];
+                ++accumulator_.reached_from[stop];
+            }
+        }
+    }
+};
+
+} // namespace
+
+std::vector<StopCentrality> ComputeCentrality(
+    const router::TransportRouter& router, size_t stops_count,
+    const AnalyticsSettings& settings)
+{
+    if (settings.pivots == 0) {
+        throw std::invalid_argument("Number of pivots must be positive");
+    }
+    if (!router.GetGraph() || stops_count == 0) {
+        return {};
+    }
+    const FlatGraph graph = Flatten(router, stops_count);
+
+    std::vector<domain::StopId> sources(stops_count);
+    std::iota(sources.begin(), sources.end(), domain::StopId{0});
+    if (settings.pivots && *settings.pivots < stops_count) {
+        std::vector<domain::StopId> pivots;
+        pivots.reserve(*settings.pivots);
+        std::sample(sources.begin(), sources.end(),
+                    std::back_inserter(pivots), *settings.pivots,
+                    std::mt19937_64(settings.seed));
+        sources = std::move(pivots);
+    }
+
+    // Источники делятся на части постоянного размера, не зависящего от
+    // числа потоков, и суммы частей складываются по порядку частей, поэтому
+    // результат одинаков на любой машине. Потоки берут части по очереди;
+    // поток, досчитавший часть, ждет, пока сложатся предыдущие.
+    const size_t chunks_count =
+        (sources.size() + SOURCES_PER_CHUNK - 1) / SOURCES_PER_CHUNK;
+    const size_t threads = std::min<size_t>(
+        chunks_count, std::max(1u, std::thread::hardware_concurrency()));
+    const auto make_accumulator = [stops_count] {
+        return Accumulator{std::vector<double>(stops_count, 0),
+                           std::vector<double>(stops_count, 0),
+                           std::vector<size_t>(stops_count, 0)};
+    };
+
+    Accumulator total = make_accumulator();
+    std::atomic<size_t> next_chunk = 0;
+    std::mutex total_mutex;
+    std::condition_variable total_changed;
+    size_t next_to_add = 0;
+    // Поток, завершившийся с ошибкой, не сложит свою часть: остальные не
+    // должны ждать её
+    bool is_failed = false;
+
+    const auto run_chunks = [&] {
+        Accumulator accumulator = make_accumulator();
+        SourceSearch search(graph, accumulator);
+        for (size_t chunk = next_chunk++; chunk < chunks_count;
+             chunk = next_chunk++) {
+            const size_t begin = chunk * SOURCES_PER_CHUNK;
+            const size_t end =
+                std::min(sources.size(), begin + SOURCES_PER_CHUNK);
+            for (size_t i = begin; i < end; ++i) {
+                search.Run(
+                    router.GetVertexIdByStop(sources[i])->bus_wait_start);
+            }
+
+            std::unique_lock lock(total_mutex);
+            total_changed.wait(lock, [&] {
+                return is_failed || next_to_add == chunk;
+            });
+            if (is_failed) {
+                return;
+            }
+            for (size_t i = 0; i < stops_count; ++i) {
+                total.betweenness[i] += accumulator.betweenness[i];
+                total.distance_sums[i] += accumulator.distance_sums[i];
+                total.reached_from[i] += accumulator.reached_from[i];
+            }
+            ++next_to_add;
+            lock.unlock();
+            total_changed.notify_all();
+
+            std::fill(accumulator.betweenness.begin(),
+                      accumulator.betweenness.end(), 0);
+            std::fill(accumulator.distance_sums.begin(),
+                      accumulator.distance_sums.end(), 0);
+            std::fill(accumulator.reached_from.begin(),
+                      accumulator.reached_from.end(), 0);
+        }
+    };
+
+    std::vector<std::future<void>> workers;
+    for (size_t i = 0; i < threads; ++i) {
+        workers.push_back(std::async(std::launch::async, [&] {
+            try {
+                run_chunks();
+            } catch (...) {
+                {
+                    std::lock_guard guard(total_mutex);
+                    is_failed = true;
+                }
+                total_changed.notify_all();
+                throw;
+            }
+        }));
+    }
+    for (auto& worker : workers) {
+        worker.get();
+    }
+
+    std::vector<bool> is_source(stops_count, false);
+    for (const domain::StopId stop_id : sources) {
+        is_source[stop_id] = true;
+    }
+    const double scale = static_cast<double>(stops_count) /
+                         static_cast<double>(sources.size());
+    std::vector<StopCentrality> result;
+    result.reserve(stops_count);
+    for (domain::StopId stop_id = 0; stop_id < stops_count; ++stop_id) {
+        StopCentrality centrality{stop_id};
+        centrality.betweenness = total.betweenness[stop_id] * scale;
+        // Доля достигших остановки источников среди остальных источников
+        // на величину, обратную среднему времени пути от них
+        const size_t other_sources =
+            sources.size() - (is_source[stop_id] ? 1 : 0);
+        const double reached =
+            static_cast<double>(total.reached_from[stop_id]);
+        if (reached > 0 && total.distance_sums[stop_id] > 0) {
+            centrality.closeness = reached /
+                                   static_cast<double>(other_sources) *
+                                   reached / total.distance_sums[stop_id];
+        }
+        result.push_back(centrality);
+    }
+    return result;
+}
+
+} // namespace network_analytics
\ No newline at end of file
@@ -0,0 +1,44 @@
+// network_analytics.h
+
+#pragma once
+
+#include "domain.h"
+#include "transport_router.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace network_analytics {
+
+struct AnalyticsSettings {
+    // Число опорных остановок для приближенного подсчета; без него
+    // кратчайшие пути ищутся из каждой остановки
+    std::optional<size_t> pivots;
+    // Зерно выбора опорных остановок
+    uint64_t seed = 0;
+};
+
+struct StopCentrality {
+    domain::StopId stop_id;
+    // Сумма по парам остановок доли кратчайших путей между ними, на
+    // которых остановка промежуточная (пересадка или проход пешком)
+    double betweenness = 0;
+    // Доля остановок, из которых достижима остановка, деленная на среднее
+    // время пути до нее в минутах; 0, если она недостижима
+    double closeness = 0;
+};
+
+// Центральность остановок в графе маршрутизатора по алгоритму Брандеса.
+// Кратчайшие пути из разных остановок ищут несколько потоков, каждый
+// копит свои суммы, которые затем складываются. При заданном числе
+// опорных остановок пути ищутся только из них, а посредничество
+// умножается на отношение числа остановок к числу опорных. Индекс
+// результата - id остановки; без графа маршрутизатора результат пуст.
+// Нулевое число опорных остановок - std::invalid_argument.
+std::vector<StopCentrality> ComputeCentrality(
+    const router::TransportRouter& router, size_t stops_count,
+    const AnalyticsSettings& settings);
+
+} // namespace network_analytics
\ No newline at end of file
@@ -0,0 +1,911 @@
+// partitioned_router.cpp
+
+#include "partitioned_router.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace partitioned_router {
+
+namespace {
+
+// Время проезда, если пути нет
+constexpr double NO_PATH = -1.0;
+
+enum class RequestType : uint8_t {
+    WEIGHTS, // времена проезда между двумя списками вершин
+    ROUTE,   // ребра кратчайшего пути между двумя вершинами
+};
+
+enum class ItemType : uint8_t {
+    STOP,
+    BUS,
+    WALK,
+};
+
+// Сообщения между координатором и рабочими процессами: длина в четырех
+// байтах и значения в представлении машины, оба процесса на одной машине
+class MessageWriter {
+public:
+    template <typename T>
+    void Put(T value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        data_.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    const std::string& GetData() const
+    {
+        return data_;
+    }
+
+private:
+    std::string data_;
+};
+
+class MessageReader {
+public:
+    explicit MessageReader(std::string_view data)
+        : data_(data)
+    {
+    }
+
+    template <typename T>
+    T Get()
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (data_.size() < sizeof(T)) {
+            throw std::runtime_error("Truncated region worker message");
+        }
+        T value;
+        std::memcpy(&value, data_.data(), sizeof(value));
+        data_.remove_prefix(sizeof(value));
+        return value;
+    }
+
+private:
+    std::string_view data_;
+};
+
+void WriteAll(int fd, const char* data, size_t size)
+{
+    while (size > 0) {
+        const ssize_t written = ::send(fd, data, size, MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("Cannot write to region worker");
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+}
+
+// false, если сокет закрыт до первого байта
+bool ReadAll(int fd, char* data, size_t size)
+{
+    size_t total = 0;
+    while (total < size) {
+        const ssize_t got = ::read(fd, data + total, size - total);
+        if (got < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("Cannot read from region worker");
+        }
+        if (got == 0) {
+            if (total == 0) {
+                return false;
+            }
+            throw std::runtime_error("Truncated region worker message");
+        }
+        total += static_cast<size_t>(got);
+    }
+    return true;
+}
+
+void SendMessage(int fd, const std::string& message)
+{
+    const uint32_t size = static_cast<uint32_t>(message.size());
+    std::string packet(reinterpret_cast<const char*>(&size), sizeof(size));
+    packet += message;
+    WriteAll(fd, packet.data(), packet.size());
+}
+
+std::optional<std::string> ReceiveMessage(int fd)
+{
+    uint32_t size = 0;
+    if (!ReadAll(fd, reinterpret_cast<char*>(&size), sizeof(size))) {
+        return std::nullopt;
+    }
+    std::string message(size, '\0');
+    if (size > 0 && !ReadAll(fd, message.data(), size)) {
+        throw std::runtime_error("Truncated region worker message");
+    }
+    return message;
+}
+
+std::string MakeWeightsRequest(std::span<const graph::VertexId> from,
+                               std::span<const graph::VertexId> to)
+{
+    MessageWriter request;
+    request.Put(RequestType::WEIGHTS);
+    for (const auto vertices : {from, to}) {
+        request.Put(static_cast<uint32_t>(vertices.size()));
+        for (const graph::VertexId vertex : vertices) {
+            request.Put(static_cast<uint32_t>(vertex));
+        }
+    }
+    return request.GetData();
+}
+
+std::string MakeRouteRequest(graph::VertexId from, graph::VertexId to)
+{
+    MessageWriter request;
+    request.Put(RequestType::ROUTE);
+    request.Put(static_cast<uint32_t>(from));
+    request.Put(static_cast<uint32_t>(to));
+    return request.GetData();
+}
+
+// Таблица времен проезда из ответа на WEIGHTS: строки - вершины from,
+// столбцы - вершины to
+struct WeightTable {
+    size_t columns = 0;
+    std::vector<double> weights;
+
+    double Get(size_t row, size_t column) const
+    {
+        return weights[row * columns + column];
+    }
+};
+
+WeightTable ReadWeights(const std::string& message, size_t rows,
+                        size_t columns)
+{
+    MessageReader reader(message);
+    WeightTable table{columns, std::vector<double>(rows * columns)};
+    for (double& weight : table.weights) {
+        weight = reader.Get<double>();
+    }
+    return table;
+}
+
+std::string HandleRequest(const router::TransportRouter& router,
+                          std::string_view message)
+{
+    MessageReader request(message);
+    MessageWriter response;
+    if (request.Get<RequestType>() == RequestType::WEIGHTS) {
+        std::vector<graph::VertexId> lists[2];
+        for (auto& vertices : lists) {
+            vertices.resize(request.Get<uint32_t>());
+            for (graph::VertexId& vertex : vertices) {
+                vertex = request.Get<uint32_t>();
+            }
+        }
+        for (const graph::VertexId from : lists[0]) {
+            for (const graph::VertexId to : lists[1]) {
+                response.Put(router.GetWeight(from, to).value_or(NO_PATH));
+            }
+        }
+        return response.GetData();
+    }
+
+    const graph::VertexId from = request.Get<uint32_t>();
+    const graph::VertexId to = request.Get<uint32_t>();
+    const std::optional<domain::RouteInfo> route =
+        router.GetRouteInfo(from, to);
+    if (!route) {
+        throw std::logic_error("Region route not found");
+    }
+    response.Put(static_cast<uint32_t>(route->edges.size()));
+    for (const domain::RouteItem& item : route->edges) {
+        if (const auto* stop = std::get_if<domain::StopEdge>(&item)) {
+            response.Put(ItemType::STOP);
+            response.Put(stop->stop_id);
+            response.Put(stop->time);
+        } else if (const auto* bus = std::get_if<domain::BusEdge>(&item)) {
+            response.Put(ItemType::BUS);
+            response.Put(bus->route_id);
+            response.Put(static_cast<uint64_t>(bus->span_count));
+            response.Put(bus->time);
+        } else {
+            const auto& walk = std::get<domain::WalkEdge>(item);
+            response.Put(ItemType::WALK);
+            response.Put(walk.from.value());
+            response.Put(walk.to.value());
+            response.Put(walk.time);
+        }
+    }
+    return response.GetData();
+}
+
+// Делит stops на count регионов с номерами от first_region
+void Bisect(const std::vector<domain::Stop>& all_stops,
+            std::span<domain::StopId> stops, uint32_t first_region,
+            size_t count, std::vector<uint32_t>& regions)
+{
+    if (count == 1 || stops.size() <= 1) {
+        for (const domain::StopId stop_id : stops) {
+            regions[stop_id] = first_region;
+        }
+        return;
+    }
+
+    geo::Coordinates min = all_stops[stops.front()].coordinates;
+    geo::Coordinates max = min;
+    for (const domain::StopId stop_id : stops) {
+        const geo::Coordinates& point = all_stops[stop_id].coordinates;
+        min.lat = std::min(min.lat, point.lat);
+        min.lng = std::min(min.lng, point.lng);
+        max.lat = std::max(max.lat, point.lat);
+        max.lng = std::max(max.lng, point.lng);
+    }
+    const double lng_scale =
+        std::cos((min.lat + max.lat) / 2 * M_PI / 180.0);
+    const bool by_lat = max.lat - min.lat >= (max.lng - min.lng) * lng_scale;
+
+    // Регионы делятся пополам, остановки - в той же пропорции
+    const size_t left_count = count / 2;
+    const size_t middle = stops.size() * left_count / count;
+    const auto key = [&](domain::StopId stop_id) {
+        const geo::Coordinates& point = all_stops[stop_id].coordinates;
+        return std::pair(by_lat ? point.lat : point.lng, stop_id);
+    };
+    std::nth_element(stops.begin(), stops.begin() + middle, stops.end(),
+                     [&](domain::StopId lhs, domain::StopId rhs) {
+                         return key(lhs) < key(rhs);
+                     });
+    Bisect(all_stops, stops.first(middle), first_region, left_count,
+           regions);
+    Bisect(all_stops, stops.subspan(middle),
+           first_region + static_cast<uint32_t>(left_count),
+           count - left_count, regions);
+}
+
+} // namespace
+
+std::vector<uint32_t> AssignRegions(
+    const transport_catalogue::TransportCatalogue& catalogue,
+    size_t region_count)
+{
+    if (region_count == 0) {
+        throw std::invalid_argument("Region count must be positive");
+    }
+    const std::vector<domain::Stop>& stops = catalogue.GetStops();
+    std::vector<domain::StopId> order(stops.size());
+    std::iota(order.begin(), order.end(), domain::StopId{0});
+    std::vector<uint32_t> regions(stops.size(), 0);
+    Bisect(stops, order, 0, region_count, regions);
+    return regions;
+}
+
+PartitionedRouter::PartitionedRouter(
+    const transport_catalogue::TransportCatalogue& catalogue,
+    domain::RouterSettings router_settings, size_t region_count)
+    : router_settings_(router_settings)
+    , stop_regions_(AssignRegions(catalogue, region_count))
+    , regions_(region_count)
+{
+    Partition(catalogue);
+    AddWalkLinks(catalogue);
+    try {
+        StartWorkers(catalogue);
+        BuildOverlay();
+    } catch (...) {
+        StopWorkers();
+        throw;
+    }
+}
+
+PartitionedRouter::~PartitionedRouter()
+{
+    StopWorkers();
+}
+
+std::optional<domain::RouteInfo> PartitionedRouter::GetRouteInfo(
+    const std::vector<domain::RouteEndpoint>& sources,
+    const std::vector<domain::RouteEndpoint>& targets) const
+{
+    std::lock_guard lock(mutex_);
+    if (is_broken_) {
+        throw std::runtime_error("Region workers failed earlier");
+    }
+    // Прерванный обмен оставляет в сокетах непрочитанные ответы, которые
+    // следующий запрос принял бы за свои
+    try {
+        return FindRoute(sources, targets);
+    } catch (...) {
+        is_broken_ = true;
+        throw;
+    }
+}
+
+std::optional<domain::RouteInfo> PartitionedRouter::FindRoute(
+    const std::vector<domain::RouteEndpoint>& sources,
+    const std::vector<domain::RouteEndpoint>& targets) const
+{
+    // Начала и концы по регионам. Регион начала считает времена от начал
+    // до своих выходов и до концов в нем, регион конца - от своих входов
+    // до концов.
+    struct RegionQuery {
+        std::vector<size_t> sources;
+        std::vector<size_t> targets;
+        std::vector<graph::VertexId> source_vertices;
+        std::vector<graph::VertexId> target_vertices;
+        WeightTable from_sources;
+        WeightTable to_targets;
+    };
+    std::vector<RegionQuery> queries(regions_.size());
+    for (size_t i = 0; i < sources.size(); ++i) {
+        const domain::StopId stop_id = sources[i].stop_id;
+        RegionQuery& query = queries[stop_regions_[stop_id]];
+        query.sources.push_back(i);
+        query.source_vertices.push_back(2 * local_stops_[stop_id]);
+    }
+    for (size_t i = 0; i < targets.size(); ++i) {
+        const domain::StopId stop_id = targets[i].stop_id;
+        RegionQuery& query = queries[stop_regions_[stop_id]];
+        query.targets.push_back(i);
+        query.target_vertices.push_back(2 * local_stops_[stop_id]);
+    }
+
+    // Запросы уходят всем регионам сразу, регионы считают параллельно
+    for (uint32_t region_id = 0; region_id < regions_.size(); ++region_id) {
+        RegionQuery& query = queries[region_id];
+        const Region& region = regions_[region_id];
+        if (!query.sources.empty()) {
+            std::vector<graph::VertexId> columns = region.exits;
+            columns.insert(columns.end(), query.target_vertices.begin(),
+                           query.target_vertices.end());
+            Send(region_id, MakeWeightsRequest(query.source_vertices, columns));
+        }
+        if (!query.targets.empty()) {
+            Send(region_id,
+                 MakeWeightsRequest(region.entries, query.target_vertices));
+        }
+    }
+    for (uint32_t region_id = 0; region_id < regions_.size(); ++region_id) {
+        RegionQuery& query = queries[region_id];
+        const Region& region = regions_[region_id];
+        if (!query.sources.empty()) {
+            query.from_sources =
+                ReadWeights(Receive(region_id), query.sources.size(),
+                            region.exits.size() + query.targets.size());
+        }
+        if (!query.targets.empty()) {
+            query.to_targets =
+                ReadWeights(Receive(region_id), region.entries.size(),
+                            query.targets.size());
+        }
+    }
+
+    // Узел, из которого пришли в вершину: NONE - из начала маршрута
+    struct Step {
+        uint32_t from_node = NONE;
+        size_t index = 0; // ребро from_node или номер начала
+    };
+    // Конец маршрута: из узла-входа или, если node == NONE, прямо из
+    // начала в том же регионе
+    struct Finish {
+        uint32_t node = NONE;
+        size_t source = 0;
+        size_t target = 0;
+    };
+
+    constexpr double INF = std::numeric_limits<double>::infinity();
+    std::vector<double> times(nodes_.size(), INF);
+    std::vector<Step> steps(nodes_.size());
+    using QueueItem = std::pair<double, uint32_t>;
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<>>
+        queue;
+    double best_time = INF;
+    std::optional<Finish> finish;
+
+    for (uint32_t region_id = 0; region_id < regions_.size(); ++region_id) {
+        const RegionQuery& query = queries[region_id];
+        const Region& region = regions_[region_id];
+        for (size_t row = 0; row < query.sources.size(); ++row) {
+            const size_t source = query.sources[row];
+            for (size_t exit = 0; exit < region.exits.size(); ++exit) {
+                const double weight = query.from_sources.Get(row, exit);
+                const uint32_t node = region.exit_nodes[exit];
+                const double time = sources[source].walk_time + weight;
+                if (weight != NO_PATH && time < times[node]) {
+                    times[node] = time;
+                    steps[node] = {NONE, source};
+                    queue.emplace(time, node);
+                }
+            }
+            for (size_t column = 0; column < query.targets.size();
+                 ++column) {
+                const double weight = query.from_sources.Get(
+                    row, region.exits.size() + column);
+                const size_t target = query.targets[column];
+                const double time = sources[source].walk_time + weight +
+                                    targets[target].walk_time;
+                if (weight != NO_PATH && time < best_time) {
+                    best_time = time;
+                    finish = Finish{NONE, source, target};
+                }
+            }
+        }
+    }
+
+    while (!queue.empty()) {
+        const auto [time, node_id] = queue.top();
+        queue.pop();
+        if (time > times[node_id]) {
+            continue;
+        }
+        if (time >= best_time) {
+            break;
+        }
+        const Node& node = nodes_[node_id];
+        const RegionQuery& query = queries[node.region];
+        if (node.entry_index != NONE) {
+            for (size_t column = 0; column < query.targets.size();
+                 ++column) {
+                const double weight =
+                    query.to_targets.Get(node.entry_index, column);
+                const size_t target = query.targets[column];
+                const double total = time + weight + targets[target].walk_time;
+                if (weight != NO_PATH && total < best_time) {
+                    best_time = total;
+                    finish = Finish{node_id, 0, column};
+                }
+            }
+        }
+        for (size_t i = 0; i < edges_[node_id].size(); ++i) {
+            const OverlayEdge& edge = edges_[node_id][i];
+            if (time + edge.weight < times[edge.to]) {
+                times[edge.to] = time + edge.weight;
+                steps[edge.to] = {node_id, i};
+                queue.emplace(times[edge.to], edge.to);
+            }
+        }
+    }
+    if (!finish) {
+        return std::nullopt;
+    }
+
+    // Путь по графу координатора восстанавливается от конца
+    std::vector<uint32_t> path;
+    size_t source = finish->source;
+    size_t target = finish->target;
+    if (finish->node != NONE) {
+        target = queries[nodes_[finish->node].region].targets[target];
+        for (uint32_t node_id = finish->node; node_id != NONE;
+             node_id = steps[node_id].from_node) {
+            path.push_back(node_id);
+            source = steps[node_id].index;
+        }
+        std::reverse(path.begin(), path.end());
+    }
+    const domain::StopId source_stop = sources[source].stop_id;
+    const domain::StopId target_stop = targets[target].stop_id;
+
+    // Части маршрута: пути внутри регионов и переходы между ними
+    struct Part {
+        uint32_t region = NONE;
+        graph::VertexId from = 0;
+        graph::VertexId to = 0;
+        const OverlayEdge* link = nullptr;
+    };
+    std::vector<Part> parts;
+    const graph::VertexId source_vertex = 2 * local_stops_[source_stop];
+    const graph::VertexId target_vertex = 2 * local_stops_[target_stop];
+    if (path.empty()) {
+        parts.push_back(
+            {stop_regions_[source_stop], source_vertex, target_vertex});
+    } else {
+        const Node& first = nodes_[path.front()];
+        parts.push_back({first.region, source_vertex, first.vertex});
+        for (size_t i = 1; i < path.size(); ++i) {
+            const Step& step = steps[path[i]];
+            const OverlayEdge& edge = edges_[step.from_node][step.index];
+            const Node& from = nodes_[step.from_node];
+            if (edge.kind == EdgeKind::REGION) {
+                parts.push_back(
+                    {from.region, from.vertex, nodes_[path[i]].vertex});
+            } else {
+                parts.push_back({NONE, 0, 0, &edge});
+            }
+        }
+        const Node& last = nodes_[path.back()];
+        parts.push_back({last.region, last.vertex, target_vertex});
+    }
+    for (const Part& part : parts) {
+        if (part.region != NONE) {
+            Send(part.region, MakeRouteRequest(part.from, part.to));
+        }
+    }
+
+    domain::RouteInfo result;
+    result.total_time = best_time;
+    if (sources[source].walk_time > 0) {
+        result.edges.emplace_back(domain::WalkEdge{
+            std::nullopt, source_stop, sources[source].walk_time});
+    }
+    bool continue_ride = false;
+    for (const Part& part : parts) {
+        if (part.link) {
+            if (part.link->kind == EdgeKind::RIDE) {
+                continue_ride = true;
+            } else {
+                result.edges.emplace_back(
+                    domain::WalkEdge{part.link->walk_from, part.link->walk_to,
+                                     part.link->weight});
+            }
+            continue;
+        }
+        std::vector<domain::RouteItem> items = ReadRegionRoute(part.region);
+        auto it = items.begin();
+        // Поездка через стык - одна поездка: первый перегон после стыка
+        // ведет от вспомогательной остановки к ее оригиналу
+        if (continue_ride && it != items.end() && !result.edges.empty()) {
+            auto* before = std::get_if<domain::BusEdge>(&result.edges.back());
+            const auto* after = std::get_if<domain::BusEdge>(&*it);
+            if (before && after) {
+                before->span_count += after->span_count - 1;
+                before->time += after->time;
+                ++it;
+            }
+        }
+        continue_ride = false;
+        result.edges.insert(result.edges.end(), it, items.end());
+    }
+    if (targets[target].walk_time > 0) {
+        result.edges.emplace_back(domain::WalkEdge{
+            target_stop, std::nullopt, targets[target].walk_time});
+    }
+    return result;
+}
+
+size_t PartitionedRouter::GetBoundarySize() const
+{
+    return nodes_.size();
+}
+
+void PartitionedRouter::Partition(
+    const transport_catalogue::TransportCatalogue& catalogue)
+{
+    local_stops_.resize(stop_regions_.size());
+    for (domain::StopId stop_id = 0; stop_id < stop_regions_.size();
+         ++stop_id) {
+        Region& region = regions_[stop_regions_[stop_id]];
+        local_stops_[stop_id] =
+            static_cast<domain::StopId>(region.stops.size());
+        region.stops.push_back(stop_id);
+    }
+    for (Region& region : regions_) {
+        region.own_stops_count = region.stops.size();
+    }
+
+    // Маршрут режется на участки по регионам. Участок, с которого
+    // автобус уходит в другой регион, кончается вспомогательной
+    // остановкой - копией первой остановки следующего участка. Следующий
+    // участок начинается своей вспомогательной остановкой с нулевым
+    // перегоном до этой же остановки; стык связывает приезд на первую
+    // вспомогательную остановку с отправлением от второй.
+    for (const domain::Route& route : catalogue.GetRoutes()) {
+        const domain::RouteStops stops = route.GetStops();
+        uint32_t ride_node = NONE;
+        size_t begin = 0;
+        while (begin < stops.size()) {
+            const uint32_t region_id = stop_regions_[stops[begin]];
+            size_t end = begin + 1;
+            while (end < stops.size() &&
+                   stop_regions_[stops[end]] == region_id) {
+                ++end;
+            }
+
+            Piece piece;
+            if (ride_node != NONE) {
+                const domain::StopId junction =
+                    AddJunctionStop(regions_[region_id], stops[begin]);
+                const uint32_t node =
+                    AddBoundary(region_id, 2 * junction + 1, true);
+                edges_[ride_node].push_back({node, 0.0, EdgeKind::RIDE});
+                piece.stops.push_back(junction);
+                piece.lengths.push_back(0);
+            }
+            for (size_t i = begin; i < end; ++i) {
+                piece.stops.push_back(local_stops_[stops[i]]);
+                if (i + 1 < stops.size()) {
+                    piece.lengths.push_back(
+                        catalogue.GetLengthFromTo(stops[i], stops[i + 1]));
+                }
+            }
+            ride_node = NONE;
+            if (end < stops.size()) {
+                const domain::StopId junction =
+                    AddJunctionStop(regions_[region_id], stops[end]);
+                ride_node = AddBoundary(region_id, 2 * junction, false);
+                piece.stops.push_back(junction);
+            }
+
+            Region& region = regions_[region_id];
+            region.pieces.push_back(std::move(piece));
+            region.routes.push_back(route.id);
+            begin = end;
+        }
+    }
+}
+
+void PartitionedRouter::AddWalkLinks(
+    const transport_catalogue::TransportCatalogue& catalogue)
+{
+    if (router_settings_.walk_transfer_radius <= 0) {
+        return;
+    }
+    transport_catalogue::SpatialIndex own_index;
+    if (!catalogue.IsFrozen()) {
+        own_index.Build(catalogue.GetStops());
+    }
+    const transport_catalogue::SpatialIndex& index =
+        catalogue.IsFrozen() ? catalogue.GetStopIndex() : own_index;
+    const router::TransportRouter walk_router(router_settings_);
+
+    // Переходы внутри региона строит маршрутизатор региона
+    for (const domain::Stop& stop : catalogue.GetStops()) {
+        if (stop.coordinates == transport_catalogue::UNKNOWN_COORDINATES) {
+            continue;
+        }
+        for (const auto& [stop_id, distance] : index.FindWithin(
+                 stop.coordinates, router_settings_.walk_transfer_radius)) {
+            const uint32_t from_region = stop_regions_[stop.id];
+            const uint32_t to_region = stop_regions_[stop_id];
+            if (from_region == to_region) {
+                continue;
+            }
+            const uint32_t from = AddBoundary(
+                from_region, 2 * local_stops_[stop.id], false);
+            const uint32_t to =
+                AddBoundary(to_region, 2 * local_stops_[stop_id], true);
+            edges_[from].push_back({to, walk_router.GetWalkTime(distance),
+                                    EdgeKind::WALK, stop.id, stop_id});
+        }
+    }
+}
+
+void PartitionedRouter::StartWorkers(
+    const transport_catalogue::TransportCatalogue& catalogue)
+{
+    for (const Region& region : regions_) {
+        int fds[2];
+        if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+            throw std::runtime_error("Cannot create region worker socket");
+        }
+        const pid_t pid = ::fork();
+        if (pid < 0) {
+            ::close(fds[0]);
+            ::close(fds[1]);
+            throw std::runtime_error("Cannot start region worker");
+        }
+        if (pid == 0) {
+            // Сокеты других рабочих процессов остаются только у
+            // координатора, иначе те не увидят его завершения
+            ::close(fds[0]);
+            for (const Worker& worker : workers_) {
+                ::close(worker.fd);
+            }
+            RunWorker(fds[1], catalogue, region, router_settings_);
+        }
+        ::close(fds[1]);
+        workers_.push_back({fds[0], pid});
+    }
+    // Участки нужны только рабочим процессам
+    for (Region& region : regions_) {
+        region.pieces = {};
+    }
+}
+
+void PartitionedRouter::BuildOverlay()
+{
+    for (uint32_t region_id = 0; region_id < regions_.size(); ++region_id) {
+        const Region& region = regions_[region_id];
+        Send(region_id, MakeWeightsRequest(region.entries, region.exits));
+    }
+    for (uint32_t region_id = 0; region_id < regions_.size(); ++region_id) {
+        const Region& region = regions_[region_id];
+        const WeightTable table =
+            ReadWeights(Receive(region_id), region.entries.size(),
+                        region.exits.size());
+        for (size_t entry = 0; entry < region.entries.size(); ++entry) {
+            const uint32_t from = region.entry_nodes[entry];
+            for (size_t exit = 0; exit < region.exits.size(); ++exit) {
+                const uint32_t to = region.exit_nodes[exit];
+                const double weight = table.Get(entry, exit);
+                if (weight != NO_PATH && from != to) {
+                    edges_[from].push_back({to, weight, EdgeKind::REGION});
+                }
+            }
+        }
+    }
+}
+
+void PartitionedRouter::StopWorkers()
+{
+    // Рабочий процесс завершается, когда его сокет закрыт
+    for (const Worker& worker : workers_) {
+        ::close(worker.fd);
+    }
+    for (const Worker& worker : workers_) {
+        while (::waitpid(worker.pid, nullptr, 0) < 0 && errno == EINTR) {
+        }
+    }
+    workers_.clear();
+}
+
+domain::StopId PartitionedRouter::AddJunctionStop(Region& region,
+                                                  domain::StopId stop)
+{
+    region.stops.push_back(stop);
+    return static_cast<domain::StopId>(region.stops.size() - 1);
+}
+
+uint32_t PartitionedRouter::AddBoundary(uint32_t region_id,
+                                        graph::VertexId vertex, bool is_entry)
+{
+    Region& region = regions_[region_id];
+    const auto [it, added] = region.nodes.emplace(
+        vertex, static_cast<uint32_t>(nodes_.size()));
+    if (added) {
+        nodes_.push_back({region_id, vertex});
+        edges_.emplace_back();
+    }
+    const uint32_t node_id = it->second;
+    Node& node = nodes_[node_id];
+    if (is_entry && node.entry_index == NONE) {
+        node.entry_index = static_cast<uint32_t>(region.entries.size());
+        region.entries.push_back(vertex);
+        region.entry_nodes.push_back(node_id);
+    }
+    if (!is_entry && node.exit_index == NONE) {
+        node.exit_index = static_cast<uint32_t>(region.exits.size());
+        region.exits.push_back(vertex);
+        region.exit_nodes.push_back(node_id);
+    }
+    return node_id;
+}
+
+void PartitionedRouter::Send(uint32_t region_id,
+                             const std::string& request) const
+{
+    SendMessage(workers_[region_id].fd, request);
+}
+
+std::string PartitionedRouter::Receive(uint32_t region_id) const
+{
+    std::optional<std::string> response =
+        ReceiveMessage(workers_[region_id].fd);
+    if (!response) {
+        throw std::runtime_error("Region worker exited");
+    }
+    return std::move(*response);
+}
+
+std::vector<domain::RouteItem> PartitionedRouter::ReadRegionRoute(
+    uint32_t region_id) const
+{
+    const Region& region = regions_[region_id];
+    const std::string message = Receive(region_id);
+    MessageReader reader(message);
+    std::vector<domain::RouteItem> items(reader.Get<uint32_t>());
+    for (domain::RouteItem& item : items) {
+        const ItemType type = reader.Get<ItemType>();
+        if (type == ItemType::STOP) {
+            const domain::StopId stop_id = reader.Get<domain::StopId>();
+            item = domain::StopEdge{region.stops[stop_id],
+                                    reader.Get<double>()};
+        } else if (type == ItemType::BUS) {
+            const domain::RouteId route_id = reader.Get<domain::RouteId>();
+            const uint64_t span_count = reader.Get<uint64_t>();
+            item = domain::BusEdge{region.routes[route_id],
+                                   static_cast<size_t>(span_count),
+                                   reader.Get<double>()};
+        } else {
+            const domain::StopId from = reader.Get<domain::StopId>();
+            const domain::StopId to = reader.Get<domain::StopId>();
+            item = domain::WalkEdge{region.stops[from], region.stops[to],
+                                    reader.Get<double>()};
+        }
+    }
+    return items;
+}
+
+void PartitionedRouter::RunWorker(
+    int fd, const transport_catalogue::TransportCatalogue& catalogue,
+    const Region& region, domain::RouterSettings router_settings)
+{
+    int status = 0;
+    try {
+        const transport_catalogue::TransportCatalogue region_catalogue =
+            BuildRegionCatalogue(catalogue, region);
+        const router::TransportRouter router(
+            region_catalogue, router_settings,
+            region_catalogue.GetAllStopsCount());
+        while (const std::optional<std::string> request =
+                   ReceiveMessage(fd)) {
+            SendMessage(fd, HandleRequest(router, *request));
+        }
+    } catch (...) {
+        status = 1;
+    }
+    // Без деструкторов и сброса буферов вывода, унаследованных от
+    // координатора
+    ::_exit(status);
+}
+
+transport_catalogue::TransportCatalogue
+PartitionedRouter::BuildRegionCatalogue(
+    const transport_catalogue::TransportCatalogue& catalogue,
+    const Region& region)
+{
+    // Вспомогательные остановки и участки называются номерами после
+    // управляющего символа, чтобы не совпасть с настоящими остановками.
+    // У вспомогательных остановок нет координат, поэтому маршрутизатор
+    // региона не строит от них пеших переходов.
+    std::deque<std::string> names;
+    std::vector<std::string_view> stop_names;
+    stop_names.reserve(region.stops.size());
+    transport_catalogue::DeltaBatch batch;
+    batch.stops.reserve(region.stops.size());
+    for (size_t local = 0; local < region.stops.size(); ++local) {
+        if (local < region.own_stops_count) {
+            const domain::Stop& stop = catalogue.GetStop(region.stops[local]);
+            stop_names.push_back(stop.name);
+            batch.stops.push_back({stop.name, stop.coordinates, {}});
+        } else {
+            stop_names.push_back(
+                names.emplace_back("\x01" + std::to_string(local)));
+            batch.stops.push_back({stop_names.back(),
+                                   transport_catalogue::UNKNOWN_COORDINATES,
+                                   {}});
+        }
+    }
+    batch.routes.reserve(region.pieces.size());
+    for (size_t i = 0; i < region.pieces.size(); ++i) {
+        const Piece& piece = region.pieces[i];
+        transport_catalogue::RouteData& route = batch.routes.emplace_back();
+        route.name = names.emplace_back("\x01" + std::to_string(i));
+        route.is_roundtrip = true;
+        for (const domain::StopId stop_id : piece.stops) {
+            route.stops.push_back(stop_names[stop_id]);
+        }
+        for (size_t j = 0; j < piece.lengths.size(); ++j) {
+            batch.distances.push_back({stop_names[piece.stops[j]],
+                                       stop_names[piece.stops[j + 1]],
+                                       piece.lengths[j]});
+        }
+    }
+
+    transport_catalogue::TransportCatalogue region_catalogue;
+    region_catalogue.ApplyDelta(batch);
+    // Локальные номера остановок и участков совпадают с номерами каталога
+    assert(region_catalogue.GetAllStopsCount() == region.stops.size());
+    assert(region_catalogue.GetRoutes().size() == region.pieces.size());
+    return region_catalogue;
+}
+
+} // namespace partitioned_router
\ No newline at end of file
@@ -0,0 +1,162 @@
+// partitioned_router.h
+
+#pragma once
+
+#include "domain.h"
+#include "graph.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/types.h>
+
+namespace partitioned_router {
+
+// Делит остановки на region_count географических регионов: множество
+// остановок рекурсивно делится по медиане широты или долготы, смотря по
+// тому, в каком направлении оно протяженнее. Возвращает регион каждой
+// остановки.
+std::vector<uint32_t> AssignRegions(
+    const transport_catalogue::TransportCatalogue& catalogue,
+    size_t region_count);
+
+// Маршрутизатор, граф которого разделен на географические регионы. Граф и
+// таблицу кратчайших путей каждого региона держит отдельный рабочий
+// процесс; координатор общается с ним через локальный сокет.
+//
+// Маршрут, пересекающий границу, разрезается на участки по регионам. Стык
+// участков - вспомогательная остановка в обоих регионах: в регионе, откуда
+// едет автобус, на нее можно только приехать, в регионе, куда он едет, с
+// нее можно только уехать без ожидания. Пешие переходы между регионами и
+// стыки участков образуют граф координатора вместе с временами проезда
+// между входами и выходами каждого региона, которые считают рабочие
+// процессы. Маршрут между регионами ищется алгоритмом Дейкстры по этому
+// графу и собирается из путей внутри регионов, поэтому совпадает по
+// времени с маршрутом по общему графу.
+//
+// Рабочие процессы запускаются через fork в конструкторе и завершаются в
+// деструкторе (только POSIX). Методы можно вызывать из нескольких
+// потоков: запросы к рабочим процессам выполняются по очереди. После
+// ошибки обмена с рабочим процессом все следующие вызовы GetRouteInfo
+// бросают исключение.
+class PartitionedRouter {
+public:
+    PartitionedRouter(const transport_catalogue::TransportCatalogue& catalogue,
+                      domain::RouterSettings router_settings,
+                      size_t region_count);
+
+    PartitionedRouter(const PartitionedRouter&) = delete;
+    PartitionedRouter& operator=(const PartitionedRouter&) = delete;
+
+    ~PartitionedRouter();
+
+    // Самый быстрый маршрут от любой из sources до любой из targets, как
+    // TransportRouter::GetRouteInfo
+    std::optional<domain::RouteInfo> GetRouteInfo(
+        const std::vector<domain::RouteEndpoint>& sources,
+        const std::vector<domain::RouteEndpoint>& targets) const;
+
+    // Число вершин графа координатора: входов в регионы и выходов из них
+    size_t GetBoundarySize() const;
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    // Участок маршрута внутри региона: локальные остановки и длины
+    // перегонов между ними
+    struct Piece {
+        std::vector<domain::StopId> stops;
+        std::vector<size_t> lengths;
+    };
+
+    struct Region {
+        // Глобальная остановка для каждой локальной: сначала остановки
+        // региона, затем вспомогательные остановки стыков
+        std::vector<domain::StopId> stops;
+        size_t own_stops_count = 0;
+        // Участки и глобальный маршрут каждого из них
+        std::vector<Piece> pieces;
+        std::vector<domain::RouteId> routes;
+        // Локальные вершины входа в регион и выхода из него
+        std::vector<graph::VertexId> entries;
+        std::vector<graph::VertexId> exits;
+        std::vector<uint32_t> entry_nodes;
+        std::vector<uint32_t> exit_nodes;
+        std::unordered_map<graph::VertexId, uint32_t> nodes;
+    };
+
+    // Вершина графа координатора
+    struct Node {
+        uint32_t region;
+        graph::VertexId vertex;
+        uint32_t entry_index = NONE;
+        uint32_t exit_index = NONE;
+    };
+
+    enum class EdgeKind : uint8_t {
+        REGION, // путь внутри региона от входа до выхода
+        RIDE,   // стык участков маршрута
+        WALK,   // пеший переход между регионами
+    };
+
+    struct OverlayEdge {
+        uint32_t to;
+        double weight;
+        EdgeKind kind;
+        domain::StopId walk_from = 0;
+        domain::StopId walk_to = 0;
+    };
+
+    struct Worker {
+        int fd;
+        pid_t pid;
+    };
+
+    const domain::RouterSettings router_settings_;
+    std::vector<uint32_t> stop_regions_;
+    std::vector<domain::StopId> local_stops_;
+    std::vector<Region> regions_;
+    std::vector<Node> nodes_;
+    std::vector<std::vector<OverlayEdge>> edges_;
+    std::vector<Worker> workers_;
+    mutable std::mutex mutex_;
+    mutable bool is_broken_ = false;
+
+    void Partition(const transport_catalogue::TransportCatalogue& catalogue);
+    void AddWalkLinks(const transport_catalogue::TransportCatalogue& catalogue);
+    void StartWorkers(const transport_catalogue::TransportCatalogue& catalogue);
+    void BuildOverlay();
+    void StopWorkers();
+
+    domain::StopId AddJunctionStop(Region& region, domain::StopId stop);
+    uint32_t AddBoundary(uint32_t region_id, graph::VertexId vertex,
+                         bool is_entry);
+
+    // GetRouteInfo под уже захваченным mutex_
+    std::optional<domain::RouteInfo> FindRoute(
+        const std::vector<domain::RouteEndpoint>& sources,
+        const std::vector<domain::RouteEndpoint>& targets) const;
+
+    void Send(uint32_t region_id, const std::string& request) const;
+    std::string Receive(uint32_t region_id) const;
+
+    // Переводит путь внутри региона в глобальные остановки и маршруты
+    std::vector<domain::RouteItem> ReadRegionRoute(uint32_t region_id) const;
+
+    [[noreturn]] static void RunWorker(
+        int fd, const transport_catalogue::TransportCatalogue& catalogue,
+        const Region& region, domain::RouterSettings router_settings);
+
+    static transport_catalogue::TransportCatalogue BuildRegionCatalogue(
+        const transport_catalogue::TransportCatalogue& catalogue,
+        const Region& region);
+};
+
+} // namespace partitioned_router
\ No newline at end of file
@@ -0,0 +1,129 @@
+// perfect_hash.cpp
+
+#include "perfect_hash.h"
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <stdexcept>
+
+namespace transport_catalogue {
+
+namespace {
+
+constexpr uint32_t MAX_SEED = 1u << 24;
+constexpr int MAX_ATTEMPTS = 16;
+constexpr uint64_t GOLDEN_RATIO = 0x9e3779b97f4a7c15ULL;
+
+uint64_t Mix(uint64_t key)
+{
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebULL;
+    key ^= key >> 31;
+    return key;
+}
+
+} // namespace
+
+void PerfectHash::Build(const std::vector<std::string_view>& keys)
+{
+    size_ = keys.size();
+    seeds_.clear();
+    if (size_ == 0) {
+        return;
+    }
+
+    std::vector<uint64_t> hashes;
+    hashes.reserve(size_);
+    for (std::string_view key : keys) {
+        hashes.push_back(std::hash<std::string_view>()(key));
+    }
+
+    for (int attempt = 0; attempt < MAX_ATTEMPTS; ++attempt) {
+        salt_ = Mix(GOLDEN_RATIO * static_cast<uint64_t>(attempt + 1));
+        if (TryBuild(hashes)) {
+            return;
+        }
+    }
+    throw std::runtime_error("Failed to build perfect hash function");
+}
+
+size_t PerfectHash::operator()(std::string_view key) const
+{
+    const uint64_t hash = std::hash<std::string_view>()(key);
+    return GetPosition(hash, seeds_[GetBucket(hash)]);
+}
+
+size_t PerfectHash::Size() const
+{
+    return size_;
+}
+
+size_t PerfectHash::GetBucket(uint64_t hash) const
+{
+    return Mix(hash ^ salt_) % seeds_.size();
+}
+
+size_t PerfectHash::GetPosition(uint64_t hash, uint32_t seed) const
+{
+    return Mix(hash + salt_ + seed * GOLDEN_RATIO) % size_;
+}
+
+bool PerfectHash::TryBuild(const std::vector<uint64_t>& hashes)
+{
+    const size_t bucket_count =
+        (size_ + KEYS_PER_BUCKET - 1) / KEYS_PER_BUCKET;
+    seeds_.assign(bucket_count, 0);
+
+    std::vector<std::vector<uint64_t>> buckets(bucket_count);
+    for (uint64_t hash : hashes) {
+        buckets[GetBucket(hash)].push_back(hash);
+    }
+
+    // Сначала размещаются самые большие корзины, пока свободных позиций много
+    std::vector<size_t> order(bucket_count);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&buckets](size_t lhs, size_t rhs) {
+                         return buckets[lhs].size() > buckets[rhs].size();
+                     });
+
+    std::vector<bool> taken(size_, false);
+    std::vector<size_t> positions;
+    for (size_t bucket : order) {
+        const std::vector<uint64_t>& bucket_hashes = buckets[bucket];
+        if (bucket_hashes.empty()) {
+            break;
+        }
+
+        uint32_t seed = 0;
+        for (; seed < MAX_SEED; ++seed) {
+            positions.clear();
+            for (uint64_t hash : bucket_hashes) {
+                const size_t position = GetPosition(hash, seed);
+                if (taken[position] ||
+                    std::find(positions.begin(), positions.end(),
+                              position) != positions.end()) {
+                    break;
+                }
+                positions.push_back(position);
+            }
+            if (positions.size() == bucket_hashes.size()) {
+                break;
+            }
+        }
+        if (seed == MAX_SEED) {
+            return false;
+        }
+
+        seeds_[bucket] = seed;
+        for (size_t position : positions) {
+            taken[position] = true;
+        }
+    }
+    return true;
+}
+
+} // namespace transport_catalogue
\ No newline at end of file
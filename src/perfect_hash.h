@@ -0,0 +1,36 @@
+// perfect_hash.h
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace transport_catalogue {
+
+// Минимальная совершенная хэш-функция (схема hash-and-displace) над
+// фиксированным набором различных строк. Каждой строке из набора
+// сопоставляется уникальный номер из [0, Size()); для строк вне набора
+// возвращается произвольный номер, поэтому найденную запись нужно сверить
+// по ключу.
+class PerfectHash {
+public:
+    void Build(const std::vector<std::string_view>& keys);
+
+    size_t operator()(std::string_view key) const;
+
+    size_t Size() const;
+
+private:
+    static constexpr size_t KEYS_PER_BUCKET = 4;
+
+    std::vector<uint32_t> seeds_;
+    size_t size_ = 0;
+    uint64_t salt_ = 0;
+
+    size_t GetBucket(uint64_t hash) const;
+    size_t GetPosition(uint64_t hash, uint32_t seed) const;
+    bool TryBuild(const std::vector<uint64_t>& hashes);
+};
+
+} // namespace transport_catalogue
\ No newline at end of file
@@ -2,69 +2,114 @@
 
 #include "request_handler.h"
 
+#include <stdexcept>
+
 namespace request_handler {
 
-std::vector<std::string_view> SortRoutes(
-    const std::deque<domain::Route>& routes)
+std::vector<domain::RouteView> CollectRoutes(
+    const transport_catalogue::TransportCatalogue& db)
 {
-    std::vector<std::string_view> sorted_routes;
-    for (const auto& route : routes) {
-        sorted_routes.push_back(route.name);
+    std::vector<domain::RouteView> routes;
+    routes.reserve(db.GetRoutes().size());
+    for (const domain::RouteId route_id : db.GetSortedRoutes()) {
+        routes.emplace_back(db.GetRoute(route_id));
     }
-    std::sort(sorted_routes.begin(), sorted_routes.end());
-
-    return sorted_routes;
+    return routes;
 }
 
 std::vector<geo::Coordinates> CollectCoordinates(
-    const std::deque<domain::Route>& routes)
+    const transport_catalogue::TransportCatalogue& db)
 {
     std::vector<geo::Coordinates> coordinates;
 
-    for (const auto& route : routes) {
-        for (const auto& stop : route.stops) {
-            coordinates.push_back(stop->coordinates);
+    for (const auto& route : db.GetRoutes()) {
+        for (const auto stop_id : route.stops) {
+            coordinates.push_back(db.GetStop(stop_id).coordinates);
         }
     }
     return coordinates;
 }
 
-std::set<std::string_view> CollectStopsName(
-    const std::deque<domain::Route>& routes)
+std::vector<domain::StopView> CollectStops(
+    const transport_catalogue::TransportCatalogue& db)
+{
+    std::vector<bool> on_route(db.GetAllStopsCount(), false);
+    for (const auto& route : db.GetRoutes()) {
+        for (const auto stop_id : route.stops) {
+            on_route[stop_id] = true;
+        }
+    }
+
+    std::vector<domain::StopView> stops;
+    for (const domain::StopId stop_id : db.GetSortedStops()) {
+        if (on_route[stop_id]) {
+            stops.emplace_back(db.GetStop(stop_id));
+        }
+    }
+    return stops;
+}
+
+// Страница упорядоченного по названиям индекса: записи с названиями
+// больше cursor, одноименные записи выдаются один раз. Пустая страница
+// без курсора означает конец списка, поэтому limit должен быть
+// положителен.
+template <typename View, typename Records>
+ListPage<View> MakeListPage(const Records& records,
+                            std::span<const uint32_t> sorted,
+                            std::optional<std::string_view> cursor,
+                            size_t limit)
 {
-    std::set<std::string_view> stops_name;
-    for (const auto& route : routes) {
-        for (const auto& stop : route.stops) {
-            stops_name.insert(stop->name);
+    if (limit == 0) {
+        throw std::invalid_argument("List page limit must be positive");
+    }
+    auto it = sorted.begin();
+    if (cursor) {
+        it = std::upper_bound(sorted.begin(), sorted.end(), *cursor,
+                              [&records](std::string_view name, uint32_t id) {
+                                  return name < records[id].name;
+                              });
+    }
+
+    ListPage<View> page;
+    std::optional<std::string_view> last = cursor;
+    for (; it != sorted.end(); ++it) {
+        const std::string_view name = records[*it].name;
+        if (last && name == *last) {
+            continue;
+        }
+        if (page.items.size() == limit) {
+            page.next_cursor = last;
+            break;
         }
+        page.items.emplace_back(records[*it]);
+        last = name;
     }
-    return stops_name;
+    return page;
 }
 
 RequestHandler::RequestHandler(
-    const transport_catalogue::TransportCatalogue& db,
-    const map_renderer::MapRenderer& renderer)
-    : db_(db)
+    std::shared_ptr<const catalogue_snapshot::Snapshot> snapshot,
+    const map_renderer::MapRenderer& renderer, RouteFinder route_finder)
+    : snapshot_(std::move(snapshot))
+    , db_(snapshot_->catalogue)
     , renderer_(renderer)
+    , route_finder_(std::move(route_finder))
 {
 }
 
 std::optional<domain::RouteStats> RequestHandler::GetRouteStat(
     const std::string_view& bus_name) const
 {
-    if (db_.FindRoute(bus_name).has_value()) {
-        return db_.GetRouteStats(bus_name);
+    if (const auto route = db_.FindRoute(bus_name)) {
+        return db_.GetRouteStats(route->GetId());
     }
     return std::nullopt;
 }
 
-std::optional<domain::Route> RequestHandler::GetRoute(
+std::optional<domain::RouteView> RequestHandler::GetRoute(
     const std::string_view& bus_name) const
 {
-    if (db_.FindRoute(bus_name).has_value()) {
-        return db_.FindRoute(bus_name);
-    }
-    return std::nullopt;
+    return db_.FindRoute(bus_name);
 }
 
 const std::set<std::string_view> RequestHandler::GetBusesByStop(
@@ -73,18 +118,150 @@ const std::set<std::string_view> RequestHandler::GetBusesByStop(
     return db_.FindBusesOnStop(stop_name);
 }
 
-std::optional<domain::Stop*> RequestHandler::GetStop(
+std::optional<domain::StopView> RequestHandler::GetStop(
     const std::string_view& stop_name) const
 {
     return db_.FindStop(stop_name);
 }
 
+std::vector<transport_catalogue::StopDistance> RequestHandler::GetStopsNearby(
+    geo::Coordinates center, std::optional<double> radius,
+    std::optional<size_t> count) const
+{
+    const transport_catalogue::SpatialIndex& index = db_.GetStopIndex();
+    if (!count) {
+        if (!radius) {
+            throw std::invalid_argument("StopsNearby needs radius or count");
+        }
+        return index.FindWithin(center, *radius);
+    }
+    std::vector<transport_catalogue::StopDistance> stops =
+        index.FindNearest(center, *count);
+    if (radius) {
+        std::erase_if(stops, [&radius](const auto& stop) {
+            return stop.distance > *radius;
+        });
+    }
+    return stops;
+}
+
+std::vector<domain::StopView> RequestHandler::GetStopsInBox(
+    geo::Coordinates min, geo::Coordinates max) const
+{
+    std::vector<domain::StopView> stops;
+    for (const domain::StopId stop_id :
+         db_.GetStopIndex().FindInBox(min, max)) {
+        stops.emplace_back(db_.GetStop(stop_id));
+    }
+    std::sort(stops.begin(), stops.end(),
+              [](const domain::StopView& lhs, const domain::StopView& rhs) {
+                  return lhs.GetName() < rhs.GetName();
+              });
+    return stops;
+}
+
+std::vector<domain::StopView> RequestHandler::SearchStops(
+    std::string_view query, size_t limit) const
+{
+    std::vector<domain::StopView> stops;
+    for (const domain::StopId stop_id :
+         db_.GetStopSearchIndex().Find(query, limit)) {
+        stops.emplace_back(db_.GetStop(stop_id));
+    }
+    return stops;
+}
+
+std::vector<domain::RouteView> RequestHandler::SearchRoutes(
+    std::string_view query, size_t limit) const
+{
+    std::vector<domain::RouteView> routes;
+    for (const domain::RouteId route_id :
+         db_.GetRouteSearchIndex().Find(query, limit)) {
+        routes.emplace_back(db_.GetRoute(route_id));
+    }
+    return routes;
+}
+
+ListPage<domain::StopView> RequestHandler::ListStops(
+    std::optional<std::string_view> cursor, size_t limit) const
+{
+    return MakeListPage<domain::StopView>(db_.GetStops(),
+                                          db_.GetSortedStops(), cursor,
+                                          limit);
+}
+
+ListPage<domain::RouteView> RequestHandler::ListBuses(
+    std::optional<std::string_view> cursor, size_t limit) const
+{
+    return MakeListPage<domain::RouteView>(db_.GetRoutes(),
+                                           db_.GetSortedRoutes(), cursor,
+                                           limit);
+}
+
+std::optional<domain::RouteInfo> RequestHandler::BuildRoute(
+    const RoutePoint& from, const RoutePoint& to) const
+{
+    const router::TransportRouter& router = snapshot_->router;
+    const std::vector<domain::RouteEndpoint> sources = GetRouteEndpoints(from);
+    const std::vector<domain::RouteEndpoint> targets = GetRouteEndpoints(to);
+    std::optional<domain::RouteInfo> route =
+        route_finder_ ? route_finder_(sources, targets)
+                      : router.GetRouteInfo(sources, targets);
+
+    const auto* from_point = std::get_if<geo::Coordinates>(&from);
+    const auto* to_point = std::get_if<geo::Coordinates>(&to);
+    if (from_point && to_point) {
+        const double walk_time = router.GetWalkTime(
+            *from_point == *to_point
+                ? 0
+                : geo::ComputeDistance(*from_point, *to_point));
+        if (!route || walk_time <= route->total_time) {
+            route = domain::RouteInfo{walk_time, {}};
+            if (walk_time > 0) {
+                route->edges.emplace_back(
+                    domain::WalkEdge{std::nullopt, std::nullopt, walk_time});
+            }
+        }
+    }
+    return route;
+}
+
+std::vector<domain::RouteEndpoint> RequestHandler::GetRouteEndpoints(
+    const RoutePoint& point) const
+{
+    if (const auto* name = std::get_if<std::string_view>(&point)) {
+        // Для неизвестной остановки маршрута нет
+        if (const auto stop = db_.FindStop(*name)) {
+            return {{stop->GetId(), 0}};
+        }
+        return {};
+    }
+    const router::TransportRouter& router = snapshot_->router;
+    std::vector<domain::RouteEndpoint> endpoints;
+    for (const auto& [stop_id, distance] : db_.GetStopIndex().FindNearest(
+             std::get<geo::Coordinates>(point),
+             router.GetSettings().snap_stops_count)) {
+        endpoints.push_back({stop_id, router.GetWalkTime(distance)});
+    }
+    return endpoints;
+}
+
+std::optional<std::vector<network_analytics::StopCentrality>>
+RequestHandler::GetStopCentrality(
+    const network_analytics::AnalyticsSettings& settings) const
+{
+    if (!snapshot_->router.GetGraph()) {
+        return std::nullopt;
+    }
+    return network_analytics::ComputeCentrality(
+        snapshot_->router, db_.GetAllStopsCount(), settings);
+}
+
 svg::Document RequestHandler::RenderMap() const
 {
     svg::Document document;
 
-    std::vector<geo::Coordinates> geo_coord =
-        CollectCoordinates(db_.GetRoutes());
+    std::vector<geo::Coordinates> geo_coord = CollectCoordinates(db_);
 
     map_renderer::SphereProjector projector(
         geo_coord.begin(), geo_coord.end(),
@@ -92,10 +269,8 @@ svg::Document RequestHandler::RenderMap() const
         renderer_.GetRenderSettings().height,
         renderer_.GetRenderSettings().padding);
 
-    std::vector<std::string_view> sorted_routes =
-        SortRoutes(db_.GetRoutes());
-    std::set<std::string_view> sorted_stops =
-        CollectStopsName(db_.GetRoutes());
+    const std::vector<domain::RouteView> sorted_routes = CollectRoutes(db_);
+    const std::vector<domain::StopView> sorted_stops = CollectStops(db_);
 
     RenderRouteLine(document, projector, sorted_routes);
     RenderRouteName(document, projector, sorted_routes);
@@ -111,18 +286,25 @@ RequestHandler::GetTransportCatalogue() const
     return db_;
 }
 
+const router::TransportRouter& RequestHandler::GetTransportRouter() const
+{
+    return snapshot_->router;
+}
+
 void RequestHandler::RenderRouteLine(
     svg::Document& document,
     const map_renderer::SphereProjector& projector,
-    std::vector<std::string_view> sorted_routes) const
+    const std::vector<domain::RouteView>& sorted_routes) const
 {
     size_t route_counter = 0;
-    for (const auto& route_name : sorted_routes) {
-        auto route = db_.FindRoute(route_name).value();
-        if (!route.stops.empty()) {
+    for (const auto& route : sorted_routes) {
+        const auto stops = route.GetStops();
+        if (!stops.empty()) {
             std::vector<svg::Point> projectet_coord;
-            for (const auto& stop : route.stops) {
-                projectet_coord.push_back(projector(stop->coordinates));
+            projectet_coord.reserve(stops.size());
+            for (const auto stop_id : stops) {
+                projectet_coord.push_back(
+                    projector(db_.GetStop(stop_id).coordinates));
             }
 
             document.Add(
@@ -135,26 +317,25 @@ void RequestHandler::RenderRouteLine(
 void RequestHandler::RenderRouteName(
     svg::Document& document,
     const map_renderer::SphereProjector& projector,
-    std::vector<std::string_view> sorted_routes) const
+    const std::vector<domain::RouteView>& sorted_routes) const
 {
     size_t route_counter = 0;
-    for (const auto& route_name : sorted_routes) {
-        auto route = db_.FindRoute(route_name).value();
-        if (!route.stops.empty()) {
+    for (const auto& route : sorted_routes) {
+        const auto stops = route.GetStops();
+        const std::string_view route_name = route.GetName();
+        if (!stops.empty()) {
             svg::Point projectet_coord_f =
-                projector(route.stops.front()->coordinates);
+                projector(db_.GetStop(stops.front()).coordinates);
             document.Add(renderer_.RenderRouteNameSubstrate(
                 route_name, projectet_coord_f));
             document.Add(renderer_.RenderRouteName(route_name,
                                                    projectet_coord_f,
                                                    route_counter));
 
-            if (!route.is_roundtrip &&
-                route.stops.at(route.stops.size() / 2) !=
-                    route.stops.front()) {
-                svg::Point projectet_coord_l =
-                    projector(route.stops.at(route.stops.size() / 2)
-                                  ->coordinates);
+            if (!route.IsRoundtrip() &&
+                stops[stops.size() / 2] != stops.front()) {
+                svg::Point projectet_coord_l = projector(
+                    db_.GetStop(stops[stops.size() / 2]).coordinates);
                 document.Add(renderer_.RenderRouteNameSubstrate(
                     route_name, projectet_coord_l));
                 document.Add(renderer_.RenderRouteName(route_name,
@@ -169,26 +350,24 @@ void RequestHandler::RenderRouteName(
 void RequestHandler::RenderStopCircle(
     svg::Document& document,
     const map_renderer::SphereProjector& projector,
-    std::set<std::string_view> sorted_stops) const
+    const std::vector<domain::StopView>& sorted_stops) const
 {
-    for (const auto& stop_name : sorted_stops) {
-        auto stop = db_.FindStop(stop_name).value();
+    for (const auto& stop : sorted_stops) {
         document.Add(
-            renderer_.RenderStopCircle(projector(stop->coordinates)));
+            renderer_.RenderStopCircle(projector(stop.GetCoordinates())));
     }
 }
 
 void RequestHandler::RenderStopName(
     svg::Document& document,
     const map_renderer::SphereProjector& projector,
-    std::set<std::string_view> sorted_stops) const
-{
-    for (const auto& stop_name : sorted_stops) {
-        auto stop = db_.FindStop(stop_name).value();
-        document.Add(renderer_.RenderStopNameSubstrate(
-            stop->name, projector(stop->coordinates)));
-        document.Add(renderer_.RenderStopName(stop->name,
-                                              projector(stop->coordinates)));
+    const std::vector<domain::StopView>& sorted_stops) const
+{
+    for (const auto& stop : sorted_stops) {
+        const svg::Point position = projector(stop.GetCoordinates());
+        document.Add(
+            renderer_.RenderStopNameSubstrate(stop.GetName(), position));
+        document.Add(renderer_.RenderStopName(stop.GetName(), position));
     }
 }
 
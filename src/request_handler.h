@@ -2,62 +2,136 @@
 
 #pragma once
 
+#include "catalogue_snapshot.h"
 #include "map_renderer.h"
+#include "network_analytics.h"
 #include "transport_catalogue.h"
 
-#include <deque>
+#include <functional>
+#include <memory>
+#include <optional>
 #include <set>
 #include <string>
+#include <string_view>
+#include <variant>
 #include <vector>
 
 namespace request_handler {
 
+// Начало или конец маршрута: название остановки или произвольная точка
+using RoutePoint = std::variant<std::string_view, geo::Coordinates>;
+
+// Страница списка. next_cursor - название последнего элемента страницы,
+// если за ней есть еще элементы. Курсор не зависит от версии каталога:
+// следующая страница начинается с первого названия больше курсора.
+template <typename Item>
+struct ListPage {
+    std::vector<Item> items;
+    std::optional<std::string_view> next_cursor;
+};
+
+// Самый быстрый маршрут от любой из sources до любой из targets
+using RouteFinder = std::function<std::optional<domain::RouteInfo>(
+    const std::vector<domain::RouteEndpoint>& sources,
+    const std::vector<domain::RouteEndpoint>& targets)>;
+
 class RequestHandler {
 public:
+    // Версия каталога закреплена на всё время жизни обработчика. Маршруты
+    // ищет route_finder, если он задан, иначе маршрутизатор снимка.
     explicit RequestHandler(
-        const transport_catalogue::TransportCatalogue& db,
-        const map_renderer::MapRenderer& renderer);
+        std::shared_ptr<const catalogue_snapshot::Snapshot> snapshot,
+        const map_renderer::MapRenderer& renderer,
+        RouteFinder route_finder = nullptr);
 
     std::optional<domain::RouteStats> GetRouteStat(
         const std::string_view& bus_name) const;
 
-    std::optional<domain::Route> GetRoute(
+    std::optional<domain::RouteView> GetRoute(
         const std::string_view& bus_name) const;
 
     const std::set<std::string_view> GetBusesByStop(
         const std::string_view& stop_name) const;
 
-    std::optional<domain::Stop*> GetStop(
+    std::optional<domain::StopView> GetStop(
         const std::string_view& stop_name) const;
 
+    // Остановки не дальше radius метров или count ближайших (при обоих
+    // ограничениях - ближайшие в радиусе), по возрастанию расстояния.
+    // Без обоих ограничений выбрасывает std::invalid_argument.
+    std::vector<transport_catalogue::StopDistance> GetStopsNearby(
+        geo::Coordinates center, std::optional<double> radius,
+        std::optional<size_t> count) const;
+
+    // Остановки в прямоугольнике, упорядоченные по названию
+    std::vector<domain::StopView> GetStopsInBox(geo::Coordinates min,
+                                                geo::Coordinates max) const;
+
+    // До limit остановок (маршрутов), названия которых начинаются с query
+    // или похожи на него с учетом опечаток; лучшие совпадения первыми
+    std::vector<domain::StopView> SearchStops(std::string_view query,
+                                              size_t limit) const;
+
+    std::vector<domain::RouteView> SearchRoutes(std::string_view query,
+                                                size_t limit) const;
+
+    // До limit остановок (маршрутов) в порядке названий, начиная с
+    // первого названия больше cursor. При limit == 0 выбрасывает
+    // std::invalid_argument.
+    ListPage<domain::StopView> ListStops(
+        std::optional<std::string_view> cursor, size_t limit) const;
+
+    ListPage<domain::RouteView> ListBuses(
+        std::optional<std::string_view> cursor, size_t limit) const;
+
+    // Точка привязывается к ближайшим остановкам (snap_stops_count из
+    // настроек маршрутизации), путь до них и от них проходится пешком.
+    // Между двумя точками маршрут может целиком состоять из пешего пути.
+    // Для неизвестной остановки возвращает nullopt.
+    std::optional<domain::RouteInfo> BuildRoute(const RoutePoint& from,
+                                                const RoutePoint& to) const;
+
+    // Посредничество и близость всех остановок (индекс - id остановки);
+    // nullopt, если у снимка нет графа маршрутизатора
+    std::optional<std::vector<network_analytics::StopCentrality>>
+    GetStopCentrality(
+        const network_analytics::AnalyticsSettings& settings) const;
+
     svg::Document RenderMap() const;
 
     const transport_catalogue::TransportCatalogue& GetTransportCatalogue()
         const;
 
+    const router::TransportRouter& GetTransportRouter() const;
+
 private:
+    std::shared_ptr<const catalogue_snapshot::Snapshot> snapshot_;
     const transport_catalogue::TransportCatalogue& db_;
     const map_renderer::MapRenderer& renderer_;
+    const RouteFinder route_finder_;
+
+    std::vector<domain::RouteEndpoint> GetRouteEndpoints(
+        const RoutePoint& point) const;
 
     void RenderRouteLine(
         svg::Document& document,
         const map_renderer::SphereProjector& projector,
-        std::vector<std::string_view> sorted_routes) const;
+        const std::vector<domain::RouteView>& sorted_routes) const;
 
     void RenderRouteName(
         svg::Document& document,
         const map_renderer::SphereProjector& projector,
-        std::vector<std::string_view> sorted_routes) const;
+        const std::vector<domain::RouteView>& sorted_routes) const;
 
     void RenderStopCircle(
         svg::Document& document,
         const map_renderer::SphereProjector& projector,
-        std::set<std::string_view> sorted_stops) const;
+        const std::vector<domain::StopView>& sorted_stops) const;
 
     void RenderStopName(
         svg::Document& document,
         const map_renderer::SphereProjector& projector,
-        std::set<std::string_view> sorted_stops) const;
+        const std::vector<domain::StopView>& sorted_stops) const;
 };
 
 } // namespace request_handler
\ No newline at end of file
@@ -31,6 +31,12 @@ public:
 
     std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
 
+    // Вес кратчайшего пути без восстановления его ребер
+    std::optional<Weight> GetWeight(VertexId from, VertexId to) const;
+
+    // Объем таблицы кратчайших путей в байтах
+    size_t GetMemoryUsage() const;
+
 private:
     struct RouteInternalData {
         Weight weight;
@@ -149,4 +155,25 @@ Router<Weight>::BuildRoute(VertexId from, VertexId to) const
     return RouteInfo{weight, std::move(edges)};
 }
 
+template <typename Weight>
+std::optional<Weight> Router<Weight>::GetWeight(VertexId from,
+                                                VertexId to) const
+{
+    const auto& route_internal_data =
+        routes_internal_data_.at(from).at(to);
+    if (!route_internal_data) {
+        return std::nullopt;
+    }
+    return route_internal_data->weight;
+}
+
+template <typename Weight>
+size_t Router<Weight>::GetMemoryUsage() const
+{
+    const size_t vertex_count = routes_internal_data_.size();
+    return vertex_count *
+           (sizeof(typename RoutesInternalData::value_type) +
+            vertex_count * sizeof(std::optional<RouteInternalData>));
+}
+
 } // namespace graph
\ No newline at end of file
@@ -0,0 +1,255 @@
+// spatial_index.cpp
+
+#define _USE_MATH_DEFINES
+#include "spatial_index.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace transport_catalogue {
+
+namespace {
+
+constexpr double DEGREE = M_PI / 180.0;
+// В среднем столько остановок приходится на ячейку
+constexpr size_t POINTS_PER_CELL = 2;
+// Столько приближенных расстояний считается за раз
+constexpr size_t APPROX_BATCH = 64;
+
+struct Point {
+    geo::Coordinates coordinates;
+    domain::StopId stop_id;
+};
+
+bool IsKnown(geo::Coordinates coordinates)
+{
+    return std::abs(coordinates.lat) <= 90 &&
+           std::abs(coordinates.lng) <= 180;
+}
+
+void SortByDistance(std::vector<StopDistance>& result)
+{
+    std::sort(result.begin(), result.end(),
+              [](const StopDistance& lhs, const StopDistance& rhs) {
+                  return std::pair(lhs.distance, lhs.stop_id) <
+                         std::pair(rhs.distance, rhs.stop_id);
+              });
+}
+
+} // namespace
+
+void SpatialIndex::Build(const std::vector<domain::Stop>& stops)
+{
+    std::vector<Point> points;
+    for (const domain::Stop& stop : stops) {
+        if (IsKnown(stop.coordinates)) {
+            points.push_back({stop.coordinates, stop.id});
+        }
+    }
+    if (points.empty()) {
+        *this = SpatialIndex();
+        return;
+    }
+
+    geo::Coordinates min = points.front().coordinates;
+    geo::Coordinates max = min;
+    for (const Point& point : points) {
+        min.lat = std::min(min.lat, point.coordinates.lat);
+        min.lng = std::min(min.lng, point.coordinates.lng);
+        max.lat = std::max(max.lat, point.coordinates.lat);
+        max.lng = std::max(max.lng, point.coordinates.lng);
+    }
+    const double lat_span = std::max(max.lat - min.lat, 1e-6);
+    const double lng_span = std::max(max.lng - min.lng, 1e-6);
+    const size_t cells = std::max<size_t>(1, points.size() / POINTS_PER_CELL);
+
+    origin_ = min;
+    cell_size_ = std::sqrt(lat_span * lng_span / static_cast<double>(cells));
+    rows_ = std::min(cells, static_cast<size_t>(lat_span / cell_size_) + 1);
+    cols_ = std::min(cells, static_cast<size_t>(lng_span / cell_size_) + 1);
+
+    cell_offsets_.assign(rows_ * cols_ + 1, 0);
+    for (const Point& point : points) {
+        const size_t cell = GetRow(point.coordinates.lat) * cols_ +
+                            GetCol(point.coordinates.lng);
+        ++cell_offsets_[cell + 1];
+    }
+    for (size_t i = 1; i < cell_offsets_.size(); ++i) {
+        cell_offsets_[i] += cell_offsets_[i - 1];
+    }
+    coordinates_.resize(points.size());
+    trig_.resize(points.size());
+    stop_ids_.resize(points.size());
+    std::vector<uint32_t> next(cell_offsets_.begin(), cell_offsets_.end() - 1);
+    for (const Point& point : points) {
+        const size_t cell = GetRow(point.coordinates.lat) * cols_ +
+                            GetCol(point.coordinates.lng);
+        const uint32_t i = next[cell]++;
+        coordinates_[i] = point.coordinates;
+        trig_[i] = geo::ComputeLatitudeTrig(point.coordinates.lat);
+        stop_ids_[i] = point.stop_id;
+    }
+}
+
+std::vector<StopDistance> SpatialIndex::FindWithin(geo::Coordinates center,
+                                                   double radius) const
+{
+    std::vector<StopDistance> result;
+    if (coordinates_.empty() || radius < 0) {
+        return result;
+    }
+
+    // Угловой радиус области и её ограничивающий прямоугольник
+    const double angle = std::min(radius / geo::EARTH_RADIUS, M_PI);
+    const double min_lat = center.lat - angle / DEGREE;
+    const double max_lat = center.lat + angle / DEGREE;
+    const double sin_angle = std::sin(angle);
+    const double cos_lat = std::cos(center.lat * DEGREE);
+    double lng_delta = 180;
+    if (min_lat > -90 && max_lat < 90 && sin_angle < cos_lat) {
+        lng_delta = std::asin(sin_angle / cos_lat) / DEGREE;
+    }
+
+    const geo::LatitudeTrig center_trig = geo::ComputeLatitudeTrig(center.lat);
+    const auto visit = [&](uint32_t i) {
+        const double distance = geo::ComputeDistance(
+            center, center_trig, coordinates_[i], trig_[i]);
+        if (distance <= radius) {
+            result.push_back({stop_ids_[i], distance});
+        }
+    };
+    const double min_lng = center.lng - lng_delta;
+    const double max_lng = center.lng + lng_delta;
+    const Box box{min_lat, max_lat, min_lng, max_lng};
+    if (lng_delta < 180 && min_lng >= -180 && max_lng <= 180 &&
+        radius <= geo::APPROX_MAX_DISTANCE &&
+        std::max(-min_lat, max_lat) <= geo::APPROX_MAX_LATITUDE) {
+        // Точка не дальше radius не может быть дальше approx_limit по
+        // приближенному расстоянию
+        const double approx_limit =
+            radius * (1 + geo::APPROX_RELATIVE_ERROR) +
+            geo::APPROX_ABSOLUTE_ERROR;
+        std::array<double, APPROX_BATCH> approx;
+        VisitRows(box, [&](uint32_t begin, uint32_t end) {
+            for (; begin < end; begin += APPROX_BATCH) {
+                const size_t size =
+                    std::min<size_t>(end - begin, APPROX_BATCH);
+                geo::ComputeApproxDistances(
+                    center, {coordinates_.data() + begin, size},
+                    {approx.data(), size});
+                for (size_t j = 0; j < size; ++j) {
+                    if (approx[j] <= approx_limit &&
+                        box.Contains(coordinates_[begin + j])) {
+                        visit(begin + j);
+                    }
+                }
+            }
+        });
+    } else if (lng_delta >= 180) {
+        VisitBox({min_lat, max_lat, -180, 180}, visit);
+    } else if (min_lng < -180) {
+        VisitBox({min_lat, max_lat, -180, max_lng}, visit);
+        VisitBox({min_lat, max_lat, min_lng + 360, 180}, visit);
+    } else if (max_lng > 180) {
+        VisitBox({min_lat, max_lat, min_lng, 180}, visit);
+        VisitBox({min_lat, max_lat, -180, max_lng - 360}, visit);
+    } else {
+        VisitBox(box, visit);
+    }
+    SortByDistance(result);
+    return result;
+}
+
+std::vector<StopDistance> SpatialIndex::FindNearest(geo::Coordinates center,
+                                                    size_t count) const
+{
+    if (count == 0 || coordinates_.empty()) {
+        return {};
+    }
+    // Радиус удваивается, пока в круг не попадет count остановок: все
+    // остановки ближе найденных гарантированно лежат в том же круге
+    double radius = cell_size_ * DEGREE * geo::EARTH_RADIUS;
+    const double max_radius = M_PI * geo::EARTH_RADIUS;
+    while (true) {
+        std::vector<StopDistance> result = FindWithin(center, radius);
+        if (result.size() >= count || radius >= max_radius) {
+            result.resize(std::min(result.size(), count));
+            return result;
+        }
+        radius *= 2;
+    }
+}
+
+std::vector<domain::StopId> SpatialIndex::FindInBox(
+    geo::Coordinates min, geo::Coordinates max) const
+{
+    std::vector<domain::StopId> result;
+    const auto visit = [&](uint32_t i) {
+        result.push_back(stop_ids_[i]);
+    };
+    if (min.lng <= max.lng) {
+        VisitBox({min.lat, max.lat, min.lng, max.lng}, visit);
+    } else {
+        VisitBox({min.lat, max.lat, min.lng, 180}, visit);
+        VisitBox({min.lat, max.lat, -180, max.lng}, visit);
+    }
+    return result;
+}
+
+size_t SpatialIndex::Size() const
+{
+    return coordinates_.size();
+}
+
+bool SpatialIndex::Box::Contains(geo::Coordinates point) const
+{
+    return point.lat >= min_lat && point.lat <= max_lat &&
+           point.lng >= min_lng && point.lng <= max_lng;
+}
+
+size_t SpatialIndex::GetRow(double lat) const
+{
+    const double row = std::floor((lat - origin_.lat) / cell_size_);
+    return static_cast<size_t>(
+        std::clamp(row, 0.0, static_cast<double>(rows_ - 1)));
+}
+
+size_t SpatialIndex::GetCol(double lng) const
+{
+    const double col = std::floor((lng - origin_.lng) / cell_size_);
+    return static_cast<size_t>(
+        std::clamp(col, 0.0, static_cast<double>(cols_ - 1)));
+}
+
+template <typename Visitor>
+void SpatialIndex::VisitRows(const Box& box, Visitor&& visit) const
+{
+    if (coordinates_.empty() || box.min_lat > box.max_lat ||
+        box.min_lng > box.max_lng) {
+        return;
+    }
+    const size_t min_row = GetRow(box.min_lat);
+    const size_t max_row = GetRow(box.max_lat);
+    const size_t min_col = GetCol(box.min_lng);
+    const size_t max_col = GetCol(box.max_lng);
+    for (size_t row = min_row; row <= max_row; ++row) {
+        // Ячейки одной строки сетки лежат в массивах подряд
+        visit(cell_offsets_[row * cols_ + min_col],
+              cell_offsets_[row * cols_ + max_col + 1]);
+    }
+}
+
+template <typename Visitor>
+void SpatialIndex::VisitBox(const Box& box, Visitor&& visit) const
+{
+    VisitRows(box, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+            if (box.Contains(coordinates_[i])) {
+                visit(i);
+            }
+        }
+    });
+}
+
+} // namespace transport_catalogue
\ No newline at end of file
@@ -0,0 +1,78 @@
+// spatial_index.h
+
+#pragma once
+
+#include "domain.h"
+#include "geo.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace transport_catalogue {
+
+struct StopDistance {
+    domain::StopId stop_id;
+    double distance; // Метры
+};
+
+// Равномерная сетка по широте и долготе над остановками с известными
+// координатами. Остановки хранятся подряд по ячейкам, координаты и
+// тригонометрия широт - в отдельных массивах того же порядка. Запрос
+// перебирает только ячейки, пересекающие ограничивающий прямоугольник
+// области, сверяет кандидатов с прямоугольником, отсеивает дальних по
+// приближенному расстоянию и лишь затем вычисляет точное.
+class SpatialIndex {
+public:
+    void Build(const std::vector<domain::Stop>& stops);
+
+    // Остановки не дальше radius метров, по возрастанию расстояния
+    std::vector<StopDistance> FindWithin(geo::Coordinates center,
+                                         double radius) const;
+
+    // count ближайших остановок, по возрастанию расстояния
+    std::vector<StopDistance> FindNearest(geo::Coordinates center,
+                                          size_t count) const;
+
+    // Остановки в прямоугольнике; если min.lng > max.lng, прямоугольник
+    // пересекает меридиан 180°
+    std::vector<domain::StopId> FindInBox(geo::Coordinates min,
+                                          geo::Coordinates max) const;
+
+    size_t Size() const;
+
+private:
+    // Прямоугольник в градусах, не пересекающий меридиан 180°
+    struct Box {
+        double min_lat;
+        double max_lat;
+        double min_lng;
+        double max_lng;
+
+        bool Contains(geo::Coordinates point) const;
+    };
+
+    geo::Coordinates origin_{0, 0};
+    double cell_size_ = 1;
+    size_t rows_ = 0;
+    size_t cols_ = 0;
+    // Точки ячейки i - номера [cell_offsets_[i], cell_offsets_[i + 1])
+    std::vector<uint32_t> cell_offsets_;
+    std::vector<geo::Coordinates> coordinates_;
+    std::vector<geo::LatitudeTrig> trig_;
+    std::vector<domain::StopId> stop_ids_;
+
+    size_t GetRow(double lat) const;
+    size_t GetCol(double lng) const;
+
+    // Передает visit(begin, end) номера точек строк сетки, пересекающих
+    // box, без сверки с самим прямоугольником
+    template <typename Visitor>
+    void VisitRows(const Box& box, Visitor&& visit) const;
+
+    // Передает visit(i) номера точек внутри box
+    template <typename Visitor>
+    void VisitBox(const Box& box, Visitor&& visit) const;
+};
+
+} // namespace transport_catalogue
\ No newline at end of file
@@ -150,6 +150,12 @@ Text& Text::SetFontWeight(std::string font_weight)
 }
 
 Text& Text::SetData(std::string data)
+{
+    data_ = std::move(data);
+    return *this;
+}
+
+Text& Text::SetDataView(std::string_view data)
 {
     data_ = data;
     return *this;
@@ -170,37 +176,38 @@ void Text::RenderObject(const RenderContext& context) const
     if (!font_weight_.empty()) {
         out << " font-weight=\""sv << font_weight_ << "\""sv;
     }
-    out << ">"sv << ReplaceSpecialChars(data_) << "</text>"sv;
+    out << ">"sv;
+    RenderData(out);
+    out << "</text>"sv;
 }
 
-std::string Text::ReplaceSpecialChars(const std::string& data) const
+void Text::RenderData(std::ostream& out) const
 {
-    std::string result;
+    const std::string_view data = std::visit(
+        [](const auto& value) { return std::string_view(value); }, data_);
 
     for (char c : data) {
         switch (c) {
         case '\"':
-            result += "&quot;";
+            out << "&quot;"sv;
             break;
         case '\'':
-            result += "&apos;";
+            out << "&apos;"sv;
             break;
         case '<':
-            result += "&lt;";
+            out << "&lt;"sv;
             break;
         case '>':
-            result += "&gt;";
+            out << "&gt;"sv;
             break;
         case '&':
-            result += "&amp;";
+            out << "&amp;"sv;
             break;
         default:
-            result.push_back(c);
+            out.put(c);
             break;
         }
     }
-
-    return result;
 }
 
 void Document::AddPtr(std::unique_ptr<Object>&& obj)
@@ -7,6 +7,7 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
@@ -220,17 +221,19 @@ public:
     Text& SetFontFamily(std::string font_family);
     Text& SetFontWeight(std::string font_weight);
     Text& SetData(std::string data);
+    // Строка не копируется и должна оставаться действительной до отрисовки
+    Text& SetDataView(std::string_view data);
 
 private:
     void RenderObject(const RenderContext& context) const override;
-    std::string ReplaceSpecialChars(const std::string& data) const;
+    void RenderData(std::ostream& out) const;
 
     Point position_;
     Point offset_;
     uint32_t size_ = 1;
     std::string font_family_;
     std::string font_weight_;
-    std::string data_;
+    std::variant<std::string, std::string_view> data_;
 };
 
 class ObjectContainer {
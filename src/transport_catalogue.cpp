@@ -2,109 +2,247 @@
 
 #include "transport_catalogue.h"
 
+#include <stdexcept>
+
 namespace transport_catalogue {
 
-void TransportCatalogue::AddRoute(const std::string name,
-                                  std::vector<std::string_view> stops,
+namespace {
+
+// Порядок записей в индексах по названию, одноименные маршруты - по id
+template <typename Records>
+auto ByName(const Records& records)
+{
+    return [&records](uint32_t lhs, uint32_t rhs) {
+        return std::pair(records[lhs].name, lhs) <
+               std::pair(records[rhs].name, rhs);
+    };
+}
+
+// Новые записи занимают последние идентификаторы, поэтому в индекс
+// добавляются записи с id от sorted.size() до конца
+template <typename Records>
+void MergeNewRecords(const Records& records, std::vector<uint32_t>& sorted)
+{
+    const size_t old_size = sorted.size();
+    for (size_t id = old_size; id < records.size(); ++id) {
+        sorted.push_back(static_cast<uint32_t>(id));
+    }
+    const auto less = ByName(records);
+    std::sort(sorted.begin() + old_size, sorted.end(), less);
+    std::inplace_merge(sorted.begin(), sorted.begin() + old_size,
+                       sorted.end(), less);
+}
+
+template <typename Records>
+void InsertSorted(const Records& records, std::vector<uint32_t>& sorted,
+                  uint32_t id)
+{
+    sorted.insert(
+        std::upper_bound(sorted.begin(), sorted.end(), id, ByName(records)),
+        id);
+}
+
+template <typename Records>
+void EraseSorted(const Records& records, std::vector<uint32_t>& sorted,
+                 uint32_t id)
+{
+    sorted.erase(
+        std::lower_bound(sorted.begin(), sorted.end(), id, ByName(records)));
+}
+
+} // namespace
+
+void TransportCatalogue::AddRoute(std::string_view name,
+                                  const std::vector<std::string_view>& stops,
                                   bool is_roundtrip)
 {
-    std::vector<Stop*> tc_stops;
+    CheckNotFrozen();
+    std::vector<StopId> tc_stops;
+    tc_stops.reserve(stops.size());
     for (std::string_view stop : stops) {
-        std::unordered_map<std::string_view, Stop*>::iterator pos =
-            stopname_to_stop_.find(stop);
-        tc_stops.push_back(pos->second);
+        tc_stops.push_back(stopname_to_stop_.at(stop));
     }
-    routes_.push_back({std::move(name), std::move(tc_stops), is_roundtrip});
-    routename_to_route_[routes_.back().name] = &routes_.back();
+    InsertRoute(name, tc_stops, is_roundtrip);
+    IndexNewRecords();
 }
 
 void TransportCatalogue::AddStop(
-    const std::string name, const geo::Coordinates coordinates,
-    const std::unordered_map<std::string_view, size_t> length_data)
+    std::string_view name, geo::Coordinates coordinates,
+    const std::unordered_map<std::string_view, size_t>& length_data)
+{
+    CheckNotFrozen();
+    const StopId stop_id = InsertStop(name, coordinates);
+    for (const auto& [to, length] : length_data) {
+        SetLength(stop_id, GetOrAddStop(to), length);
+    }
+    IndexNewRecords();
+}
+
+void TransportCatalogue::AddBatch(const std::vector<StopData>& stops,
+                                  const std::vector<RouteData>& routes)
 {
-    if (stopname_to_stop_.count(name)) {
-        stopname_to_stop_.at(name)->coordinates = coordinates;
-    } else {
-        stops_.push_back({std::move(name), coordinates});
-        stopname_to_stop_[stops_.back().name] = &stops_.back();
+    CheckNotFrozen();
+
+    size_t distances_count = 0;
+    for (const StopData& stop : stops) {
+        distances_count += stop.road_distances.size();
     }
-    if (!length_data.empty()) {
-        AddLentghToStop(name, length_data);
+    ReserveStops(stops_.size() + stops.size());
+    routes_.reserve(routes_.size() + routes.size());
+    route_stats_.reserve(routes_.size() + routes.size());
+    routename_to_route_.reserve(routes_.size() + routes.size());
+    length_to_stops_.Reserve(length_to_stops_.Size() + distances_count);
+
+    std::vector<StopId> stop_ids;
+    stop_ids.reserve(stops.size());
+    for (const StopData& stop : stops) {
+        stop_ids.push_back(InsertStop(stop.name, stop.coordinates));
     }
+    for (size_t i = 0; i < stops.size(); ++i) {
+        for (const auto& [to, length] : stops[i].road_distances) {
+            SetLength(stop_ids[i], GetOrAddStop(to), length);
+        }
+    }
+
+    std::vector<StopId> route_stops;
+    for (const RouteData& route : routes) {
+        route_stops.clear();
+        for (std::string_view stop : route.stops) {
+            route_stops.push_back(GetOrAddStop(stop));
+        }
+        InsertRoute(route.name, route_stops, route.is_roundtrip);
+    }
+    IndexNewRecords();
 }
 
-std::optional<Stop*> TransportCatalogue::FindStop(std::string_view name) const
+void TransportCatalogue::ApplyDelta(const DeltaBatch& delta)
 {
-    auto it = stopname_to_stop_.find(name);
-    if (it != stopname_to_stop_.end()) {
-        return it->second;
+    CheckNotFrozen();
+    for (std::string_view name : delta.removed_routes) {
+        RemoveRoute(name);
+    }
+    for (const auto& [from, to] : delta.removed_distances) {
+        RemoveLengthFromTo(from, to);
+    }
+    for (std::string_view name : delta.removed_stops) {
+        RemoveStop(name);
+    }
+    for (const RouteData& route : delta.routes) {
+        if (const auto route_id = FindRouteId(route.name)) {
+            EraseRoute(*route_id);
+        }
+    }
+    AddBatch(delta.stops, delta.routes);
+    for (const DistanceData& distance : delta.distances) {
+        SetLength(GetOrAddStop(distance.from), GetOrAddStop(distance.to),
+                  distance.length);
+    }
+    IndexNewRecords();
+}
+
+void TransportCatalogue::RemoveRoute(std::string_view name)
+{
+    CheckNotFrozen();
+    EraseRoute(GetRouteId(name));
+}
+
+void TransportCatalogue::RemoveStop(std::string_view name)
+{
+    CheckNotFrozen();
+    const StopId stop_id = GetStopId(name);
+    if (!stop_to_routes_[stop_id].empty()) {
+        throw std::logic_error("Stop is used by routes");
+    }
+    EraseStop(stop_id);
+}
+
+void TransportCatalogue::RemoveLengthFromTo(std::string_view from,
+                                            std::string_view to)
+{
+    CheckNotFrozen();
+    const StopId from_id = GetStopId(from);
+    if (!length_to_stops_.Erase(from_id, GetStopId(to))) {
+        throw std::out_of_range("Distance not found");
+    }
+    InvalidateRoutesOnStop(from_id);
+}
+
+std::optional<StopView> TransportCatalogue::FindStop(
+    std::string_view name) const
+{
+    if (const auto stop_id = FindStopId(name)) {
+        return StopView(stops_[*stop_id]);
     }
     return std::nullopt;
 }
 
+const Stop& TransportCatalogue::GetStop(StopId id) const
+{
+    return stops_[id];
+}
+
 geo::Coordinates TransportCatalogue::GetStopCoordinates(
     std::string_view name) const
 {
-    return stopname_to_stop_.at(name)->coordinates;
+    return stops_[GetStopId(name)].coordinates;
 }
 
 std::set<std::string_view> TransportCatalogue::FindBusesOnStop(
     std::string_view name) const
 {
     std::set<std::string_view> buses;
-    for (const Route& route : routes_) {
-        if (std::find(route.stops.begin(), route.stops.end(),
-                      stopname_to_stop_.at(name)) != route.stops.end()) {
-            buses.insert(route.name);
-        }
+    for (RouteId route_id : stop_to_routes_[GetStopId(name)]) {
+        buses.insert(routes_[route_id].name);
     }
     return buses;
 }
 
-std::optional<Route> TransportCatalogue::FindRoute(std::string_view name) const
+std::optional<RouteView> TransportCatalogue::FindRoute(
+    std::string_view name) const
 {
-    auto it = routename_to_route_.find(name);
-    if (it != routename_to_route_.end()) {
-        return *it->second;
+    if (const auto route_id = FindRouteId(name)) {
+        return RouteView(routes_[*route_id]);
     }
     return std::nullopt;
 }
 
+const Route& TransportCatalogue::GetRoute(RouteId id) const
+{
+    return routes_[id];
+}
+
 RouteStats TransportCatalogue::GetRouteStats(std::string_view name) const
 {
-    return {GetRouteDistance(name), GetRouteLength(name),
-            GetStopsCount(name), GetUniqueStopsCount(name)};
+    return GetRouteStats(GetRouteId(name));
+}
+
+RouteStats TransportCatalogue::GetRouteStats(RouteId id) const
+{
+    const Route& route = routes_[id];
+    std::optional<RouteStats>& stats = route_stats_[route.id];
+    if (!stats) {
+        stats = ComputeRouteStats(route);
+    }
+    return *stats;
 }
 
 void TransportCatalogue::SetLengthFromTo(std::string_view from,
                                          std::string_view to, size_t length)
 {
-    if (!stopname_to_stop_.count(from)) {
-        AddStop(std::string(from), {91, 181},
-                std::unordered_map<std::string_view, size_t>());
-    }
-    if (!stopname_to_stop_.count(to)) {
-        AddStop(std::string(to), {91, 181},
-                std::unordered_map<std::string_view, size_t>());
-    }
-    length_to_stops_[{stopname_to_stop_.at(from),
-                      stopname_to_stop_.at(to)}] = length;
+    CheckNotFrozen();
+    SetLength(GetOrAddStop(from), GetOrAddStop(to), length);
+    IndexNewRecords();
 }
 
 size_t TransportCatalogue::GetLengthFromTo(std::string_view from,
                                            std::string_view to) const
 {
-    size_t length = 0;
-    if (length_to_stops_.count(
-            {stopname_to_stop_.at(from), stopname_to_stop_.at(to)})) {
-        length = length_to_stops_.at(
-            {stopname_to_stop_.at(from), stopname_to_stop_.at(to)});
-    } else if (length_to_stops_.count(
-                   {stopname_to_stop_.at(to), stopname_to_stop_.at(from)})) {
-        length = length_to_stops_.at(
-            {stopname_to_stop_.at(to), stopname_to_stop_.at(from)});
-    }
-    return length;
+    return GetLengthFromTo(GetStopId(from), GetStopId(to));
+}
+
+size_t TransportCatalogue::GetLengthFromTo(StopId from, StopId to) const
+{
+    return length_to_stops_.Get(from, to);
 }
 
 size_t TransportCatalogue::GetAllStopsCount() const
@@ -112,71 +250,528 @@ size_t TransportCatalogue::GetAllStopsCount() const
     return stops_.size();
 }
 
-const std::unordered_map<std::string_view, Stop*>&
-TransportCatalogue::GetStopNameToStop() const
+const std::vector<Stop>& TransportCatalogue::GetStops() const
 {
-    return stopname_to_stop_;
+    return stops_;
 }
 
-const std::deque<Route>& TransportCatalogue::GetRoutes() const
+const std::vector<Route>& TransportCatalogue::GetRoutes() const
 {
     return routes_;
 }
 
-size_t TransportCatalogue::GetStopsCount(std::string_view name) const
+std::span<const StopId> TransportCatalogue::GetSortedStops() const
+{
+    return sorted_stops_;
+}
+
+std::span<const RouteId> TransportCatalogue::GetSortedRoutes() const
+{
+    return sorted_routes_;
+}
+
+const DistanceTable& TransportCatalogue::GetDistanceTable() const
 {
-    return routename_to_route_.at(name)->stops.size();
+    return length_to_stops_;
 }
 
-size_t TransportCatalogue::GetUniqueStopsCount(std::string_view name) const
+const SpatialIndex& TransportCatalogue::GetStopIndex() const
 {
-    std::set<std::string_view> ustops;
-    for (auto i : routename_to_route_.at(name)->stops) {
-        ustops.insert(i->name);
+    if (!is_frozen_) {
+        throw std::logic_error("Transport catalogue is not frozen");
     }
-    return ustops.size();
+    return stop_index_;
 }
 
-double TransportCatalogue::GetRouteDistance(std::string_view name) const
+const NameSearchIndex& TransportCatalogue::GetStopSearchIndex() const
 {
-    double distance = 0;
+    if (!is_frozen_) {
+        throw std::logic_error("Transport catalogue is not frozen");
+    }
+    return stop_search_;
+}
 
-    if (routename_to_route_.count(name)) {
-        for (size_t i = 0; i < routename_to_route_.at(name)->stops.size() - 1;
-             ++i) {
-            distance += geo::ComputeDistance(
-                routename_to_route_.at(name)->stops.at(i)->coordinates,
-                routename_to_route_.at(name)->stops.at(i + 1)->coordinates);
+const NameSearchIndex& TransportCatalogue::GetRouteSearchIndex() const
+{
+    if (!is_frozen_) {
+        throw std::logic_error("Transport catalogue is not frozen");
+    }
+    return route_search_;
+}
+
+TransportCatalogue TransportCatalogue::FromRecords(
+    std::vector<Stop> stops, std::vector<Route> routes,
+    DistanceTable distances, std::shared_ptr<const void> storage)
+{
+    for (size_t i = 0; i < stops.size(); ++i) {
+        if (stops[i].id != i) {
+            throw std::invalid_argument("Stop ids must be dense");
         }
     }
-    return distance;
+    for (size_t i = 0; i < routes.size(); ++i) {
+        if (routes[i].id != i) {
+            throw std::invalid_argument("Route ids must be dense");
+        }
+        for (StopId stop_id : routes[i].stops) {
+            if (stop_id >= stops.size()) {
+                throw std::invalid_argument("Route refers to unknown stop");
+            }
+        }
+    }
+
+    TransportCatalogue catalogue;
+    catalogue.names_->Adopt(storage);
+    catalogue.route_stops_->Adopt(std::move(storage));
+    catalogue.stops_ = std::move(stops);
+    catalogue.stop_trig_.reserve(catalogue.stops_.size());
+    for (const Stop& stop : catalogue.stops_) {
+        catalogue.stop_trig_.push_back(
+            geo::ComputeLatitudeTrig(stop.coordinates.lat));
+    }
+    catalogue.routes_ = std::move(routes);
+    catalogue.length_to_stops_ = std::move(distances);
+    catalogue.stop_to_routes_.resize(catalogue.stops_.size());
+    catalogue.route_stats_.resize(catalogue.routes_.size());
+    for (const Route& route : catalogue.routes_) {
+        catalogue.IndexRouteStops(route);
+    }
+    catalogue.IndexNewRecords();
+    catalogue.Freeze();
+    return catalogue;
 }
 
-void TransportCatalogue::AddLentghToStop(
-    std::string_view name,
-    const std::unordered_map<std::string_view, size_t> length_data)
+void TransportCatalogue::Freeze()
 {
-    for (auto [stop, length] : length_data) {
-        SetLengthFromTo(name, stop, length);
+    if (is_frozen_) {
+        return;
+    }
+
+    BuildNameIndex();
+    stop_index_.Build(stops_);
+    std::vector<std::string_view> names;
+    names.reserve(std::max(stops_.size(), routes_.size()));
+    for (const Stop& stop : stops_) {
+        names.push_back(stop.name);
     }
+    stop_search_.Build(names);
+    names.clear();
+    for (const Route& route : routes_) {
+        names.push_back(route.name);
+    }
+    route_search_.Build(names);
+    std::unordered_map<std::string_view, StopId>().swap(stopname_to_stop_);
+    std::unordered_map<std::string_view, RouteId>().swap(routename_to_route_);
+    stops_.shrink_to_fit();
+    stop_trig_.shrink_to_fit();
+    routes_.shrink_to_fit();
+
+    for (const Route& route : routes_) {
+        if (!route_stats_[route.id]) {
+            route_stats_[route.id] = ComputeRouteStats(route);
+        }
+    }
+    is_frozen_ = true;
 }
 
-size_t TransportCatalogue::GetRouteLength(std::string_view name) const
+void TransportCatalogue::Unfreeze()
 {
-    size_t length = 0;
+    if (!is_frozen_) {
+        return;
+    }
+
+    stopname_to_stop_.reserve(stops_.size());
+    for (const Stop& stop : stops_) {
+        stopname_to_stop_[stop.name] = stop.id;
+    }
+    routename_to_route_.reserve(routes_.size());
+    for (const Route& route : routes_) {
+        routename_to_route_[route.name] = route.id;
+    }
+    // Снимки прежних версий могут хранить замененные маршруты с тем же
+    // названием: действует маршрут с наибольшим id, остальные удаляются
+    std::vector<RouteId> replaced;
+    for (const Route& route : routes_) {
+        if (routename_to_route_.at(route.name) != route.id) {
+            replaced.push_back(route.id);
+        }
+    }
+
+    stop_hash_ = PerfectHash();
+    std::vector<StopId>().swap(stop_slots_);
+    route_hash_ = PerfectHash();
+    std::vector<RouteId>().swap(route_slots_);
+    stop_index_ = SpatialIndex();
+    stop_search_ = NameSearchIndex();
+    route_search_ = NameSearchIndex();
+    is_frozen_ = false;
+
+    // По убыванию id: на место удаленного встает последний маршрут, а он
+    // уже не замененный
+    for (auto it = replaced.rbegin(); it != replaced.rend(); ++it) {
+        EraseRoute(*it);
+    }
+}
+
+void TransportCatalogue::Repack()
+{
+    CheckNotFrozen();
+    auto names = std::make_shared<NamePool>();
+    auto route_stops = std::make_shared<Arena>();
+
+    stopname_to_stop_.clear();
+    for (Stop& stop : stops_) {
+        stop.name = names->Intern(stop.name);
+        stopname_to_stop_[stop.name] = stop.id;
+    }
+    routename_to_route_.clear();
+    for (Route& route : routes_) {
+        route.name = names->Intern(route.name);
+        route.stops = route_stops->Copy<StopId>(route.stops);
+        routename_to_route_[route.name] = route.id;
+    }
+
+    names_ = std::move(names);
+    route_stops_ = std::move(route_stops);
+}
+
+bool TransportCatalogue::IsFrozen() const
+{
+    return is_frozen_;
+}
+
+std::optional<StopId> TransportCatalogue::FindStopId(
+    std::string_view name) const
+{
+    if (is_frozen_) {
+        if (stop_slots_.empty()) {
+            return std::nullopt;
+        }
+        const StopId stop_id = stop_slots_[stop_hash_(name)];
+        if (stops_[stop_id].name == name) {
+            return stop_id;
+        }
+        return std::nullopt;
+    }
+    auto it = stopname_to_stop_.find(name);
+    if (it != stopname_to_stop_.end()) {
+        return it->second;
+    }
+    return std::nullopt;
+}
+
+std::optional<RouteId> TransportCatalogue::FindRouteId(
+    std::string_view name) const
+{
+    if (is_frozen_) {
+        if (route_slots_.empty()) {
+            return std::nullopt;
+        }
+        const RouteId route_id = route_slots_[route_hash_(name)];
+        if (routes_[route_id].name == name) {
+            return route_id;
+        }
+        return std::nullopt;
+    }
+    auto it = routename_to_route_.find(name);
+    if (it != routename_to_route_.end()) {
+        return it->second;
+    }
+    return std::nullopt;
+}
 
-    if (routename_to_route_.count(name)) {
-        for (size_t i = 0; i < routename_to_route_.at(name)->stops.size() - 1;
-             ++i) {
-            length += GetLengthFromTo(
-                routename_to_route_.at(name)->stops.at(i)->name,
-                routename_to_route_.at(name)->stops.at(i + 1)->name);
+StopId TransportCatalogue::GetStopId(std::string_view name) const
+{
+    if (const auto stop_id = FindStopId(name)) {
+        return *stop_id;
+    }
+    throw std::out_of_range("Stop not found");
+}
+
+RouteId TransportCatalogue::GetRouteId(std::string_view name) const
+{
+    if (const auto route_id = FindRouteId(name)) {
+        return *route_id;
+    }
+    throw std::out_of_range("Route not found");
+}
+
+void TransportCatalogue::CheckNotFrozen() const
+{
+    if (is_frozen_) {
+        throw std::logic_error("Transport catalogue is frozen");
+    }
+}
+
+void TransportCatalogue::BuildNameIndex()
+{
+    // Названия остановок уникальны по построению
+    std::vector<std::string_view> stop_names;
+    stop_names.reserve(stops_.size());
+    for (const Stop& stop : stops_) {
+        stop_names.push_back(stop.name);
+    }
+    stop_hash_.Build(stop_names);
+    stop_slots_.assign(stop_names.size(), 0);
+    for (const Stop& stop : stops_) {
+        stop_slots_[stop_hash_(stop.name)] = stop.id;
+    }
+
+    // Снимки прежних версий могут хранить маршрут, описанный повторно:
+    // он заменяет прежний с тем же названием
+    std::vector<RouteId> route_ids(routes_.size());
+    for (RouteId id = 0; id < route_ids.size(); ++id) {
+        route_ids[id] = id;
+    }
+    std::sort(route_ids.begin(), route_ids.end(),
+              [this](RouteId lhs, RouteId rhs) {
+                  return std::pair(routes_[lhs].name, rhs) <
+                         std::pair(routes_[rhs].name, lhs);
+              });
+    const auto duplicates = std::unique(
+        route_ids.begin(), route_ids.end(), [this](RouteId lhs, RouteId rhs) {
+            return routes_[lhs].name == routes_[rhs].name;
+        });
+    route_ids.erase(duplicates, route_ids.end());
+
+    std::vector<std::string_view> route_names;
+    route_names.reserve(route_ids.size());
+    for (RouteId route_id : route_ids) {
+        route_names.push_back(routes_[route_id].name);
+    }
+    route_hash_.Build(route_names);
+    route_slots_.assign(route_names.size(), 0);
+    for (RouteId route_id : route_ids) {
+        route_slots_[route_hash_(routes_[route_id].name)] = route_id;
+    }
+}
+
+RouteStats TransportCatalogue::ComputeRouteStats(const Route& route) const
+{
+    return {GetRouteDistance(route), GetRouteLength(route),
+            route.GetStops().size(), GetUniqueStopsCount(route)};
+}
+
+size_t TransportCatalogue::GetUniqueStopsCount(const Route& route) const
+{
+    const uint32_t epoch = NextStopMarkEpoch();
+    size_t count = 0;
+    for (StopId stop_id : route.stops) {
+        if (stop_marks_[stop_id] != epoch) {
+            stop_marks_[stop_id] = epoch;
+            ++count;
         }
     }
-    length += GetLengthFromTo(
-        routename_to_route_.at(name)->stops.front()->name,
-        routename_to_route_.at(name)->stops.front()->name);
+    return count;
+}
+
+double TransportCatalogue::GetRouteDistance(const Route& route) const
+{
+    double distance = 0;
+    const RouteStops stops = route.GetStops();
+    for (size_t i = 1; i < stops.size(); ++i) {
+        const StopId from = stops[i - 1];
+        const StopId to = stops[i];
+        distance += geo::ComputeDistance(stops_[from].coordinates,
+                                         stop_trig_[from],
+                                         stops_[to].coordinates,
+                                         stop_trig_[to]);
+    }
+    return distance;
+}
+
+size_t TransportCatalogue::GetRouteLength(const Route& route) const
+{
+    size_t length = 0;
+    const RouteStops stops = route.GetStops();
+    for (size_t i = 1; i < stops.size(); ++i) {
+        length += GetLengthFromTo(stops[i - 1], stops[i]);
+    }
+    if (!stops.empty()) {
+        length += GetLengthFromTo(stops.front(), stops.front());
+    }
     return length;
 }
 
+StopId TransportCatalogue::InsertStop(std::string_view name,
+                                      geo::Coordinates coordinates)
+{
+    if (const auto it = stopname_to_stop_.find(name);
+        it != stopname_to_stop_.end()) {
+        Stop& stop = stops_[it->second];
+        if (stop.coordinates != coordinates) {
+            stop.coordinates = coordinates;
+            stop_trig_[stop.id] = geo::ComputeLatitudeTrig(coordinates.lat);
+            InvalidateRoutesOnStop(stop.id);
+        }
+        return stop.id;
+    }
+    const StopId stop_id = static_cast<StopId>(stops_.size());
+    stops_.push_back({names_->Intern(name), coordinates, stop_id});
+    stop_trig_.push_back(geo::ComputeLatitudeTrig(coordinates.lat));
+    stopname_to_stop_.emplace(stops_.back().name, stop_id);
+    stop_to_routes_.emplace_back();
+    return stop_id;
+}
+
+StopId TransportCatalogue::GetOrAddStop(std::string_view name)
+{
+    if (const auto it = stopname_to_stop_.find(name);
+        it != stopname_to_stop_.end()) {
+        return it->second;
+    }
+    return InsertStop(name, UNKNOWN_COORDINATES);
+}
+
+RouteId TransportCatalogue::InsertRoute(std::string_view name,
+                                        std::span<const StopId> stops,
+                                        bool is_roundtrip)
+{
+    // Названия маршрутов уникальны: повторно описанный маршрут, в том
+    // числе добавленный тем же пакетом, заменяет прежний
+    if (const auto it = routename_to_route_.find(name);
+        it != routename_to_route_.end()) {
+        EraseRoute(it->second);
+    }
+    const RouteId route_id = static_cast<RouteId>(routes_.size());
+    routes_.push_back({names_->Intern(name), route_stops_->Copy(stops),
+                       is_roundtrip, route_id});
+    routename_to_route_[routes_.back().name] = route_id;
+    route_stats_.emplace_back(std::nullopt);
+    IndexRouteStops(routes_.back());
+    return route_id;
+}
+
+void TransportCatalogue::IndexRouteStops(const Route& route)
+{
+    const uint32_t epoch = NextStopMarkEpoch();
+    for (StopId stop_id : route.stops) {
+        if (stop_marks_[stop_id] != epoch) {
+            stop_marks_[stop_id] = epoch;
+            stop_to_routes_[stop_id].push_back(route.id);
+        }
+    }
+}
+
+void TransportCatalogue::EraseRoute(RouteId route_id)
+{
+    // Последний маршрут занимает место удаленного, чтобы идентификаторы
+    // оставались плотными
+    IndexNewRecords();
+    const auto replace = [this](const Route& route, RouteId from,
+                                std::optional<RouteId> to) {
+        const uint32_t epoch = NextStopMarkEpoch();
+        for (StopId stop_id : route.stops) {
+            if (stop_marks_[stop_id] == epoch) {
+                continue;
+            }
+            stop_marks_[stop_id] = epoch;
+            std::vector<RouteId>& routes = stop_to_routes_[stop_id];
+            const auto it = std::find(routes.begin(), routes.end(), from);
+            if (to) {
+                *it = *to;
+            } else {
+                routes.erase(it);
+            }
+        }
+    };
+
+    replace(routes_[route_id], route_id, std::nullopt);
+    EraseSorted(routes_, sorted_routes_, route_id);
+    if (const auto it = routename_to_route_.find(routes_[route_id].name);
+        it != routename_to_route_.end() && it->second == route_id) {
+        routename_to_route_.erase(it);
+    }
+
+    const RouteId last_id = static_cast<RouteId>(routes_.size() - 1);
+    if (route_id != last_id) {
+        EraseSorted(routes_, sorted_routes_, last_id);
+        Route& route = routes_[route_id];
+        route = routes_[last_id];
+        route.id = route_id;
+        route_stats_[route_id] = route_stats_[last_id];
+        replace(route, last_id, route_id);
+        if (const auto it = routename_to_route_.find(route.name);
+            it != routename_to_route_.end() && it->second == last_id) {
+            it->second = route_id;
+        }
+        InsertSorted(routes_, sorted_routes_, route_id);
+    }
+    routes_.pop_back();
+    route_stats_.pop_back();
+}
+
+void TransportCatalogue::EraseStop(StopId stop_id)
+{
+    // Последняя остановка занимает место удаленной. Списки остановок
+    // маршрутов через нее копируются заново: прежние копии остаются в
+    // арене, пока её не заменит Repack.
+    IndexNewRecords();
+    stopname_to_stop_.erase(stops_[stop_id].name);
+    EraseSorted(stops_, sorted_stops_, stop_id);
+    const StopId last_id = static_cast<StopId>(stops_.size() - 1);
+    length_to_stops_.RemoveStop(stop_id, last_id);
+    if (stop_id != last_id) {
+        EraseSorted(stops_, sorted_stops_, last_id);
+        Stop& stop = stops_[stop_id];
+        stop = stops_[last_id];
+        stop.id = stop_id;
+        stop_trig_[stop_id] = stop_trig_[last_id];
+        stopname_to_stop_[stop.name] = stop_id;
+        stop_to_routes_[stop_id] = std::move(stop_to_routes_[last_id]);
+        InsertSorted(stops_, sorted_stops_, stop_id);
+
+        std::vector<StopId> route_stops;
+        for (RouteId route_id : stop_to_routes_[stop_id]) {
+            Route& route = routes_[route_id];
+            route_stops.assign(route.stops.begin(), route.stops.end());
+            std::replace(route_stops.begin(), route_stops.end(), last_id,
+                         stop_id);
+            route.stops = route_stops_->Copy<StopId>(route_stops);
+        }
+    }
+    stops_.pop_back();
+    stop_trig_.pop_back();
+    stop_to_routes_.pop_back();
+}
+
+void TransportCatalogue::SetLength(StopId from, StopId to, size_t length)
+{
+    length_to_stops_.Set(from, to, length);
+    InvalidateRoutesOnStop(from);
+}
+
+void TransportCatalogue::IndexNewRecords()
+{
+    MergeNewRecords(stops_, sorted_stops_);
+    MergeNewRecords(routes_, sorted_routes_);
+}
+
+void TransportCatalogue::ReserveStops(size_t count)
+{
+    stops_.reserve(count);
+    sorted_stops_.reserve(count);
+    stop_trig_.reserve(count);
+    stopname_to_stop_.reserve(count);
+    stop_to_routes_.reserve(count);
+}
+
+uint32_t TransportCatalogue::NextStopMarkEpoch() const
+{
+    if (stop_marks_.size() < stops_.size()) {
+        stop_marks_.resize(stops_.size(), 0);
+    }
+    if (++stop_mark_epoch_ == 0) {
+        std::fill(stop_marks_.begin(), stop_marks_.end(), 0);
+        stop_mark_epoch_ = 1;
+    }
+    return stop_mark_epoch_;
+}
+
+void TransportCatalogue::InvalidateRoutesOnStop(StopId stop_id)
+{
+    for (RouteId route_id : stop_to_routes_[stop_id]) {
+        route_stats_[route_id].reset();
+    }
+}
+
 } // namespace transport_catalogue
\ No newline at end of file
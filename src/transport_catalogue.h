@@ -2,13 +2,21 @@
 
 #pragma once
 
+#include "arena.h"
+#include "distance_table.h"
 #include "domain.h"
+#include "name_pool.h"
+#include "name_search.h"
+#include "perfect_hash.h"
+#include "spatial_index.h"
 
 #include <algorithm>
-#include <deque>
+#include <cstdint>
 #include <functional>
+#include <memory>
 #include <optional>
 #include <set>
+#include <span>
 #include <string>
 #include <string_view>
 #include <unordered_map>
@@ -19,53 +27,202 @@ namespace transport_catalogue {
 
 using namespace domain;
 
+// Координаты остановки, которая упомянута раньше, чем описана
+inline const geo::Coordinates UNKNOWN_COORDINATES{91, 181};
+
+// Описания для пакетной загрузки. Строки должны быть действительны только
+// на время вызова AddBatch: названия копируются в пул каталога.
+struct StopData {
+    std::string_view name;
+    geo::Coordinates coordinates;
+    std::vector<std::pair<std::string_view, size_t>> road_distances;
+};
+
+struct RouteData {
+    std::string_view name;
+    std::vector<std::string_view> stops;
+    bool is_roundtrip;
+};
+
+struct DistanceData {
+    std::string_view from;
+    std::string_view to;
+    size_t length;
+};
+
+// Пакет изменений каталога. Применяется в порядке: удаление маршрутов,
+// расстояний и остановок, затем добавление и обновление остановок,
+// маршрутов и расстояний. Маршрут с существующим названием заменяет
+// прежний; остановка с существующим названием получает новые координаты.
+struct DeltaBatch {
+    std::vector<StopData> stops;
+    std::vector<RouteData> routes;
+    std::vector<DistanceData> distances;
+    std::vector<std::string_view> removed_routes;
+    std::vector<std::pair<std::string_view, std::string_view>>
+        removed_distances;
+    std::vector<std::string_view> removed_stops;
+};
+
 class TransportCatalogue {
 public:
-    void AddRoute(const std::string name,
-                  std::vector<std::string_view> stops, bool is_roundtrip);
+    void AddRoute(std::string_view name,
+                  const std::vector<std::string_view>& stops,
+                  bool is_roundtrip);
 
-    void AddStop(const std::string name, const geo::Coordinates coordinates,
-                 const std::unordered_map<std::string_view, size_t>
+    void AddStop(std::string_view name, geo::Coordinates coordinates,
+                 const std::unordered_map<std::string_view, size_t>&
                      length_data);
 
-    std::optional<Stop*> FindStop(std::string_view name) const;
+    // Добавляет пакет остановок, расстояний и маршрутов за один проход,
+    // заранее резервируя память. Может вызываться для последовательных
+    // пакетов; остановки, упомянутые до своего описания, создаются с
+    // UNKNOWN_COORDINATES и уточняются при появлении описания.
+    void AddBatch(const std::vector<StopData>& stops,
+                  const std::vector<RouteData>& routes);
+
+    void ApplyDelta(const DeltaBatch& delta);
+
+    void RemoveRoute(std::string_view name);
+
+    // Удалить можно только остановку, через которую не проходят маршруты.
+    // Идентификатор последней остановки переходит к удаленной.
+    void RemoveStop(std::string_view name);
+
+    void RemoveLengthFromTo(std::string_view from, std::string_view to);
+
+    std::optional<StopView> FindStop(std::string_view name) const;
+
+    const Stop& GetStop(StopId id) const;
 
     geo::Coordinates GetStopCoordinates(std::string_view name) const;
 
     std::set<std::string_view> FindBusesOnStop(std::string_view name) const;
 
-    std::optional<Route> FindRoute(std::string_view name) const;
+    std::optional<RouteView> FindRoute(std::string_view name) const;
+
+    const Route& GetRoute(RouteId id) const;
 
     RouteStats GetRouteStats(std::string_view name) const;
 
+    RouteStats GetRouteStats(RouteId id) const;
+
     void SetLengthFromTo(std::string_view from, std::string_view to,
                          size_t length);
 
     size_t GetLengthFromTo(std::string_view from,
                            std::string_view to) const;
 
+    size_t GetLengthFromTo(StopId from, StopId to) const;
+
     size_t GetAllStopsCount() const;
 
-    const std::unordered_map<std::string_view, Stop*>& GetStopNameToStop()
-        const;
+    const std::vector<Stop>& GetStops() const;
+
+    const std::vector<Route>& GetRoutes() const;
+
+    // Идентификаторы остановок и маршрутов в порядке названий. Индексы
+    // пополняются слиянием при каждом добавлении записей.
+    std::span<const StopId> GetSortedStops() const;
+    std::span<const RouteId> GetSortedRoutes() const;
+
+    const DistanceTable& GetDistanceTable() const;
+
+    // Пространственный индекс остановок строится при заморозке каталога
+    const SpatialIndex& GetStopIndex() const;
+
+    // Поисковые индексы названий строятся при заморозке каталога,
+    // идентификатор названия совпадает с id остановки или маршрута
+    const NameSearchIndex& GetStopSearchIndex() const;
+    const NameSearchIndex& GetRouteSearchIndex() const;
+
+    // Собирает замороженный каталог из готовых записей, например
+    // прочитанных из бинарного снимка. Названия и списки остановок записей
+    // могут ссылаться на память storage, которую каталог удерживает.
+    static TransportCatalogue FromRecords(
+        std::vector<Stop> stops, std::vector<Route> routes,
+        DistanceTable distances, std::shared_ptr<const void> storage);
+
+    // Переводит каталог в режим только для чтения: поиск по названию
+    // переходит на совершенные хэш-функции, хэш-таблицы названий
+    // освобождаются, статистика всех маршрутов вычисляется заранее,
+    // строятся пространственный индекс остановок и поисковые индексы
+    // названий.
+    // Замороженный каталог не изменяется и может читаться из нескольких
+    // потоков одновременно. Последующие изменения каталога запрещены.
+    void Freeze();
+
+    // Возвращает каталог в изменяемое состояние. Используется при
+    // подготовке новой версии каталога из копии замороженной.
+    void Unfreeze();
+
+    // Переносит названия и списки остановок маршрутов в новые пул и арену
+    // этой копии каталога. Пул и арена только пополняются, поэтому после
+    // удалений и замен в них остаются записи, на которые никто не
+    // ссылается; прежние пул и арена освобождаются, когда их отпускают
+    // остальные копии каталога. Только для изменяемого каталога.
+    void Repack();
 
-    const std::deque<Route>& GetRoutes() const;
+    bool IsFrozen() const;
 
 private:
-    std::deque<Stop> stops_;
-    std::unordered_map<std::string_view, Stop*> stopname_to_stop_;
-    std::deque<Route> routes_;
-    std::unordered_map<std::string_view, Route*> routename_to_route_;
-    std::unordered_map<std::pair<Stop*, Stop*>, size_t, HasherPairPtr>
-        length_to_stops_;
-
-    double GetRouteDistance(std::string_view name) const;
-    size_t GetRouteLength(std::string_view name) const;
-    size_t GetStopsCount(std::string_view name) const;
-    size_t GetUniqueStopsCount(std::string_view name) const;
-    void AddLentghToStop(
-        std::string_view name,
-        const std::unordered_map<std::string_view, size_t> length_data);
+    // Названия общие для всех копий каталога: пул только пополняется,
+    // поэтому string_view в записях старых копий остаются действительными.
+    // Repack заменяет пул и арену копии новыми.
+    std::shared_ptr<NamePool> names_ = std::make_shared<NamePool>();
+    // Списки остановок маршрутов, общие для копий по той же причине
+    std::shared_ptr<Arena> route_stops_ = std::make_shared<Arena>();
+    std::vector<Stop> stops_;
+    // Синус и косинус широты остановок (индекс - id остановки)
+    std::vector<geo::LatitudeTrig> stop_trig_;
+    std::unordered_map<std::string_view, StopId> stopname_to_stop_;
+    std::vector<Route> routes_;
+    std::unordered_map<std::string_view, RouteId> routename_to_route_;
+    DistanceTable length_to_stops_;
+    std::vector<StopId> sorted_stops_;
+    std::vector<RouteId> sorted_routes_;
+
+    bool is_frozen_ = false;
+    PerfectHash stop_hash_;
+    std::vector<StopId> stop_slots_;
+    PerfectHash route_hash_;
+    std::vector<RouteId> route_slots_;
+    SpatialIndex stop_index_;
+    NameSearchIndex stop_search_;
+    NameSearchIndex route_search_;
+
+    // Маршруты, проходящие через остановку (индекс - id остановки)
+    std::vector<std::vector<RouteId>> stop_to_routes_;
+    // Кэш статистики маршрутов (индекс - id маршрута), сбрасывается при
+    // изменении координат остановок маршрута или расстояний между ними
+    mutable std::vector<std::optional<RouteStats>> route_stats_;
+    // Отметки посещения остановок для подсчета уникальных остановок
+    mutable std::vector<uint32_t> stop_marks_;
+    mutable uint32_t stop_mark_epoch_ = 0;
+
+    std::optional<StopId> FindStopId(std::string_view name) const;
+    std::optional<RouteId> FindRouteId(std::string_view name) const;
+    StopId GetStopId(std::string_view name) const;
+    RouteId GetRouteId(std::string_view name) const;
+    void CheckNotFrozen() const;
+    void BuildNameIndex();
+    void IndexRouteStops(const Route& route);
+
+    RouteStats ComputeRouteStats(const Route& route) const;
+    double GetRouteDistance(const Route& route) const;
+    size_t GetRouteLength(const Route& route) const;
+    size_t GetUniqueStopsCount(const Route& route) const;
+    StopId InsertStop(std::string_view name, geo::Coordinates coordinates);
+    StopId GetOrAddStop(std::string_view name);
+    RouteId InsertRoute(std::string_view name,
+                        std::span<const StopId> stops, bool is_roundtrip);
+    void EraseRoute(RouteId route_id);
+    void EraseStop(StopId stop_id);
+    void SetLength(StopId from, StopId to, size_t length);
+    void IndexNewRecords();
+    void ReserveStops(size_t count);
+    uint32_t NextStopMarkEpoch() const;
+    void InvalidateRoutesOnStop(StopId stop_id);
 };
 
 } // namespace transport_catalogue
\ No newline at end of file
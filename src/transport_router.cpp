@@ -2,6 +2,11 @@
 
 #include "transport_router.h"
 
+#include <algorithm>
+#include <cassert>
+#include <future>
+#include <thread>
+
 namespace router {
 
 TransportRouter::TransportRouter(
@@ -14,6 +19,11 @@ TransportRouter::TransportRouter(
     BuildRouter(catalogue);
 }
 
+TransportRouter::TransportRouter(domain::RouterSettings router_settings)
+    : router_settings_(router_settings)
+{
+}
+
 void TransportRouter::BuildRouter(
     const transport_catalogue::TransportCatalogue& catalogue)
 {
@@ -24,6 +34,9 @@ void TransportRouter::BuildRouter(
 std::optional<domain::RouteInfo> TransportRouter::GetRouteInfo(
     graph::VertexId start, graph::VertexId end) const
 {
+    if (!router_) {
+        return std::nullopt;
+    }
     const auto& route_info = router_->BuildRoute(start, end);
     if (route_info) {
         domain::RouteInfo result;
@@ -38,17 +51,105 @@ std::optional<domain::RouteInfo> TransportRouter::GetRouteInfo(
     }
 }
 
-const std::variant<domain::StopEdge, domain::BusEdge>&
-TransportRouter::GetEdge(graph::EdgeId id) const
+std::optional<domain::RouteInfo> TransportRouter::GetRouteInfo(
+    const std::vector<domain::RouteEndpoint>& sources,
+    const std::vector<domain::RouteEndpoint>& targets) const
+{
+    if (!router_) {
+        return std::nullopt;
+    }
+    // Кратчайшие пути между всеми парами вершин уже посчитаны, поэтому
+    // достаточно перебрать пары начальной и конечной остановок
+    const domain::RouteEndpoint* best_source = nullptr;
+    const domain::RouteEndpoint* best_target = nullptr;
+    double best_time = 0;
+    for (const domain::RouteEndpoint& source : sources) {
+        for (const domain::RouteEndpoint& target : targets) {
+            const std::optional<double> time = router_->GetWeight(
+                stopid_to_vertexid_[source.stop_id].bus_wait_start,
+                stopid_to_vertexid_[target.stop_id].bus_wait_start);
+            if (!time) {
+                continue;
+            }
+            const double total_time =
+                source.walk_time + *time + target.walk_time;
+            if (!best_source || total_time < best_time) {
+                best_source = &source;
+                best_target = &target;
+                best_time = total_time;
+            }
+        }
+    }
+    if (!best_source) {
+        return std::nullopt;
+    }
+
+    domain::RouteInfo result;
+    result.total_time = best_time;
+    if (best_source->walk_time > 0) {
+        result.edges.emplace_back(domain::WalkEdge{
+            std::nullopt, best_source->stop_id, best_source->walk_time});
+    }
+    const auto route = router_->BuildRoute(
+        stopid_to_vertexid_[best_source->stop_id].bus_wait_start,
+        stopid_to_vertexid_[best_target->stop_id].bus_wait_start);
+    for (const auto edge : route->edges) {
+        result.edges.push_back(GetEdge(edge));
+    }
+    if (best_target->walk_time > 0) {
+        result.edges.emplace_back(domain::WalkEdge{
+            best_target->stop_id, std::nullopt, best_target->walk_time});
+    }
+    return result;
+}
+
+std::optional<double> TransportRouter::GetWeight(graph::VertexId start,
+                                                graph::VertexId end) const
+{
+    if (!router_) {
+        return std::nullopt;
+    }
+    return router_->GetWeight(start, end);
+}
+
+double TransportRouter::GetWalkTime(double distance) const
+{
+    return distance /
+           (router_settings_.pedestrian_velocity * KILOMETER / HOUR);
+}
+
+const domain::RouterSettings& TransportRouter::GetSettings() const
 {
-    return edgeid_to_edge_.at(id);
+    return router_settings_;
+}
+
+size_t TransportRouter::GetMemoryUsage() const
+{
+    if (!router_) {
+        return 0;
+    }
+    return graph_->GetEdgeCount() *
+               (sizeof(graph::Edge<double>) + sizeof(graph::EdgeId) +
+                sizeof(domain::RouteItem)) +
+           router_->GetMemoryUsage() +
+           stopid_to_vertexid_.size() * sizeof(domain::StopVertexIds);
+}
+
+const domain::RouteItem& TransportRouter::GetEdge(graph::EdgeId id) const
+{
+    return edgeid_to_edge_[id];
+}
+
+const graph::DirectedWeightedGraph<double>* TransportRouter::GetGraph() const
+{
+    return graph_.get();
 }
 
 std::optional<domain::StopVertexIds> TransportRouter::GetVertexIdByStop(
-    domain::Stop* stop) const
+    domain::StopId stop_id) const
 {
-    if (stopptr_to_vertexid_.count(stop)) {
-        return stopptr_to_vertexid_.at(stop);
+    if (stop_id < stopid_to_vertexid_.size()) {
+        return stopid_to_vertexid_[stop_id];
     } else {
         return std::nullopt;
     }
@@ -57,33 +158,40 @@ std::optional<domain::StopVertexIds> TransportRouter::GetVertexIdByStop(
 void TransportRouter::SetGraph(
     const transport_catalogue::TransportCatalogue& catalogue)
 {
-    SetStopVertices(catalogue.GetStopNameToStop());
+    SetStopVertices(catalogue.GetAllStopsCount());
     AddEdgeToStop();
     AddEdgeToBus(catalogue);
+    if (router_settings_.walk_transfer_radius > 0) {
+        AddWalkEdges(catalogue);
+    }
 }
 
-void TransportRouter::SetStopVertices(
-    const std::unordered_map<std::string_view, domain::Stop*>&
-        stopname_to_stop_)
+void TransportRouter::SetStopVertices(size_t stops_count)
 {
-    size_t i = 0;
-    for (const auto& [name, ptr] : stopname_to_stop_) {
-        graph::VertexId first = i++;
-        graph::VertexId second = i++;
-
-        stopptr_to_vertexid_[ptr] = domain::StopVertexIds{first, second};
+    stopid_to_vertexid_.reserve(stops_count);
+    for (size_t i = 0; i < stops_count; ++i) {
+        stopid_to_vertexid_.push_back(
+            domain::StopVertexIds{2 * i, 2 * i + 1});
     }
 }
 
-void TransportRouter::AddEdgeToStop()
+void TransportRouter::AddEdge(const graph::Edge<double>& edge,
+                              domain::RouteItem info)
 {
-    for (const auto [stop, number] : stopptr_to_vertexid_) {
-        graph::EdgeId id = graph_->AddEdge(
-            graph::Edge<double>{number.bus_wait_start, number.bus_wait_end,
-                                router_settings_.bus_wait_time});
+    [[maybe_unused]] graph::EdgeId id = graph_->AddEdge(edge);
+    assert(id == edgeid_to_edge_.size());
+    edgeid_to_edge_.push_back(std::move(info));
+}
 
-        edgeid_to_edge_[id] =
-            domain::StopEdge{stop, router_settings_.bus_wait_time};
+void TransportRouter::AddEdgeToStop()
+{
+    for (domain::StopId stop_id = 0; stop_id < stopid_to_vertexid_.size();
+         ++stop_id) {
+        const domain::StopVertexIds& number = stopid_to_vertexid_[stop_id];
+        AddEdge(graph::Edge<double>{number.bus_wait_start,
+                                    number.bus_wait_end,
+                                    router_settings_.bus_wait_time},
+                domain::StopEdge{stop_id, router_settings_.bus_wait_time});
     }
 }
 
@@ -91,43 +199,96 @@ void TransportRouter::AddEdgeToBus(
     const transport_catalogue::TransportCatalogue& catalogue)
 {
     for (const auto& route : catalogue.GetRoutes()) {
-        for (auto it_1 : std::ranges::views::iota(route.stops.begin(),
-                                                  route.stops.end())) {
+        const domain::RouteStops stops = route.GetStops();
+        const size_t count = stops.size();
+
+        for (size_t from = 0; from < count; ++from) {
             size_t distance = 0;
             size_t span = 0;
-            for (auto it_2 : std::ranges::views::iota(std::next(it_1),
-                                                      route.stops.end())) {
-                distance += catalogue.GetLengthFromTo(
-                    (*std::prev(it_2))->name, (*it_2)->name);
+            for (size_t to = from + 1; to < count; ++to) {
+                distance +=
+                    catalogue.GetLengthFromTo(stops[to - 1], stops[to]);
                 ++span;
-
-                graph::EdgeId id = graph_->AddEdge(graph::Edge<double>{
-                    stopptr_to_vertexid_.at(*it_1).bus_wait_end,
-                    stopptr_to_vertexid_.at(*it_2).bus_wait_start,
-                    CalcWeight(distance)});
-                edgeid_to_edge_[id] =
-                    domain::BusEdge{&route, span, graph_->GetEdge(id).weight};
+                AddBusEdge(route, stops[from], stops[to], distance, span);
             }
         }
         if (!route.is_roundtrip) {
+            // Обход в обратном порядке; расстояние и число пролетов
+            // накапливаются по всем начальным остановкам
             size_t distance = 0;
             size_t span = 0;
-            for (auto it_1 : std::ranges::views::iota(route.stops.rbegin(),
-                                                      route.stops.rend())) {
-                for (auto it_2 : std::ranges::views::iota(std::next(it_1),
-                                                          route.stops.rend())) {
-                    distance += catalogue.GetLengthFromTo(
-                        (*std::prev(it_2))->name, (*it_2)->name);
+            for (size_t from = count; from-- > 0;) {
+                for (size_t to = from; to-- > 0;) {
+                    distance +=
+                        catalogue.GetLengthFromTo(stops[to + 1], stops[to]);
                     ++span;
+                    AddBusEdge(route, stops[from], stops[to], distance,
+                               span);
+                }
+            }
+        }
+    }
+}
+
+void TransportRouter::AddBusEdge(const domain::Route& route,
+                                 domain::StopId from, domain::StopId to,
+                                 size_t distance, size_t span)
+{
+    const double weight = CalcWeight(distance);
+    AddEdge(graph::Edge<double>{stopid_to_vertexid_[from].bus_wait_end,
+                                stopid_to_vertexid_[to].bus_wait_start,
+                                weight},
+            domain::BusEdge{route.id, span, weight});
+}
 
-                    graph::EdgeId id = graph_->AddEdge(graph::Edge<double>{
-                        stopptr_to_vertexid_.at(*it_1).bus_wait_end,
-                        stopptr_to_vertexid_.at(*it_2).bus_wait_start,
-                        CalcWeight(distance)});
-                    edgeid_to_edge_[id] = domain::BusEdge{
-                        &route, span, graph_->GetEdge(id).weight};
+void TransportRouter::AddWalkEdges(
+    const transport_catalogue::TransportCatalogue& catalogue)
+{
+    transport_catalogue::SpatialIndex own_index;
+    if (!catalogue.IsFrozen()) {
+        own_index.Build(catalogue.GetStops());
+    }
+    const transport_catalogue::SpatialIndex& index =
+        catalogue.IsFrozen() ? catalogue.GetStopIndex() : own_index;
+    const std::vector<domain::Stop>& stops = catalogue.GetStops();
+    const double radius = router_settings_.walk_transfer_radius;
+
+    // Соседей ищут несколько потоков, каждый по своей части остановок.
+    // Части объединяются по порядку, поэтому набор и порядок ребер не
+    // зависят от числа потоков.
+    const size_t threads =
+        std::max<size_t>(1, std::thread::hardware_concurrency());
+    const size_t chunk = (stops.size() + threads - 1) / threads;
+    std::vector<std::future<std::vector<domain::WalkEdge>>> parts;
+    for (size_t begin = 0; begin < stops.size(); begin += chunk) {
+        const size_t end = std::min(stops.size(), begin + chunk);
+        parts.push_back(std::async(std::launch::async, [&, begin, end] {
+            std::vector<domain::WalkEdge> edges;
+            for (size_t i = begin; i < end; ++i) {
+                const domain::Stop& stop = stops[i];
+                if (stop.coordinates ==
+                    transport_catalogue::UNKNOWN_COORDINATES) {
+                    continue;
+                }
+                for (const auto& [stop_id, distance] :
+                     index.FindWithin(stop.coordinates, radius)) {
+                    if (stop_id != stop.id) {
+                        edges.push_back(
+                            {stop.id, stop_id, GetWalkTime(distance)});
+                    }
                 }
             }
+            return edges;
+        }));
+    }
+
+    for (auto& part : parts) {
+        for (const domain::WalkEdge& edge : part.get()) {
+            AddEdge(graph::Edge<double>{
+                        stopid_to_vertexid_[*edge.from].bus_wait_start,
+                        stopid_to_vertexid_[*edge.to].bus_wait_start,
+                        edge.time},
+                    edge);
         }
     }
 }
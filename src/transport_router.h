@@ -8,8 +8,9 @@
 #include "transport_catalogue.h"
 
 #include <memory>
-#include <ranges>
+#include <optional>
 #include <variant>
+#include <vector>
 
 namespace router {
 
@@ -21,33 +22,57 @@ public:
     TransportRouter(const transport_catalogue::TransportCatalogue& catalogue,
                     domain::RouterSettings router_settings, size_t graph_size);
 
+    // Маршрутизатор без графа: только настройки и время пешего пути.
+    // Маршрутов не находит; нужен, когда их строит PartitionedRouter.
+    explicit TransportRouter(domain::RouterSettings router_settings);
+
     std::optional<domain::RouteInfo> GetRouteInfo(graph::VertexId start,
                                                   graph::VertexId end) const;
 
-    const std::variant<domain::StopEdge, domain::BusEdge>& GetEdge(
-        graph::EdgeId id) const;
+    // Время кратчайшего пути между вершинами без восстановления ребер
+    std::optional<double> GetWeight(graph::VertexId start,
+                                    graph::VertexId end) const;
+
+    // Самый быстрый маршрут от любой из sources до любой из targets с
+    // учетом пешего пути до них; пеший путь попадает в маршрут как WalkEdge
+    std::optional<domain::RouteInfo> GetRouteInfo(
+        const std::vector<domain::RouteEndpoint>& sources,
+        const std::vector<domain::RouteEndpoint>& targets) const;
+
+    // Время пешего пути в минутах для расстояния в метрах
+    double GetWalkTime(double distance) const;
+
+    const domain::RouterSettings& GetSettings() const;
+
+    // Оценка памяти графа, таблицы кратчайших путей и описаний ребер
+    size_t GetMemoryUsage() const;
+
+    const domain::RouteItem& GetEdge(graph::EdgeId id) const;
+
+    // Граф маршрутизатора; nullptr у маршрутизатора без графа
+    const graph::DirectedWeightedGraph<double>* GetGraph() const;
 
     std::optional<domain::StopVertexIds> GetVertexIdByStop(
-        domain::Stop* stop) const;
+        domain::StopId stop_id) const;
 
 private:
     std::unique_ptr<graph::DirectedWeightedGraph<double>> graph_;
     domain::RouterSettings router_settings_;
 
     std::unique_ptr<graph::Router<double>> router_;
-    std::unordered_map<domain::Stop*, domain::StopVertexIds>
-        stopptr_to_vertexid_;
-    std::unordered_map<graph::EdgeId,
-                       std::variant<domain::StopEdge, domain::BusEdge>>
-        edgeid_to_edge_;
+    std::vector<domain::StopVertexIds> stopid_to_vertexid_;
+    std::vector<domain::RouteItem> edgeid_to_edge_;
 
     void BuildRouter(const transport_catalogue::TransportCatalogue& catalogue);
     void SetGraph(const transport_catalogue::TransportCatalogue& catalogue);
-    void SetStopVertices(
-        const std::unordered_map<std::string_view, domain::Stop*>&
-            stopname_to_stop_);
+    void SetStopVertices(size_t stops_count);
+    void AddEdge(const graph::Edge<double>& edge, domain::RouteItem info);
     void AddEdgeToStop();
     void AddEdgeToBus(const transport_catalogue::TransportCatalogue& catalogue);
+    void AddWalkEdges(
+        const transport_catalogue::TransportCatalogue& catalogue);
+    void AddBusEdge(const domain::Route& route, domain::StopId from,
+                    domain::StopId to, size_t distance, size_t span);
     double CalcWeight(size_t distance);
 };
 
@@ -0,0 +1,231 @@
+#!/bin/bash
+# catalogue_store_check.sh
+#
+# Проверка режима process_store_requests: запись пакетов в журнал,
+# компакция журнала в снимок, восстановление при перезапуске из снимка и
+# хвоста журнала, отбрасывание оборванной записи и незаконченного снимка,
+# пакет, по которому не удалось построить версию, и оборванная запись
+# пакета в журнал.
+#
+# Сборка и запуск из корня репозитория:
+#   g++ -std=c++20 -O2 -pthread -o transport_catalogue src/*.cpp
+#   tests/catalogue_store_check.sh ./transport_catalogue
+
+set -u
+
+if [ $# -ne 1 ]; then
+    echo "Usage: $0 path/to/transport_catalogue" >&2
+    exit 2
+fi
+BINARY=$(realpath "$1")
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+FAILED=0
+
+B1='[
+ {"type": "Stop", "name": "A", "latitude": 43.5870, "longitude": 39.7160,
+  "road_distances": {"B": 1200}},
+ {"type": "Stop", "name": "B", "latitude": 43.5810, "longitude": 39.7210,
+  "road_distances": {"C": 1800}},
+ {"type": "Stop", "name": "C", "latitude": 43.5750, "longitude": 39.7300,
+  "road_distances": {}},
+ {"type": "Bus", "name": "1", "stops": ["A", "B", "C"],
+  "is_roundtrip": false}]'
+B2='[
+ {"type": "Stop", "name": "D", "latitude": 43.5900, "longitude": 39.7250,
+  "road_distances": {"A": 900}},
+ {"type": "Bus", "name": "2", "stops": ["A", "D", "A"],
+  "is_roundtrip": true}]'
+B3='[
+ {"type": "Stop", "name": "B", "latitude": 43.5820, "longitude": 39.7190,
+  "road_distances": {}},
+ {"type": "Distance", "from": "B", "to": "C", "distance": 1500}]'
+B4='[
+ {"type": "Stop", "name": "E", "latitude": 43.5700, "longitude": 39.7350,
+  "road_distances": {"C": 700}},
+ {"type": "Bus", "name": "1", "stops": ["A", "B", "C", "E"],
+  "is_roundtrip": false}]'
+B5='[
+ {"type": "RemoveBus", "name": "2"},
+ {"type": "RemoveStop", "name": "D"}]'
+# Маршрут X описан в пакете дважды: действует второе описание
+DUP='[
+ {"type": "Bus", "name": "Y", "stops": ["A", "B"], "is_roundtrip": false},
+ {"type": "Bus", "name": "X", "stops": ["A", "B", "A"], "is_roundtrip": true},
+ {"type": "Bus", "name": "X", "stops": ["A", "B", "C", "B", "A"],
+  "is_roundtrip": true}]'
+REMOVE_Y='[{"type": "RemoveBus", "name": "Y"}]'
+ONLY_X='[
+ {"type": "Bus", "name": "X", "stops": ["A", "B", "C", "B", "A"],
+  "is_roundtrip": true}]'
+
+STATS='[
+ {"id": 1, "type": "Bus", "name": "1"},
+ {"id": 2, "type": "Bus", "name": "2"},
+ {"id": 3, "type": "Stop", "name": "B"},
+ {"id": 4, "type": "ListStops"},
+ {"id": 5, "type": "ListBuses"},
+ {"id": 6, "type": "Route", "from": "A", "to": "C"},
+ {"id": 7, "type": "Bus", "name": "X"}]'
+
+RENDER='{"width": 600, "height": 400, "padding": 50, "line_width": 14,
+ "stop_radius": 5, "bus_label_font_size": 20, "bus_label_offset": [7, 15],
+ "stop_label_font_size": 20, "stop_label_offset": [7, -3],
+ "underlayer_color": [255, 255, 255, 0.85], "underlayer_width": 3,
+ "color_palette": ["green", [255, 160, 0], "red"]}'
+
+# run <каталог> <порог компакции> <вывод> [пакеты...]
+# Если задан MEMORY_LIMIT, процесс запускается с ulimit -v MEMORY_LIMIT,
+# если задан FILE_LIMIT - с ulimit -f FILE_LIMIT: запись сверх него
+# завершается ошибкой, а не сигналом.
+run()
+{
+    local directory=$1 threshold=$2 output=$3
+    shift 3
+    local batches
+    batches=$(IFS=,; echo "$*")
+    printf '{"store_settings": {"directory": "%s", "compaction_threshold": %s},
+"delta_batches": [%s],
+"routing_settings": {"bus_wait_time": 6, "bus_velocity": 40},
+"render_settings": %s,
+"stat_requests": %s}' \
+        "$WORK/$directory" "$threshold" "$batches" "$RENDER" "$STATS" \
+        > "$WORK/input.json"
+    if ! bash -c 'if [ -n "${MEMORY_LIMIT:-}" ]; then ulimit -v "$MEMORY_LIMIT"; fi
+                  if [ -n "${FILE_LIMIT:-}" ]; then
+                      trap "" XFSZ
+                      ulimit -f "$FILE_LIMIT"
+                  fi
+                  "$1" process_store_requests' _ "$BINARY" \
+        < "$WORK/input.json" > "$WORK/$output" 2> /dev/null; then
+        echo "FAIL: $directory: run exited with an error"
+        FAILED=1
+    fi
+}
+
+expect_same()
+{
+    if [ -s "$WORK/$1" ] && cmp -s "$WORK/$1" "$WORK/$2"; then
+        echo "ok: $3"
+    else
+        echo "FAIL: $3"
+        diff "$WORK/$1" "$WORK/$2" | head -20
+        FAILED=1
+    fi
+}
+
+expect_files()
+{
+    local count
+    count=$(find "$WORK/$1" -name "$2" | wc -l)
+    if [ "$count" -ge 1 ]; then
+        echo "ok: $3"
+    else
+        echo "FAIL: $3"
+        FAILED=1
+    fi
+}
+
+# Эталоны без компакции: версии 3, 4 и 5
+run plain3 1024 plain3.out "$B1" "$B2" "$B3"
+run plain4 1024 plain4.out "$B1" "$B2" "$B3" "$B4"
+run plain5 1024 plain5.out "$B1" "$B2" "$B3" "$B4" "$B5"
+run plain3 1024 plain3_restart.out
+expect_same plain3.out plain3_restart.out "restart replays the whole log"
+
+# После второго пакета журнал сворачивается в снимок в фоне
+run store 2 store3.out "$B1" "$B2" "$B3"
+expect_same plain3.out store3.out "compaction does not change answers"
+expect_files store 'snapshot-*.bin' "compaction writes a snapshot"
+run store 1024 store3_restart.out
+expect_same plain3.out store3_restart.out \
+    "restart loads the snapshot and replays the tail"
+
+# Компакция после каждого пакета: следующие пакеты применяются к каталогу,
+# перенесенному в новые пул названий и арену
+run repack 1 repack5.out "$B1" "$B2" "$B3" "$B4" "$B5"
+expect_same plain5.out repack5.out "repacking after compaction keeps answers"
+run repack 1024 repack5_restart.out
+expect_same plain5.out repack5_restart.out "restart after repeated compaction"
+
+# Пакеты 4 и 5 дописываются в текущий файл журнала, затем запись 5
+# обрывается, а рядом остается незаконченный снимок
+run store 1024 store5.out "$B4" "$B5"
+expect_same plain5.out store5.out "appended batches are applied"
+LAST_LOG=$(find "$WORK/store" -name 'changes-*.log' | sort | tail -n 1)
+truncate -s -1 "$LAST_LOG"
+echo garbage > "$WORK/store/snapshot-00000000000000000099.bin.tmp"
+run store 1024 store4.out
+expect_same plain4.out store4.out "torn log record is dropped on restart"
+if [ -e "$WORK/store/snapshot-00000000000000000099.bin.tmp" ]; then
+    echo "FAIL: unfinished snapshot is not removed"
+    FAILED=1
+else
+    echo "ok: unfinished snapshot is removed"
+fi
+
+# Пакет 5 снова применяется после восстановленной версии 4
+run store 1024 store5_again.out "$B5"
+expect_same plain5.out store5_again.out "log continues after a torn record"
+run store 1024 store5_restart.out
+expect_same plain5.out store5_restart.out "restart after the new append"
+
+# Удаление другого маршрута не возвращает замененное описание X
+run dup_plain 1024 dup_plain.out "$B1" "$ONLY_X"
+run dup 1024 dup.out "$B1" "$DUP" "$REMOVE_Y"
+expect_same dup_plain.out dup.out \
+    "bus described twice in a batch keeps the second description"
+run dup 1024 dup_restart.out
+expect_same dup_plain.out dup_restart.out \
+    "restart keeps the second description of a bus"
+
+# Пакет применяется, но маршрутизатор по нему не помещается в память: он
+# не должен попасть в журнал, а следующий пакет получает ту же версию
+run plain2 1024 plain2.out "$B1" "$B2"
+BIG=$(awk 'BEGIN {
+    printf "["
+    for (i = 0; i < 5000; ++i) {
+        printf "%s{\"type\": \"Stop\", \"name\": \"X%d\", ", \
+            (i ? "," : ""), i
+        printf "\"latitude\": 43.6, \"longitude\": 39.7, "
+        printf "\"road_distances\": {}}"
+    }
+    printf "]"
+}')
+run failed 1024 failed1.out "$B1"
+export MEMORY_LIMIT=1000000
+BEFORE=$FAILED
+if [ "$(run failed 1024 failed_big.out "$BIG")" ]; then
+    echo "ok: failed version build is reported"
+else
+    echo "FAIL: version build did not fail"
+    BEFORE=1
+fi
+FAILED=$BEFORE
+run failed 1024 failed2.out "$B2"
+expect_same plain2.out failed2.out \
+    "batch after a failed build takes its version"
+run failed 1024 failed2_restart.out
+expect_same plain2.out failed2_restart.out \
+    "restart does not replay the unpublished batch"
+unset MEMORY_LIMIT
+
+# Запись пакета в журнал обрывается на пределе размера файла: ее начало
+# не должно скрыть от восстановления следующий пакет
+run torn 1024 torn1.out "$B1"
+export FILE_LIMIT=64
+BEFORE=$FAILED
+if [ "$(run torn 1024 torn3.out "$B2" "$BIG" "$B3")" ]; then
+    echo "ok: failed log write is reported"
+else
+    echo "FAIL: log write did not fail"
+    BEFORE=1
+fi
+FAILED=$BEFORE
+unset FILE_LIMIT
+expect_same plain3.out torn3.out "batch after a failed log write is applied"
+run torn 1024 torn3_restart.out
+expect_same plain3.out torn3_restart.out \
+    "restart replays the batch after a failed log write"
+
+exit $FAILED
\ No newline at end of file
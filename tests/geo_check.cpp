@@ -0,0 +1,215 @@
+// geo_check.cpp
+//
+// Проверка расчета расстояний: конечность и ноль для совпадающих точек,
+// побитовое совпадение ComputeDistance с кэшем тригонометрии и без,
+// граница ошибки ComputeApproxDistances из geo.h и совпадение ответов
+// SpatialIndex с перебором всех остановок.
+//
+// Сборка и запуск из корня репозитория:
+//   g++ -std=c++20 -O2 -Isrc -o geo_check tests/geo_check.cpp
+//       src/geo.cpp src/spatial_index.cpp
+//   ./geo_check
+
+#define _USE_MATH_DEFINES
+#include "geo.h"
+#include "spatial_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+using namespace std::literals;
+
+constexpr double METERS_PER_DEGREE = geo::EARTH_RADIUS * M_PI / 180.0;
+
+bool failed = false;
+
+void Expect(bool condition, std::string_view description)
+{
+    std::cout << (condition ? "ok: "sv : "FAIL: "sv) << description
+              << std::endl;
+    failed = failed || !condition;
+}
+
+bool SameBits(double lhs, double rhs)
+{
+    return std::memcmp(&lhs, &rhs, sizeof(double)) == 0;
+}
+
+// Точка на расстоянии около distance метров от center в случайном
+// направлении
+geo::Coordinates Shift(geo::Coordinates center, double distance,
+                       std::mt19937_64& random)
+{
+    std::uniform_real_distribution<double> direction(0, 2 * M_PI);
+    const double angle = direction(random);
+    const double dlat = distance * std::cos(angle) / METERS_PER_DEGREE;
+    const double dlng = distance * std::sin(angle) / METERS_PER_DEGREE /
+                        std::cos(center.lat * M_PI / 180.0);
+    return {center.lat + dlat, center.lng + dlng};
+}
+
+void CheckExactDistance(std::mt19937_64& random)
+{
+    std::uniform_real_distribution<double> lat(-89, 89);
+    std::uniform_real_distribution<double> lng(-180, 180);
+    std::uniform_real_distribution<double> log_distance(-4, 7);
+    bool finite = true;
+    bool zero = true;
+    bool same_bits = true;
+    for (int i = 0; i < 200000; ++i) {
+        const geo::Coordinates from{lat(random), lng(random)};
+        const geo::Coordinates to =
+            Shift(from, std::pow(10, log_distance(random)), random);
+        const double distance = geo::ComputeDistance(from, to);
+        finite = finite && std::isfinite(distance);
+        zero = zero && geo::ComputeDistance(from, from) == 0;
+        same_bits =
+            same_bits &&
+            SameBits(distance,
+                     geo::ComputeDistance(
+                         from, geo::ComputeLatitudeTrig(from.lat), to,
+                         geo::ComputeLatitudeTrig(to.lat)));
+    }
+    Expect(finite, "distance is finite for near-coincident points"sv);
+    Expect(zero, "distance between equal points is zero"sv);
+    Expect(same_bits, "cached trigonometry gives the same bits"sv);
+}
+
+void CheckApproxDistance(std::mt19937_64& random)
+{
+    std::uniform_real_distribution<double> lat(-geo::APPROX_MAX_LATITUDE,
+                                               geo::APPROX_MAX_LATITUDE);
+    std::uniform_real_distribution<double> lng(-179, 179);
+    std::uniform_real_distribution<double> log_distance(
+        -2, std::log10(geo::APPROX_MAX_DISTANCE));
+    const geo::Coordinates center{lat(random), lng(random)};
+    double worst_excess = -1;
+    std::vector<geo::Coordinates> points;
+    for (int i = 0; i < 200000; ++i) {
+        const geo::Coordinates from{lat(random), lng(random)};
+        geo::Coordinates to =
+            Shift(from, std::pow(10, log_distance(random)), random);
+        const double exact = geo::ComputeDistance(from, to);
+        if (std::abs(to.lat) > geo::APPROX_MAX_LATITUDE ||
+            exact > geo::APPROX_MAX_DISTANCE) {
+            continue;
+        }
+        double approx = 0;
+        geo::ComputeApproxDistances(from, {&to, 1}, {&approx, 1});
+        worst_excess =
+            std::max(worst_excess, std::abs(approx - exact) -
+                                       geo::APPROX_RELATIVE_ERROR * exact -
+                                       geo::APPROX_ABSOLUTE_ERROR);
+        if (points.size() < 1001) {
+            points.push_back(Shift(center, exact, random));
+        }
+    }
+    Expect(worst_excess <= 0, "approximate distance is within the bound"sv);
+
+    // Нечетное число точек: последняя считается без SSE2
+    std::vector<double> batch(points.size());
+    geo::ComputeApproxDistances(center, points, batch);
+    bool same_bits = true;
+    for (size_t i = 0; i < points.size(); ++i) {
+        double single = 0;
+        geo::ComputeApproxDistances(center, {&points[i], 1}, {&single, 1});
+        same_bits = same_bits && SameBits(batch[i], single);
+    }
+    Expect(same_bits, "batch and single approximate distances agree"sv);
+}
+
+std::vector<transport_catalogue::StopDistance> FindWithinByScan(
+    const std::vector<domain::Stop>& stops, geo::Coordinates center,
+    double radius)
+{
+    std::vector<transport_catalogue::StopDistance> result;
+    for (const domain::Stop& stop : stops) {
+        const double distance = geo::ComputeDistance(center, stop.coordinates);
+        if (distance <= radius) {
+            result.push_back({stop.id, distance});
+        }
+    }
+    std::sort(result.begin(), result.end(), [](const auto& lhs,
+                                               const auto& rhs) {
+        return std::pair(lhs.distance, lhs.stop_id) <
+               std::pair(rhs.distance, rhs.stop_id);
+    });
+    return result;
+}
+
+bool SameResult(const std::vector<transport_catalogue::StopDistance>& lhs,
+                const std::vector<transport_catalogue::StopDistance>& rhs)
+{
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                      [](const auto& lhs, const auto& rhs) {
+                          return lhs.stop_id == rhs.stop_id &&
+                                 SameBits(lhs.distance, rhs.distance);
+                      });
+}
+
+// Города у экватора, у границы приближенного расчета и у меридиана 180°
+void CheckSpatialIndex(std::mt19937_64& random)
+{
+    const geo::Coordinates cities[] = {
+        {43.58, 39.72}, {69.9, 33.1}, {-69.8, 120}, {64.7, 179.9}};
+    std::uniform_real_distribution<double> log_distance(0, 5.5);
+    std::uniform_real_distribution<double> log_radius(0, 6);
+    std::uniform_int_distribution<size_t> count(1, 20);
+    for (const geo::Coordinates& city : cities) {
+        std::vector<domain::Stop> stops;
+        for (domain::StopId id = 0; id < 3000; ++id) {
+            geo::Coordinates coordinates =
+                Shift(city, std::pow(10, log_distance(random)), random);
+            if (coordinates.lng > 180) {
+                coordinates.lng -= 360;
+            }
+            stops.push_back({""sv, coordinates, id});
+        }
+        // Совпадающие и почти совпадающие остановки
+        stops.push_back({""sv, city, 3000});
+        stops.push_back({""sv, {city.lat, city.lng + 1e-9}, 3001});
+
+        transport_catalogue::SpatialIndex index;
+        index.Build(stops);
+        bool within = true;
+        bool nearest = true;
+        for (int i = 0; i < 300; ++i) {
+            const geo::Coordinates center =
+                i % 3 == 0 ? stops[i].coordinates
+                           : Shift(city, std::pow(10, log_distance(random)),
+                                   random);
+            const double radius = std::pow(10, log_radius(random));
+            const auto expected = FindWithinByScan(stops, center, radius);
+            within = within &&
+                     SameResult(index.FindWithin(center, radius), expected);
+
+            auto all = FindWithinByScan(stops, center, 4e7);
+            all.resize(std::min(all.size(), count(random)));
+            nearest = nearest &&
+                      SameResult(index.FindNearest(center, all.size()), all);
+        }
+        const std::string place = " near "s + std::to_string(city.lat) +
+                                  ", "s + std::to_string(city.lng);
+        Expect(within, "FindWithin matches a full scan"s + place);
+        Expect(nearest, "FindNearest matches a full scan"s + place);
+    }
+}
+
+} // namespace
+
+int main()
+{
+    std::mt19937_64 random(1);
+    CheckExactDistance(random);
+    CheckApproxDistance(random);
+    CheckSpatialIndex(random);
+    return failed ? 1 : 0;
+}
\ No newline at end of file
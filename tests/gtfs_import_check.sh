@@ -0,0 +1,134 @@
+#!/bin/bash
+# gtfs_import_check.sh
+#
+# Проверка импорта GTFS (gtfs_settings) по расписанию tests/gtfs_feed:
+# - поля в кавычках с "" и переводом строки, строки с \r\n;
+# - станции и входы (location_type 1 и 2) не становятся остановками;
+# - одноименные остановки получают stop_id в скобках;
+# - рейс, обратный другому, объединяется с ним в маршрут туда и обратно,
+#   другой вариант маршрута получает номер в скобках, маршрут без
+#   routes.txt называется по route_id;
+# - длины перегонов вдоль линии из shapes.txt;
+# - те же ответы, когда stops.txt больше части параллельного разбора и
+#   границы частей попадают на переводы строк внутри кавычек (на машине
+#   с одним ядром файл не делится).
+#
+# Сборка и запуск из корня репозитория:
+#   g++ -std=c++20 -O2 -pthread -o transport_catalogue src/*.cpp
+#   tests/gtfs_import_check.sh ./transport_catalogue
+
+set -u
+
+if [ $# -ne 1 ]; then
+    echo "Usage: $0 path/to/transport_catalogue" >&2
+    exit 2
+fi
+BINARY=$(realpath "$1")
+FEED=$(realpath "$(dirname "$0")/gtfs_feed")
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+FAILED=0
+
+RENDER='{"width": 600, "height": 400, "padding": 50, "line_width": 14,
+ "stop_radius": 5, "bus_label_font_size": 20, "bus_label_offset": [7, 15],
+ "stop_label_font_size": 20, "stop_label_offset": [7, -3],
+ "underlayer_color": [255, 255, 255, 0.85], "underlayer_width": 3,
+ "color_palette": ["green"]}'
+
+STATS='[
+ {"id": 1, "type": "Bus", "name": "1"},
+ {"id": 2, "type": "Bus", "name": "1 (2)"},
+ {"id": 3, "type": "Bus", "name": "Кольцевой"},
+ {"id": 4, "type": "Bus", "name": "r3"},
+ {"id": 5, "type": "Stop", "name": "Вокзал"},
+ {"id": 6, "type": "Stop", "name": "Цирк \"Арена\""},
+ {"id": 7, "type": "Stop", "name": "Рынок (c1)"},
+ {"id": 8, "type": "Stop", "name": "Рынок (c2)"},
+ {"id": 9, "type": "Stop", "name": "Рынок"},
+ {"id": 10, "type": "Stop", "name": "Вход"},
+ {"id": 11, "type": "Stop", "name": "Порт"}]'
+
+# run <каталог GTFS>: ответы без пробелов и переводов строк в $WORK/output
+run()
+{
+    printf '{"gtfs_settings": {"directory": "%s"},
+"routing_settings": {"bus_wait_time": 6, "bus_velocity": 40},
+"render_settings": %s,
+"stat_requests": %s}' "$1" "$RENDER" "$STATS" > "$WORK/input.json"
+    if ! "$BINARY" < "$WORK/input.json" > "$WORK/raw"; then
+        echo "FAIL: run exited with an error"
+        FAILED=1
+    fi
+    tr -d ' \n' < "$WORK/raw" > "$WORK/output"
+}
+
+# expect <фрагмент ответа> <описание>
+expect()
+{
+    if grep -qF -- "$1" "$WORK/output"; then
+        echo "ok: $2"
+    else
+        echo "FAIL: $2"
+        head -c 400 "$WORK/output"
+        echo
+        FAILED=1
+    fi
+}
+
+run "$FEED"
+cp "$WORK/output" "$WORK/expected"
+
+# Перегон Вокзал - Цирк по линии идет в обход: 2581 м вместо 805 м.
+# Обратный рейс t2 объединен с t1 и t3, его перегоны - по прямой.
+expect '{"curvature":1.37216,"request_id":1,"route_length":6557,'\
+'"stop_count":7,"unique_stop_count":4}' \
+    "reverse trip merges into a linear route with shape lengths"
+expect '{"curvature":2.09222,"request_id":2,"route_length":3407,'\
+'"stop_count":3,"unique_stop_count":3}' \
+    "second variant is numbered and reuses the shape length"
+expect '{"curvature":1.00009,"request_id":3,"route_length":2734,'\
+'"stop_count":4,"unique_stop_count":3}' \
+    "route_long_name names a route without a short name"
+expect '{"curvature":1.00044,"request_id":4,"route_length":791,'\
+'"stop_count":2,"unique_stop_count":2}' \
+    "route missing from routes.txt is named by route_id"
+expect '{"buses":["1","1(2)"],"request_id":5}' \
+    "station does not make its namesake stop ambiguous"
+expect '{"buses":["1","1(2)","Кольцевой"],"request_id":6}' \
+    "quoted name with doubled quotes"
+expect '{"buses":["1"],"request_id":7}' \
+    "duplicate stop name gets its stop_id"
+expect '{"buses":["1(2)","r3","Кольцевой"],"request_id":8}' \
+    "other duplicate stop name gets its stop_id"
+expect '{"error_message":"notfound","request_id":9}' \
+    "duplicate name alone is not a stop"
+expect '{"error_message":"notfound","request_id":10}' \
+    "entrance is not a stop"
+expect '{"buses":["1","r3","Кольцевой"],"request_id":11}' \
+    "stop after a multi-line quoted field"
+
+# Тот же каталог с 4000 станциями перед остановками в stops.txt: у
+# каждой станции многострочное описание в кавычках
+mkdir "$WORK/feed"
+cp "$FEED"/*.txt "$WORK/feed"
+{
+    head -n 1 "$FEED/stops.txt"
+    awk 'BEGIN {
+        for (i = 0; i < 4000; ++i) {
+            printf "p%d,Станция %d,\"Описание ""%d"",\nвторая строка,\n", \
+                i, i, i
+            printf "третья строка\",43.6,39.7,1\r\n"
+        }
+    }'
+    tail -n +2 "$FEED/stops.txt"
+} > "$WORK/feed/stops.txt"
+run "$WORK/feed"
+if cmp -s "$WORK/expected" "$WORK/output"; then
+    echo "ok: stops.txt split into parts gives the same answers"
+else
+    echo "FAIL: stops.txt split into parts gives other answers"
+    diff "$WORK/expected" "$WORK/output" | head -20
+    FAILED=1
+fi
+
+exit $FAILED
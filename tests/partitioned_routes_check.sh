@@ -0,0 +1,205 @@
+#!/bin/bash
+# partitioned_routes_check.sh
+#
+# Проверка режима process_partitioned_requests: ответы на Route, которые
+# сшиваются из путей рабочих процессов регионов, совпадают с ответами
+# process_requests по тому же снимку при разном числе регионов. Маршруты
+# проходят через остановки на границах регионов, пешие пересадки и
+# начинаются или заканчиваются в произвольных точках. Если рабочий процесс
+# убит, следующие маршруты отвечают ошибкой.
+#
+# Сборка и запуск из корня репозитория:
+#   g++ -std=c++20 -O2 -pthread -o transport_catalogue src/*.cpp
+#   tests/partitioned_routes_check.sh ./transport_catalogue
+
+set -u
+
+if [ $# -ne 1 ]; then
+    echo "Usage: $0 path/to/transport_catalogue" >&2
+    exit 2
+fi
+BINARY=$(realpath "$1")
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+FAILED=0
+
+# Две линии с запада на восток, кольцо на востоке и линия с севера на юг.
+# Остановки Q и S не связаны автобусом: между ними около 260 м пешком.
+BASE='[
+ {"type": "Stop", "name": "A", "latitude": 55.700, "longitude": 37.500,
+  "road_distances": {"B": 1400}},
+ {"type": "Stop", "name": "B", "latitude": 55.705, "longitude": 37.520,
+  "road_distances": {"C": 1500, "G": 900}},
+ {"type": "Stop", "name": "C", "latitude": 55.708, "longitude": 37.545,
+  "road_distances": {"D": 1700}},
+ {"type": "Stop", "name": "D", "latitude": 55.710, "longitude": 37.570,
+  "road_distances": {"E": 1300, "P": 1100}},
+ {"type": "Stop", "name": "E", "latitude": 55.715, "longitude": 37.590,
+  "road_distances": {"F": 1200}},
+ {"type": "Stop", "name": "F", "latitude": 55.725, "longitude": 37.595,
+  "road_distances": {"E": 1250, "K": 1000}},
+ {"type": "Stop", "name": "K", "latitude": 55.730, "longitude": 37.580,
+  "road_distances": {"E": 1900}},
+ {"type": "Stop", "name": "G", "latitude": 55.690, "longitude": 37.522,
+  "road_distances": {"H": 1600}},
+ {"type": "Stop", "name": "H", "latitude": 55.680, "longitude": 37.540,
+  "road_distances": {"Q": 1400}},
+ {"type": "Stop", "name": "Q", "latitude": 55.676, "longitude": 37.560,
+  "road_distances": {}},
+ {"type": "Stop", "name": "P", "latitude": 55.7035, "longitude": 37.5705,
+  "road_distances": {"R": 2000}},
+ {"type": "Stop", "name": "R", "latitude": 55.690, "longitude": 37.585,
+  "road_distances": {}},
+ {"type": "Stop", "name": "S", "latitude": 55.678, "longitude": 37.562,
+  "road_distances": {"R": 2500}},
+ {"type": "Bus", "name": "1", "stops": ["A", "B", "C", "D", "E"],
+  "is_roundtrip": false},
+ {"type": "Bus", "name": "2", "stops": ["E", "F", "K", "E"],
+  "is_roundtrip": true},
+ {"type": "Bus", "name": "3", "stops": ["B", "G", "H", "Q"],
+  "is_roundtrip": false},
+ {"type": "Bus", "name": "4", "stops": ["D", "P", "R"],
+  "is_roundtrip": false},
+ {"type": "Bus", "name": "5", "stops": ["S", "R"], "is_roundtrip": false}]'
+
+RENDER='{"width": 600, "height": 400, "padding": 50, "line_width": 14,
+ "stop_radius": 5, "bus_label_font_size": 20, "bus_label_offset": [7, 15],
+ "stop_label_font_size": 20, "stop_label_offset": [7, -3],
+ "underlayer_color": [255, 255, 255, 0.85], "underlayer_width": 3,
+ "color_palette": ["green", [255, 160, 0], "red"]}'
+
+ROUTING='{"bus_wait_time": 4, "bus_velocity": 30, "pedestrian_velocity": 4,
+ "walk_transfer_radius": 400, "snap_stops_count": 3}'
+
+# Маршруты между всеми парами остановок, из точек и в точки, от
+# неизвестной остановки
+STOPS="A B C D E F K G H Q P R S"
+STATS=$(
+    id=0
+    printf '['
+    for from in $STOPS; do
+        for to in $STOPS; do
+            id=$((id + 1))
+            printf '%s{"id": %d, "type": "Route", "from": "%s", "to": "%s"}' \
+                "$([ $id -gt 1 ] && echo ,)" $id "$from" "$to"
+        done
+    done
+    for point in '55.701, "longitude": 37.505' '55.677, "longitude": 37.556' \
+                 '55.727, "longitude": 37.590'; do
+        for stop in A E Q R; do
+            printf ',{"id": %d, "type": "Route", "from": {"latitude": %s}, "to": "%s"}' \
+                $((id += 1)) "$point" "$stop"
+            printf ',{"id": %d, "type": "Route", "from": "%s", "to": {"latitude": %s}}' \
+                $((id += 1)) "$stop" "$point"
+        done
+    done
+    printf ',{"id": %d, "type": "Route", "from": {"latitude": 55.701, "longitude": 37.505}, "to": {"latitude": 55.727, "longitude": 37.590}}' \
+        $((id += 1))
+    printf ',{"id": %d, "type": "Route", "from": "Nope", "to": "A"}' \
+        $((id += 1))
+    printf ']'
+)
+
+# Много маршрутов между парами остановок: рабочий процесс успевают убить,
+# пока координатор на них отвечает
+MANY=$(
+    id=0
+    printf '['
+    for round in $(seq 40); do
+        for from in $STOPS; do
+            for to in $STOPS; do
+                id=$((id + 1))
+                printf '%s{"id": %d, "type": "Route", "from": "%s", "to": "%s"}' \
+                    "$([ $id -gt 1 ] && echo ,)" $id "$from" "$to"
+            done
+        done
+    done
+    printf ']'
+)
+
+# document <число регионов> [запросы]
+document()
+{
+    printf '{"base_requests": %s,
+"serialization_settings": {"file": "%s"},
+"partition_settings": {"regions": %s},
+"routing_settings": %s,
+"render_settings": %s,
+"stat_requests": %s}' \
+        "$BASE" "$WORK/base.bin" "$1" "$ROUTING" "$RENDER" "${2:-$STATS}"
+}
+
+# Ответы по одному в строке
+responses()
+{
+    awk '/^    \{/ { response = ""; next }
+         /^    \}/ { print response; next }
+         { sub(/^ +/, ""); response = response $0 }' "$1"
+}
+
+document 1 > "$WORK/input.json"
+if ! "$BINARY" make_base < "$WORK/input.json" ||
+   ! "$BINARY" process_requests < "$WORK/input.json" > "$WORK/direct.out"; then
+    echo "FAIL: direct mode exited with an error"
+    exit 1
+fi
+if ! grep -q '"type": "Walk"' "$WORK/direct.out"; then
+    echo "FAIL: no route uses a walk"
+    FAILED=1
+fi
+
+for regions in 1 2 3 4 5; do
+    document "$regions" > "$WORK/input.json"
+    if ! "$BINARY" process_partitioned_requests < "$WORK/input.json" \
+        > "$WORK/partitioned.out"; then
+        echo "FAIL: $regions regions: run exited with an error"
+        FAILED=1
+    elif cmp -s "$WORK/direct.out" "$WORK/partitioned.out"; then
+        echo "ok: $regions regions match direct routes"
+    else
+        echo "FAIL: $regions regions differ from direct routes"
+        diff "$WORK/direct.out" "$WORK/partitioned.out" | head -20
+        FAILED=1
+    fi
+done
+
+# Убитый рабочий процесс не отвечает на уже отправленные ему запросы, а
+# ответы остальных остаются непрочитанными: после ошибки маршрутизатор
+# должен отвечать ошибкой, а не чужими маршрутами
+document 1 "$MANY" > "$WORK/input.json"
+"$BINARY" process_requests < "$WORK/input.json" > "$WORK/many.out"
+document 3 "$MANY" > "$WORK/input.json"
+"$BINARY" process_partitioned_requests < "$WORK/input.json" \
+    > "$WORK/killed.out" 2> /dev/null &
+COORDINATOR=$!
+while [ ! -s "$WORK/killed.out" ] && kill -0 $COORDINATOR 2> /dev/null; do
+    sleep 0.01
+done
+pkill -KILL -o -P $COORDINATOR
+# Координатор, ждущий уже прочитанного ответа, зависает
+for i in $(seq 600); do
+    kill -0 $COORDINATOR 2> /dev/null || break
+    sleep 0.1
+done
+if kill -0 $COORDINATOR 2> /dev/null; then
+    echo "FAIL: coordinator hangs after a killed worker"
+    FAILED=1
+    pkill -KILL -P $COORDINATOR
+    kill -KILL $COORDINATOR
+fi
+wait $COORDINATOR
+responses "$WORK/many.out" > "$WORK/many.lines"
+responses "$WORK/killed.out" > "$WORK/killed.lines"
+awk 'NR == FNR { direct[FNR] = $0; next }
+     $0 == direct[FNR] && !(failed && $0 !~ /"error_message"/) { next }
+     /"error_message"/ && $0 !~ /"not found"/ { failed = 1; next }
+     { wrong = 1 }
+     END { exit wrong ? 1 : failed ? 0 : 2 }' \
+    "$WORK/many.lines" "$WORK/killed.lines"
+case $? in
+    0) echo "ok: routes after a killed worker fail" ;;
+    1) echo "FAIL: routes after a killed worker are wrong"; FAILED=1 ;;
+    *) echo "FAIL: killed worker did not fail a route"; FAILED=1 ;;
+esac
+
+exit $FAILED
@@ -0,0 +1,204 @@
+#!/bin/bash
+# stat_requests_check.sh
+#
+# Проверка ответов на stat_requests в режиме без аргументов: поиск
+# остановок, маршруты для совпадающих и почти совпадающих координат и от
+# неизвестной остановки, ответы с error_message на некорректные запросы и
+# на запросы, которые не удалось обработать, отказ от некорректных
+# настроек маршрутизации.
+#
+# Сборка и запуск из корня репозитория:
+#   g++ -std=c++20 -O2 -pthread -o transport_catalogue src/*.cpp
+#   tests/stat_requests_check.sh ./transport_catalogue
+
+set -u
+
+if [ $# -ne 1 ]; then
+    echo "Usage: $0 path/to/transport_catalogue" >&2
+    exit 2
+fi
+BINARY=$(realpath "$1")
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+FAILED=0
+
+# Остановка B примерно в 1,2 км от A
+BASE='[
+ {"type": "Stop", "name": "A", "latitude": 55.031, "longitude": 37.2,
+  "road_distances": {"B": 1300}},
+ {"type": "Stop", "name": "B", "latitude": 55.0335, "longitude": 37.2179,
+  "road_distances": {}},
+ {"type": "Bus", "name": "1", "stops": ["A", "B"], "is_roundtrip": false}]'
+
+RENDER='{"width": 600, "height": 400, "padding": 50, "line_width": 14,
+ "stop_radius": 5, "bus_label_font_size": 20, "bus_label_offset": [7, 15],
+ "stop_label_font_size": 20, "stop_label_offset": [7, -3],
+ "underlayer_color": [255, 255, 255, 0.85], "underlayer_width": 3,
+ "color_palette": ["green"]}'
+
+ROUTING='{"bus_wait_time": 6, "bus_velocity": 40}'
+
+# run <запросы> [настройки маршрутизации]: ответы без пробелов и переводов
+# строк в $WORK/output
+run()
+{
+    printf '{"base_requests": %s,
+"routing_settings": %s,
+"render_settings": %s,
+"stat_requests": %s}' "$BASE" "${2:-$ROUTING}" "$RENDER" "$1" \
+        > "$WORK/input.json"
+    if ! "$BINARY" < "$WORK/input.json" > "$WORK/raw"; then
+        echo "FAIL: run exited with an error"
+        FAILED=1
+    fi
+    tr -d ' \n' < "$WORK/raw" > "$WORK/output"
+}
+
+# reject <настройки маршрутизации> <сообщение> <описание>: запуск
+# завершается ошибкой с сообщением, не ответив на запросы
+reject()
+{
+    printf '{"base_requests": %s,
+"routing_settings": %s,
+"render_settings": %s,
+"stat_requests": [{"id": 1, "type": "Route", "from": "A", "to": "B"}]}' \
+        "$BASE" "$1" "$RENDER" > "$WORK/input.json"
+    # Сообщение оболочки о завершении процесса по сигналу не нужно
+    if { "$BINARY" < "$WORK/input.json" > "$WORK/raw" 2> "$WORK/errors"; } \
+        2> /dev/null; then
+        echo "FAIL: $3"
+        head -c 400 "$WORK/raw"
+        echo
+        FAILED=1
+    elif grep -qF -- "$2" "$WORK/errors" && ! grep -q total_time "$WORK/raw"
+    then
+        echo "ok: $3"
+    else
+        echo "FAIL: $3"
+        head -c 400 "$WORK/errors"
+        FAILED=1
+    fi
+}
+
+# expect <фрагмент ответа> <описание>
+expect()
+{
+    if grep -qF -- "$1" "$WORK/output"; then
+        echo "ok: $2"
+    else
+        echo "FAIL: $2"
+        head -c 400 "$WORK/output"
+        echo
+        FAILED=1
+    fi
+}
+
+run '[
+ {"id": 1, "type": "StopsNearby", "latitude": 55.031,
+  "longitude": 37.200000001, "radius": 100},
+ {"id": 2, "type": "StopsNearby", "latitude": 55.031,
+  "longitude": 37.200000001, "count": 1},
+ {"id": 3, "type": "StopsNearby", "latitude": 55.031, "longitude": 37.2,
+  "radius": 0}]'
+expect '{"request_id":1,"stops":[{"distance":0,"name":"A"}]}' \
+    "stop next to the center is within the radius"
+expect '{"request_id":2,"stops":[{"distance":0,"name":"A"}]}' \
+    "stop next to the center is the nearest"
+expect '{"request_id":3,"stops":[{"distance":0,"name":"A"}]}' \
+    "stop at the center is within a zero radius"
+
+# Ошибка в запросе дает error_message, следующие запросы обрабатываются
+run '[
+ {"id": 1, "type": "Route", "from": "Nope", "to": "B"},
+ {"id": 2, "type": "Bus", "name": "1"}]'
+if grep -qE '^\[\{"error_message":"[^"]+","request_id":1\},' \
+    "$WORK/output"; then
+    echo "ok: failed request gets an error message"
+else
+    echo "FAIL: failed request gets an error message"
+    FAILED=1
+fi
+expect '"request_id":2,' "requests after a failed one are answered"
+
+run '[
+ {"id": 1, "type": "StopsNearby", "latitude": 55.031, "longitude": 37.2},
+ {"id": 2, "type": "StopsNearby", "latitude": 55.031, "longitude": 37.2,
+  "count": -1},
+ {"id": 3, "type": "StopsNearby", "latitude": 55.031, "longitude": 37.2,
+  "count": 0}]'
+expect '{"error_message":"radiusorcountrequired","request_id":1}' \
+    "radius or count is required"
+expect '{"error_message":"invalidcount","request_id":2}' \
+    "negative count is rejected"
+expect '{"error_message":"invalidcount","request_id":3}' \
+    "zero count is rejected"
+
+run '[
+ {"id": 1, "type": "NetworkAnalytics", "pivots": 0},
+ {"id": 2, "type": "NetworkAnalytics", "pivots": -1},
+ {"id": 3, "type": "NetworkAnalytics", "limit": -1},
+ {"id": 4, "type": "NetworkAnalytics", "limit": 1, "pivots": 1}]'
+expect '{"error_message":"invalidpivots","request_id":1}' \
+    "zero pivots are rejected"
+expect '{"error_message":"invalidpivots","request_id":2}' \
+    "negative pivots are rejected"
+expect '{"error_message":"invalidlimit","request_id":3}' \
+    "negative analytics limit is rejected"
+expect '{"request_id":4,"stops":[{"betweenness":0,"closeness":0,"name":"A"}]}' \
+    "analytics limit cuts the answer"
+
+# Точка маршрута в миллиметрах от остановки A: пешком до неё 0 минут
+run '[
+ {"id": 1, "type": "Route",
+  "from": {"latitude": 55.031, "longitude": 37.200000001}, "to": "B"},
+ {"id": 2, "type": "Route", "from": "A",
+  "to": {"latitude": 55.031, "longitude": 37.200000001}},
+ {"id": 3, "type": "Route",
+  "from": {"latitude": 55.031, "longitude": 37.200000001},
+  "to": {"latitude": 55.031, "longitude": 37.2}}]'
+expect '{"items":[{"stop_name":"A","time":6,"type":"Wait"},'\
+'{"bus":"1","span_count":1,"time":1.95,"type":"Bus"}],'\
+'"request_id":1,"total_time":7.95}' \
+    "route starts at a stop next to the point"
+expect '{"items":[],"request_id":2,"total_time":0}' \
+    "route to a point next to the start stop is empty"
+expect '{"items":[],"request_id":3,"total_time":0}' \
+    "route between near-coincident points is empty"
+
+run '[
+ {"id": 1, "type": "Route", "from": "Nope", "to": "B"},
+ {"id": 2, "type": "Route",
+  "from": {"latitude": 55.031, "longitude": 37.2}, "to": "Nope"}]'
+expect '{"error_message":"notfound","request_id":1}' \
+    "route from an unknown stop is not found"
+expect '{"error_message":"notfound","request_id":2}' \
+    "route from a point to an unknown stop is not found"
+
+# Настройки маршрутизации, при которых веса ребер отрицательны или
+# бесконечны, отклоняются при чтении
+reject '{"bus_wait_time": 6, "bus_velocity": 40, "pedestrian_velocity": -5}' \
+    "pedestrian_velocity must be positive" "negative walk velocity is rejected"
+reject '{"bus_wait_time": 6, "bus_velocity": 40, "pedestrian_velocity": 0,
+ "walk_transfer_radius": 5000}' \
+    "pedestrian_velocity must be positive" "zero walk velocity is rejected"
+reject '{"bus_wait_time": 6, "bus_velocity": 40, "snap_stops_count": -1}' \
+    "snap_stops_count must be at least 1" "negative snap count is rejected"
+reject '{"bus_wait_time": 6, "bus_velocity": 40, "snap_stops_count": 0}' \
+    "snap_stops_count must be at least 1" "zero snap count is rejected"
+reject '{"bus_wait_time": 6, "bus_velocity": 40, "walk_transfer_radius": -1}' \
+    "walk_transfer_radius must not be negative" \
+    "negative transfer radius is rejected"
+reject '{"bus_wait_time": 6, "bus_velocity": 0}' \
+    "bus_velocity must be positive" "zero bus velocity is rejected"
+reject '{"bus_wait_time": -1, "bus_velocity": 40}' \
+    "bus_wait_time must not be negative" "negative wait time is rejected"
+
+run '[{"id": 1, "type": "Route", "from": "A", "to": "B"}]' \
+    '{"bus_wait_time": 0, "bus_velocity": 40, "pedestrian_velocity": 4,
+ "snap_stops_count": 1, "walk_transfer_radius": 0}'
+expect '{"items":[{"stop_name":"A","time":0,"type":"Wait"},'\
+'{"bus":"1","span_count":1,"time":1.95,"type":"Bus"}],'\
+'"request_id":1,"total_time":1.95}' \
+    "boundary routing settings are accepted"
+
+exit $FAILED
\ No newline at end of file